@@ -13,6 +13,8 @@
 
 #include "classes/DelphesModule.h"
 #include "classes/DelphesFactory.h"
+#include "classes/DelphesRandom.h"
+#include "classes/DelphesIndexReader.h"
 
 #include "classes/SortableObject.h"
 #include "classes/DelphesClasses.h"
@@ -25,6 +27,8 @@
 
 #pragma link C++ class DelphesModule+;
 #pragma link C++ class DelphesFactory+;
+#pragma link C++ class DelphesRandom+;
+#pragma link C++ class DelphesIndexReader+;
 
 #pragma link C++ class SortableObject+;
 
@@ -38,13 +42,17 @@
 #pragma link C++ class ScalarHT+;
 #pragma link C++ class Rho+;
 #pragma link C++ class Weight+;
+#pragma link C++ class LHEFWeight+;
 #pragma link C++ class Photon+;
 #pragma link C++ class Electron+;
 #pragma link C++ class Muon+;
 #pragma link C++ class Jet+;
 #pragma link C++ class Track+;
 #pragma link C++ class Tower+;
+#pragma link C++ class ReferenceIndices+;
 
+#pragma link C++ class CandidateTower+;
+#pragma link C++ class CandidateJet+;
 #pragma link C++ class Candidate+;
 
 #endif
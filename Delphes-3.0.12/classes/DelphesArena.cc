@@ -0,0 +1,98 @@
+
+/** \class DelphesArena
+ *
+ *  Bump-pointer arena of objects of one class.
+ *  Objects are constructed in contiguous blocks the first time
+ *  they are needed and reused in the following events,
+ *  Clear() makes all objects available again in constant time.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesArena.h"
+
+#include "TClass.h"
+#include "TObject.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+DelphesArena::DelphesArena(TClass *cl, Int_t blockSize) :
+  fClass(cl), fObjectSize(0), fBlockSize(blockSize),
+  fBlockIndex(0), fCurrent(0), fEnd(0), fSize(0)
+{
+  stringstream message;
+
+  // objects are addressed as TObjects placed at the beginning of each slot
+  if(!fClass || fClass->GetBaseClassOffset(TObject::Class()) != 0)
+  {
+    message << "can't create arena for class '" << (fClass ? fClass->GetName() : "") << "'";
+    throw runtime_error(message.str());
+  }
+
+  fObjectSize = fClass->Size();
+  if(fBlockSize < 1) fBlockSize = 1;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesArena::~DelphesArena()
+{
+  vector< char * >::iterator itBlocks;
+
+  for(itBlocks = fBlocks.begin(); itBlocks != fBlocks.end(); ++itBlocks)
+  {
+    fClass->DeleteArray(*itBlocks);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesArena::Clear()
+{
+  fBlockIndex = 0;
+  fSize = 0;
+  if(fBlocks.empty())
+  {
+    fCurrent = fEnd = 0;
+  }
+  else
+  {
+    fCurrent = fBlocks.front();
+    fEnd = fCurrent + fObjectSize*fBlockSize;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesArena::NextBlock()
+{
+  stringstream message;
+  char *block;
+
+  // move to the next block if the current one is exhausted
+  if(fCurrent != 0) ++fBlockIndex;
+
+  if(fBlockIndex == fBlocks.size())
+  {
+    block = static_cast<char *>(fClass->NewArray(fBlockSize));
+    if(!block)
+    {
+      message << "can't allocate objects of class '" << fClass->GetName() << "'";
+      throw runtime_error(message.str());
+    }
+    fBlocks.push_back(block);
+  }
+
+  fCurrent = fBlocks[fBlockIndex];
+  fEnd = fCurrent + fObjectSize*fBlockSize;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,64 @@
+#ifndef DelphesArena_h
+#define DelphesArena_h
+
+/** \class DelphesArena
+ *
+ *  Bump-pointer arena of objects of one class.
+ *  Objects are constructed in contiguous blocks the first time
+ *  they are needed and reused in the following events,
+ *  Clear() makes all objects available again in constant time.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class TClass;
+class TObject;
+
+class DelphesArena
+{
+public:
+
+  DelphesArena(TClass *cl, Int_t blockSize = 1024);
+  ~DelphesArena();
+
+  TClass *GetClass() const { return fClass; }
+
+  // returns the next object, objects are not cleared
+  TObject *New()
+  {
+    char *object;
+    if(fCurrent == fEnd) NextBlock();
+    object = fCurrent;
+    fCurrent += fObjectSize;
+    ++fSize;
+    return reinterpret_cast<TObject *>(object);
+  }
+
+  void Clear();
+
+  Long64_t GetSize() const { return fSize; }
+  Long64_t GetCapacity() const { return Long64_t(fBlocks.size())*fBlockSize; }
+
+private:
+
+  void NextBlock();
+
+  TClass *fClass;
+  Long_t fObjectSize;
+  Int_t fBlockSize;
+
+  std::vector< char * > fBlocks;
+  std::vector< char * >::size_type fBlockIndex;
+
+  char *fCurrent, *fEnd;
+
+  Long64_t fSize;
+};
+
+#endif /* DelphesArena_h */
@@ -0,0 +1,61 @@
+#ifndef DelphesCandidateSpan_h
+#define DelphesCandidateSpan_h
+
+/** \class DelphesCandidateSpan
+ *
+ *  View of the candidates stored in a TObjArray.
+ *  Candidates are read directly from the contiguous storage of the array,
+ *  without allocating a TIterator and without virtual calls.
+ *  The span is valid as long as no object is added to the array,
+ *  it is meant to be created on the stack at the beginning of a loop.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "TObjArray.h"
+
+#include "classes/DelphesClasses.h"
+
+class DelphesCandidateSpan
+{
+public:
+
+  class iterator
+  {
+  public:
+
+    iterator(TObject * const *current = 0) : fCurrent(current) {}
+
+    Candidate *operator*() const { return static_cast<Candidate *>(*fCurrent); }
+
+    iterator &operator++() { ++fCurrent; return *this; }
+
+    bool operator==(const iterator &other) const { return fCurrent == other.fCurrent; }
+    bool operator!=(const iterator &other) const { return fCurrent != other.fCurrent; }
+
+  private:
+
+    TObject * const *fCurrent;
+  };
+
+  // arrays filled by Delphes modules never contain empty slots
+  DelphesCandidateSpan(const TObjArray *array) :
+    fBegin(array->GetObjectRef(0)), fSize(array->GetEntriesFast()) {}
+
+  iterator begin() const { return iterator(fBegin); }
+  iterator end() const { return iterator(fBegin + fSize); }
+
+  Int_t size() const { return fSize; }
+  Bool_t empty() const { return fSize == 0; }
+
+  Candidate *operator[](Int_t i) const { return static_cast<Candidate *>(fBegin[i]); }
+
+private:
+
+  TObject * const *fBegin;
+  Int_t fSize;
+};
+
+#endif /* DelphesCandidateSpan_h */
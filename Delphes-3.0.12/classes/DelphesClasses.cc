@@ -18,6 +18,12 @@
 #include "classes/DelphesFactory.h"
 #include "classes/SortableObject.h"
 
+#include "TVirtualMutex.h"
+
+#include <algorithm>
+
+using namespace std;
+
 CompBase *GenParticle::fgCompare = 0;
 CompBase *Photon::fgCompare = CompPT<Photon>::Instance();
 CompBase *Electron::fgCompare = CompPT<Electron>::Instance();
@@ -101,28 +107,39 @@ TLorentzVector Tower::P4()
 
 //------------------------------------------------------------------------------
 
-Candidate::Candidate() :
-  PID(0), Status(0), M1(-1), M2(-1), D1(-1), D2(-1),
-  Charge(0), Mass(0.0),
-  IsPU(0), IsConstituent(0),
-  BTag(0), TauTag(0), Eem(0.0), Ehad(0.0),
+CandidateTower::CandidateTower() :
+  Eem(0.0), Ehad(0.0)
+{
+  Edges[0] = 0.0;
+  Edges[1] = 0.0;
+  Edges[2] = 0.0;
+  Edges[3] = 0.0;
+}
+
+//------------------------------------------------------------------------------
+
+void CandidateTower::Clear(Option_t* option)
+{
+  Eem = 0.0;
+  Ehad = 0.0;
+  Edges[0] = 0.0;
+  Edges[1] = 0.0;
+  Edges[2] = 0.0;
+  Edges[3] = 0.0;
+}
+
+//------------------------------------------------------------------------------
+
+CandidateJet::CandidateJet() :
   DeltaEta(0.0), DeltaPhi(0.0),
-  Momentum(0.0, 0.0, 0.0, 0.0),
-  Position(0.0, 0.0, 0.0, 0.0),
   Area(0.0, 0.0, 0.0, 0.0),
   NCharged(0),
   NNeutrals(0),
   Beta(0),
   BetaStar(0),
   MeanSqDeltaR(0),
-  PTD(0),
-  fFactory(0),
-  fArray(0)
+  PTD(0)
 {
-  Edges[0] = 0.0;
-  Edges[1] = 0.0;
-  Edges[2] = 0.0;
-  Edges[3] = 0.0;
   FracPt[0] = 0.0;
   FracPt[1] = 0.0;
   FracPt[2] = 0.0;
@@ -132,10 +149,84 @@ Candidate::Candidate() :
 
 //------------------------------------------------------------------------------
 
+void CandidateJet::Clear(Option_t* option)
+{
+  DeltaEta = 0.0;
+  DeltaPhi = 0.0;
+  Area.SetXYZT(0.0, 0.0, 0.0, 0.0);
+
+  NCharged = 0;
+  NNeutrals = 0;
+  Beta = 0.0;
+  BetaStar = 0.0;
+  MeanSqDeltaR = 0.0;
+  PTD = 0.0;
+  FracPt[0] = 0.0;
+  FracPt[1] = 0.0;
+  FracPt[2] = 0.0;
+  FracPt[3] = 0.0;
+  FracPt[4] = 0.0;
+}
+
+//------------------------------------------------------------------------------
+
+Candidate::Candidate() :
+  PID(0), Status(0), M1(-1), M2(-1), D1(-1), D2(-1),
+  Charge(0), Mass(0.0),
+  IsPU(0), IsConstituent(0),
+  BTag(0), TauTag(0),
+  Momentum(0.0, 0.0, 0.0, 0.0),
+  Position(0.0, 0.0, 0.0, 0.0),
+  fFactory(0),
+  fArray(0),
+  fTower(0),
+  fJet(0),
+  fLeavesStamp(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+CandidateTower &Candidate::Tower()
+{
+  if(!fTower) fTower = fFactory->New<CandidateTower>();
+  return *fTower;
+}
+
+//------------------------------------------------------------------------------
+
+CandidateJet &Candidate::Jet()
+{
+  if(!fJet) fJet = fFactory->New<CandidateJet>();
+  return *fJet;
+}
+
+//------------------------------------------------------------------------------
+
+const CandidateTower &Candidate::GetTower() const
+{
+  static const CandidateTower empty;
+  return fTower ? *fTower : empty;
+}
+
+//------------------------------------------------------------------------------
+
+const CandidateJet &Candidate::GetJet() const
+{
+  static const CandidateJet empty;
+  return fJet ? *fJet : empty;
+}
+
+//------------------------------------------------------------------------------
+
 void Candidate::AddCandidate(Candidate *object)
 {
   if(!fArray) fArray = fFactory->NewArray();
   fArray->Add(object);
+
+  // invalidates the cached leaves of this candidate
+  // and of all candidates built from it
+  fFactory->UpdateStamp();
 }
 
 //------------------------------------------------------------------------------
@@ -148,28 +239,67 @@ TObjArray *Candidate::GetCandidates()
 
 //------------------------------------------------------------------------------
 
-Bool_t Candidate::Overlaps(const Candidate *object) const
+const vector< UInt_t > &Candidate::GetLeaves() const
+{
+  // candidates can be shared by modules running concurrently
+  R__LOCKGUARD(fFactory ? fFactory->GetMutex() : 0);
+  FillLeaves(fFactory ? fFactory->GetStamp() : 1);
+  return fLeaves;
+}
+
+//------------------------------------------------------------------------------
+
+void Candidate::FillLeaves(ULong64_t stamp) const
 {
   const Candidate *candidate;
+  Int_t i, size;
 
-  if(object->GetUniqueID() == GetUniqueID()) return kTRUE;
+  if(fLeavesStamp == stamp) return;
 
-  if(fArray)
+  fLeaves.clear();
+
+  size = fArray ? fArray->GetEntriesFast() : 0;
+  if(size == 0)
+  {
+    fLeaves.push_back(GetUniqueID());
+  }
+  else
   {
-    TIter it(fArray);
-    while((candidate = static_cast<Candidate *>(it.Next())))
+    for(i = 0; i < size; ++i)
+    {
+      candidate = static_cast<const Candidate *>(fArray->UncheckedAt(i));
+      candidate->FillLeaves(stamp);
+      fLeaves.insert(fLeaves.end(), candidate->fLeaves.begin(), candidate->fLeaves.end());
+    }
+    if(size > 1)
     {
-      if(candidate->Overlaps(object)) return kTRUE;
+      sort(fLeaves.begin(), fLeaves.end());
+      fLeaves.erase(unique(fLeaves.begin(), fLeaves.end()), fLeaves.end());
     }
   }
 
-  if(object->fArray)
+  fLeavesStamp = stamp;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t Candidate::Overlaps(const Candidate *object) const
+{
+  // two candidates share a constituent at any level
+  // if and only if they share a candidate without constituents
+  if(object->GetUniqueID() == GetUniqueID()) return kTRUE;
+
+  const vector< UInt_t > &leaves1 = GetLeaves();
+  const vector< UInt_t > &leaves2 = object->GetLeaves();
+
+  vector< UInt_t >::const_iterator it1 = leaves1.begin();
+  vector< UInt_t >::const_iterator it2 = leaves2.begin();
+
+  while(it1 != leaves1.end() && it2 != leaves2.end())
   {
-    TIter it(object->fArray);
-    while((candidate = static_cast<Candidate *>(it.Next())))
-    {
-      if(candidate->Overlaps(this)) return kTRUE;
-    }
+    if(*it1 < *it2) ++it1;
+    else if(*it2 < *it1) ++it2;
+    else return kTRUE;
   }
 
   return kFALSE;
@@ -204,32 +334,18 @@ void Candidate::Copy(TObject &obj) const
   object.IsConstituent = IsConstituent;
   object.BTag = BTag;
   object.TauTag = TauTag;
-  object.Eem = Eem;
-  object.Ehad = Ehad;
-  object.Edges[0] = Edges[0];
-  object.Edges[1] = Edges[1];
-  object.Edges[2] = Edges[2];
-  object.Edges[3] = Edges[3];
-  object.DeltaEta = DeltaEta;
-  object.DeltaPhi = DeltaPhi;
   object.Momentum = Momentum;
   object.Position = Position;
-  object.Area = Area;
-
-  object.NCharged = NCharged;
-  object.NNeutrals = NNeutrals;
-  object.Beta = Beta;
-  object.BetaStar = BetaStar;
-  object.MeanSqDeltaR = MeanSqDeltaR;
-  object.PTD = PTD;
-  object.FracPt[0] = FracPt[0];
-  object.FracPt[1] = FracPt[1];
-  object.FracPt[2] = FracPt[2];
-  object.FracPt[3] = FracPt[3];
-  object.FracPt[4] = FracPt[4];
 
   object.fFactory = fFactory;
   object.fArray = 0;
+  object.fTower = 0;
+  object.fJet = 0;
+
+  if(fTower) object.Tower() = *fTower;
+  if(fJet) object.Jet() = *fJet;
+
+  object.fLeavesStamp = 0;
 
   if(fArray && fArray->GetEntriesFast() > 0)
   {
@@ -257,29 +373,13 @@ void Candidate::Clear(Option_t* option)
   IsConstituent = 0;
   BTag = 0;
   TauTag = 0;
-  Eem = 0.0;
-  Ehad = 0.0;
-  Edges[0] = 0.0;
-  Edges[1] = 0.0;
-  Edges[2] = 0.0;
-  Edges[3] = 0.0;
-  DeltaEta = 0.0;
-  DeltaPhi = 0.0;
   Momentum.SetXYZT(0.0, 0.0, 0.0, 0.0);
   Position.SetXYZT(0.0, 0.0, 0.0, 0.0);
-  Area.SetXYZT(0.0, 0.0, 0.0, 0.0);
-
-  NCharged = 0;
-  NNeutrals = 0;
-  Beta = 0.0;
-  BetaStar = 0.0;
-  MeanSqDeltaR = 0.0;
-  PTD = 0.0;
-  FracPt[0] = 0.0;
-  FracPt[1] = 0.0;
-  FracPt[2] = 0.0;
-  FracPt[3] = 0.0;
-  FracPt[4] = 0.0;
 
   fArray = 0;
+  fTower = 0;
+  fJet = 0;
+
+  fLeaves.clear();
+  fLeavesStamp = 0;
 }
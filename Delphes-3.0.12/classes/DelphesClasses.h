@@ -24,6 +24,8 @@
 
 #include "classes/SortableObject.h"
 
+#include <vector>
+
 class DelphesFactory;
 
 //---------------------------------------------------------------------------
@@ -201,6 +203,16 @@ public:
 
 //---------------------------------------------------------------------------
 
+class LHEFWeight: public TObject
+{
+public:
+  std::vector< Float_t > Weights; // all weights of the event, in the order of the ids stored in LHEFWeightIDs | <rwgt>, <weights>
+
+  ClassDef(LHEFWeight, 1)
+};
+
+//---------------------------------------------------------------------------
+
 class Photon: public SortableObject
 {
 public:
@@ -389,36 +401,43 @@ public:
 
 //---------------------------------------------------------------------------
 
-class Candidate: public SortableObject
+class ReferenceIndices: public TObject
 {
-  friend class DelphesFactory;
-
 public:
-  Candidate();
-
-  Int_t PID;
-
-  Int_t Status;
-  Int_t M1, M2, D1, D2;
-
-  Int_t Charge;
+  std::vector< Int_t > ParticleIndices; // indices of generated particles in the particle branch, one for tracks, electrons and muons
+  std::vector< Int_t > ConstituentIndices; // jet constituents as (branch << 24) | index, see DelphesIndexReader
 
-  Float_t Mass;
+  ClassDef(ReferenceIndices, 1)
+};
 
-  Int_t IsPU;
-  Int_t IsConstituent;
+//---------------------------------------------------------------------------
 
-  UInt_t BTag;
-  UInt_t TauTag;
+class CandidateTower: public TObject
+{
+public:
+  CandidateTower();
 
   Float_t Eem;
   Float_t Ehad;
 
   Float_t Edges[4];
+
+  virtual void Clear(Option_t* option = "");
+
+  ClassDef(CandidateTower, 1)
+};
+
+//---------------------------------------------------------------------------
+
+class CandidateJet: public TObject
+{
+public:
+  CandidateJet();
+
   Float_t DeltaEta;
   Float_t DeltaPhi;
 
-  TLorentzVector Momentum, Position, Area;
+  TLorentzVector Area;
 
   // PileUpJetID variables
 
@@ -430,14 +449,61 @@ public:
   Float_t  PTD;
   Float_t  FracPt[5];
 
+  virtual void Clear(Option_t* option = "");
+
+  ClassDef(CandidateJet, 1)
+};
+
+//---------------------------------------------------------------------------
+
+class Candidate: public SortableObject
+{
+  friend class DelphesFactory;
+
+public:
+  Candidate();
+
+  Int_t PID;
+
+  Int_t Status;
+  Int_t M1, M2, D1, D2;
+
+  Int_t Charge;
+
+  Float_t Mass;
+
+  Int_t IsPU;
+  Int_t IsConstituent;
+
+  UInt_t BTag;
+  UInt_t TauTag;
+
+  TLorentzVector Momentum, Position;
+
   static CompBase *fgCompare; //!
   const CompBase *GetCompare() const { return fgCompare; }
 
+  // calorimeter tower and jet properties are only allocated for the
+  // candidates that use them, Tower() and Jet() create them on demand,
+  // GetTower() and GetJet() return zeros for the other candidates
+
+  CandidateTower &Tower();
+  CandidateJet &Jet();
+
+  const CandidateTower &GetTower() const;
+  const CandidateJet &GetJet() const;
+
   void AddCandidate(Candidate *object);
   TObjArray *GetCandidates();
 
+  // true if both candidates were built from a common candidate,
+  // compares the cached sets of their leaf candidates
   Bool_t Overlaps(const Candidate *object) const;
 
+  // sorted unique IDs of the candidates without constituents this candidate is built from,
+  // cached until AddCandidate is called on any candidate of the same factory
+  const std::vector< UInt_t > &GetLeaves() const;
+
   virtual void Copy(TObject &object) const;
   virtual TObject *Clone(const char *newname = "") const;
   virtual void Clear(Option_t* option = "");
@@ -446,8 +512,17 @@ private:
   DelphesFactory *fFactory; //!
   TObjArray *fArray; //!
 
+  CandidateTower *fTower; //!
+  CandidateJet *fJet; //!
+
+  // filled by GetLeaves, valid while fLeavesStamp is the factory stamp
+  mutable std::vector< UInt_t > fLeaves; //!
+  mutable ULong64_t fLeavesStamp; //!
+
   void SetFactory(DelphesFactory *factory) { fFactory = factory; }
 
+  void FillLeaves(ULong64_t stamp) const;
+
   ClassDef(Candidate, 1)
 };
 
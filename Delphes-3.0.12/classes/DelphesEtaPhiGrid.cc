@@ -0,0 +1,199 @@
+
+/** \class DelphesEtaPhiGrid
+ *
+ *  Grid of cells in pseudorapidity and azimuthal angle used
+ *  to find the objects close to a given direction without
+ *  looping over all objects. The grid is filled once per event,
+ *  Find() returns the numbers of the objects in the cells that
+ *  overlap the circle of radius deltaR, taking into account
+ *  that the azimuthal angle is periodic. These objects are
+ *  a superset of the objects within deltaR, the caller applies
+ *  the exact selection.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesEtaPhiGrid.h"
+#include "classes/DelphesClasses.h"
+
+#include "TMath.h"
+#include "TObjArray.h"
+
+#include <algorithm>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+DelphesEtaPhiGrid::DelphesEtaPhiGrid(Double_t cellSize, Double_t etaMax) :
+  fEtaMax(etaMax), fEtaCellSize(cellSize), fPhiCellSize(cellSize),
+  fEtaCells(0), fPhiCells(0)
+{
+  // very small cells would only increase the number of cells to visit
+  if(fEtaCellSize < 0.05) fEtaCellSize = 0.05;
+  if(fEtaMax < fEtaCellSize) fEtaMax = fEtaCellSize;
+
+  // one more cell on each side for the objects beyond etaMax
+  fEtaCells = Int_t(TMath::Ceil(2.0*fEtaMax/fEtaCellSize)) + 2;
+
+  fPhiCells = Int_t(TMath::TwoPi()/fEtaCellSize);
+  if(fPhiCells < 1) fPhiCells = 1;
+  fPhiCellSize = TMath::TwoPi()/fPhiCells;
+
+  fCellStart.resize(fEtaCells*fPhiCells + 1, 0);
+}
+
+//------------------------------------------------------------------------------
+
+DelphesEtaPhiGrid::~DelphesEtaPhiGrid()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEtaPhiGrid::Clear()
+{
+  fEta.clear();
+  fPhi.clear();
+  fCells.clear();
+  fObjects.clear();
+  fill(fCellStart.begin(), fCellStart.end(), 0);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEtaPhiGrid::Add(Double_t eta, Double_t phi)
+{
+  fEta.push_back(eta);
+  fPhi.push_back(phi);
+}
+
+//------------------------------------------------------------------------------
+
+Int_t DelphesEtaPhiGrid::EtaCell(Double_t eta) const
+{
+  Int_t cell;
+
+  if(eta >= fEtaMax) return fEtaCells - 1;
+  // also catches NaN, such objects never pass a deltaR selection
+  if(!(eta > -fEtaMax)) return 0;
+
+  cell = 1 + Int_t((eta + fEtaMax)/fEtaCellSize);
+  return (cell > fEtaCells - 2) ? fEtaCells - 2 : cell;
+}
+
+//------------------------------------------------------------------------------
+
+Int_t DelphesEtaPhiGrid::PhiCell(Double_t phi) const
+{
+  Int_t cell;
+
+  if(!(phi == phi)) return 0;
+
+  cell = Int_t(TMath::Floor((phi + TMath::Pi())/fPhiCellSize)) % fPhiCells;
+  return (cell < 0) ? cell + fPhiCells : cell;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEtaPhiGrid::Build()
+{
+  Int_t i, cell, size, cells;
+
+  size = fEta.size();
+  cells = fEtaCells*fPhiCells;
+
+  fCells.resize(size);
+  fObjects.resize(size);
+  fill(fCellStart.begin(), fCellStart.end(), 0);
+
+  // counting sort, objects stay in increasing order within each cell
+  for(i = 0; i < size; ++i)
+  {
+    cell = EtaCell(fEta[i])*fPhiCells + PhiCell(fPhi[i]);
+    fCells[i] = cell;
+    ++fCellStart[cell + 1];
+  }
+
+  for(cell = 0; cell < cells; ++cell)
+  {
+    fCellStart[cell + 1] += fCellStart[cell];
+  }
+
+  for(i = 0; i < size; ++i)
+  {
+    fObjects[fCellStart[fCells[i]]++] = i;
+  }
+
+  // restore cell starts shifted by the previous loop
+  for(cell = cells; cell > 0; --cell)
+  {
+    fCellStart[cell] = fCellStart[cell - 1];
+  }
+  fCellStart[0] = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEtaPhiGrid::Fill(const TObjArray *array)
+{
+  Candidate *candidate;
+  Int_t i, size;
+
+  Clear();
+
+  size = array ? array->GetEntriesFast() : 0;
+  for(i = 0; i < size; ++i)
+  {
+    candidate = static_cast<Candidate*>(array->UncheckedAt(i));
+    const TLorentzVector &momentum = candidate->Momentum;
+    Add(momentum.Eta(), momentum.Phi());
+  }
+
+  Build();
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEtaPhiGrid::Find(Double_t eta, Double_t phi, Double_t deltaR, vector< Int_t > &result) const
+{
+  Int_t etaCell, etaFirst, etaLast, phiFirst, phiCells, j, cell, k;
+
+  result.clear();
+  if(fEta.empty() || !(deltaR >= 0.0)) return;
+
+  // small margin against rounding at the cell boundaries
+  deltaR = deltaR*(1.0 + 1.0E-9) + 1.0E-9;
+
+  etaFirst = EtaCell(eta - deltaR);
+  etaLast = EtaCell(eta + deltaR);
+
+  phiFirst = Int_t(TMath::Floor((phi - deltaR + TMath::Pi())/fPhiCellSize));
+  phiCells = Int_t(TMath::Floor((phi + deltaR + TMath::Pi())/fPhiCellSize)) - phiFirst + 1;
+  if(!(phi == phi) || phiCells >= fPhiCells)
+  {
+    phiFirst = 0;
+    phiCells = fPhiCells;
+  }
+  phiFirst %= fPhiCells;
+  if(phiFirst < 0) phiFirst += fPhiCells;
+
+  for(etaCell = etaFirst; etaCell <= etaLast; ++etaCell)
+  {
+    for(j = 0; j < phiCells; ++j)
+    {
+      cell = etaCell*fPhiCells + (phiFirst + j) % fPhiCells;
+      for(k = fCellStart[cell]; k < fCellStart[cell + 1]; ++k)
+      {
+        result.push_back(fObjects[k]);
+      }
+    }
+  }
+
+  // same order as a loop over all objects
+  sort(result.begin(), result.end());
+}
+
+//------------------------------------------------------------------------------
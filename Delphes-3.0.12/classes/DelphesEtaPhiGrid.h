@@ -0,0 +1,68 @@
+#ifndef DelphesEtaPhiGrid_h
+#define DelphesEtaPhiGrid_h
+
+/** \class DelphesEtaPhiGrid
+ *
+ *  Grid of cells in pseudorapidity and azimuthal angle used
+ *  to find the objects close to a given direction without
+ *  looping over all objects. The grid is filled once per event,
+ *  Find() returns the numbers of the objects in the cells that
+ *  overlap the circle of radius deltaR, taking into account
+ *  that the azimuthal angle is periodic. These objects are
+ *  a superset of the objects within deltaR, the caller applies
+ *  the exact selection.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class TObjArray;
+
+class DelphesEtaPhiGrid
+{
+public:
+
+  DelphesEtaPhiGrid(Double_t cellSize = 0.5, Double_t etaMax = 5.0);
+  ~DelphesEtaPhiGrid();
+
+  void Clear();
+
+  // objects are numbered in the order they are added
+  void Add(Double_t eta, Double_t phi);
+
+  // sorts objects into cells, called after the last Add()
+  void Build();
+
+  // adds momenta of all candidates in the array,
+  // object numbers are positions in the array
+  void Fill(const TObjArray *array);
+
+  Int_t GetSize() const { return fEta.size(); }
+
+  // numbers of the objects that can be within deltaR of (eta, phi), in increasing order
+  void Find(Double_t eta, Double_t phi, Double_t deltaR, std::vector< Int_t > &result) const;
+
+private:
+
+  Int_t EtaCell(Double_t eta) const;
+  Int_t PhiCell(Double_t phi) const;
+
+  Double_t fEtaMax;
+  Double_t fEtaCellSize, fPhiCellSize;
+
+  Int_t fEtaCells, fPhiCells;
+
+  std::vector< Double_t > fEta, fPhi;
+
+  // objects sorted by cell, objects of cell i are from fCellStart[i] to fCellStart[i + 1]
+  std::vector< Int_t > fCellStart;
+  std::vector< Int_t > fCells;
+  std::vector< Int_t > fObjects;
+};
+
+#endif /* DelphesEtaPhiGrid_h */
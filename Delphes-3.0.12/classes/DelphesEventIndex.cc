@@ -0,0 +1,272 @@
+
+/** \class DelphesEventIndex
+ *
+ *  Byte offsets of the event records in a HepMC or LHEF file.
+ *  The offsets are found in one pass over the lines of the file and
+ *  are kept in a sidecar file (input_file.idx) next to the input,
+ *  so that readers can seek directly to any event.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesEventIndex.h"
+
+#include "classes/DelphesInputBuffer.h"
+
+#include <algorithm>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+// sidecar layout: magic, format, file size, modification time,
+// number of events, the offsets and the checksum of all the previous fields
+// except the magic, all in native byte order
+static const char kMagic[8] = {'D', 'L', 'P', 'H', 'I', 'D', 'X', '2'};
+
+static const char kEventTag[] = "<event";
+
+static const size_t kHeaderSize = sizeof(kMagic) + sizeof(int) + 3*sizeof(long long);
+
+//------------------------------------------------------------------------------
+
+// 64-bit FNV-1a hash
+static unsigned long long Checksum(const void *buffer, size_t size, unsigned long long hash = 0xCBF29CE484222325ULL)
+{
+  const unsigned char *bytes = static_cast<const unsigned char *>(buffer);
+  size_t i;
+
+  for(i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 0x100000001B3ULL;
+  }
+
+  return hash;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesEventIndex::DelphesEventIndex(Format format) :
+  fFormat(format), fFileSize(0), fModificationTime(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+string DelphesEventIndex::GetIndexName(const char *fileName)
+{
+  return string(fileName) + ".idx";
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesEventIndex::Load(const char *fileName)
+{
+  struct stat status;
+  string indexName;
+  FILE *inputFile;
+
+  if(stat(fileName, &status) != 0 || !S_ISREG(status.st_mode)) return false;
+
+  fFileSize = status.st_size;
+  fModificationTime = status.st_mtime;
+
+  indexName = GetIndexName(fileName);
+
+  if(Read(indexName.c_str())) return true;
+
+  inputFile = fopen(fileName, "r");
+  if(!inputFile) return false;
+
+  Build(inputFile);
+  fclose(inputFile);
+
+  // the index is still usable when the directory is read-only
+  Write(indexName.c_str());
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEventIndex::Build(FILE *inputFile)
+{
+  DelphesInputBuffer buffer;
+  const char *begin, *end;
+  long long position;
+  const char *tag;
+  size_t length = strlen(kEventTag);
+
+  fOffsets.clear();
+
+  rewind(inputFile);
+  buffer.SetInputFile(inputFile);
+
+  position = buffer.GetPosition();
+  while(buffer.ReadLine(begin, end))
+  {
+    if(fFormat == kHepMC)
+    {
+      if(begin < end && begin[0] == 'E') fOffsets.push_back(position);
+    }
+    else
+    {
+      // same test as DelphesLHEFReader, the tag can be anywhere in the line
+      // and can have attributes
+      tag = search(begin, end, kEventTag, kEventTag + length);
+      if(tag + length < end && (tag[length] == '>' || tag[length] == ' ' || tag[length] == '\t'))
+      {
+        fOffsets.push_back(position);
+      }
+    }
+    position = buffer.GetPosition();
+  }
+
+  fFileSize = position;
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesEventIndex::Read(const char *indexName)
+{
+  char magic[sizeof(kMagic)];
+  int format;
+  long long fileSize, modificationTime, size, i;
+  unsigned long long checksum, expected;
+  struct stat status;
+  FILE *indexFile;
+  bool rc;
+
+  indexFile = fopen(indexName, "rb");
+  if(!indexFile) return false;
+
+  rc = fread(magic, sizeof(magic), 1, indexFile) == 1
+    && memcmp(magic, kMagic, sizeof(kMagic)) == 0
+    && fread(&format, sizeof(format), 1, indexFile) == 1
+    && fread(&fileSize, sizeof(fileSize), 1, indexFile) == 1
+    && fread(&modificationTime, sizeof(modificationTime), 1, indexFile) == 1
+    && fread(&size, sizeof(size), 1, indexFile) == 1
+    && format == fFormat
+    && fileSize == fFileSize
+    && modificationTime == fModificationTime
+    && size >= 0 && size <= fileSize;
+
+  // a truncated or overwritten sidecar does not have the size given by its header
+  rc = rc && fstat(fileno(indexFile), &status) == 0
+    && (long long)(status.st_size) == (long long)(kHeaderSize + (size + 1)*sizeof(long long));
+
+  if(rc)
+  {
+    fOffsets.resize(size);
+    rc = ((size == 0) || fread(&fOffsets[0], sizeof(long long), size, indexFile) == size_t(size))
+      && fread(&checksum, sizeof(checksum), 1, indexFile) == 1;
+  }
+
+  if(rc)
+  {
+    expected = Checksum(&format, sizeof(format));
+    expected = Checksum(&fileSize, sizeof(fileSize), expected);
+    expected = Checksum(&modificationTime, sizeof(modificationTime), expected);
+    expected = Checksum(&size, sizeof(size), expected);
+    if(size > 0) expected = Checksum(&fOffsets[0], size*sizeof(long long), expected);
+    rc = checksum == expected;
+  }
+
+  // the offsets increase and are inside the file
+  for(i = 0; rc && i < size; ++i)
+  {
+    rc = fOffsets[i] >= 0 && fOffsets[i] < fileSize && (i == 0 || fOffsets[i] > fOffsets[i - 1]);
+  }
+
+  fclose(indexFile);
+
+  if(!rc) fOffsets.clear();
+
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesEventIndex::Write(const char *indexName) const
+{
+  int format = fFormat;
+  long long size = fOffsets.size();
+  unsigned long long checksum;
+  string temporaryName;
+  vector< char > name;
+  FILE *indexFile;
+  int descriptor;
+  bool rc;
+
+  checksum = Checksum(&format, sizeof(format));
+  checksum = Checksum(&fFileSize, sizeof(fFileSize), checksum);
+  checksum = Checksum(&fModificationTime, sizeof(fModificationTime), checksum);
+  checksum = Checksum(&size, sizeof(size), checksum);
+  if(size > 0) checksum = Checksum(&fOffsets[0], size*sizeof(long long), checksum);
+
+  // the sidecar is written under a unique name and renamed into place,
+  // so that jobs reading the same input never see a partial sidecar
+  temporaryName = string(indexName) + ".XXXXXX";
+  name.assign(temporaryName.begin(), temporaryName.end());
+  name.push_back('\0');
+
+  descriptor = mkstemp(&name[0]);
+  if(descriptor < 0) return false;
+
+  indexFile = fdopen(descriptor, "wb");
+  if(!indexFile)
+  {
+    close(descriptor);
+    unlink(&name[0]);
+    return false;
+  }
+
+  rc = fwrite(kMagic, sizeof(kMagic), 1, indexFile) == 1
+    && fwrite(&format, sizeof(format), 1, indexFile) == 1
+    && fwrite(&fFileSize, sizeof(fFileSize), 1, indexFile) == 1
+    && fwrite(&fModificationTime, sizeof(fModificationTime), 1, indexFile) == 1
+    && fwrite(&size, sizeof(size), 1, indexFile) == 1
+    && (size == 0 || fwrite(&fOffsets[0], sizeof(long long), size, indexFile) == size_t(size))
+    && fwrite(&checksum, sizeof(checksum), 1, indexFile) == 1;
+
+  if(fclose(indexFile) != 0) rc = false;
+
+  // mkstemp creates the file readable only by its owner
+  rc = rc && chmod(&name[0], 0644) == 0 && rename(&name[0], indexName) == 0;
+
+  if(!rc) unlink(&name[0]);
+
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+
+long long DelphesEventIndex::GetOffset(long long entry) const
+{
+  if(entry < 0) entry = 0;
+  if(entry >= GetNumberOfEvents()) return fFileSize;
+  return fOffsets[entry];
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEventIndex::GetRange(int part, int numberOfParts, long long &first, long long &last) const
+{
+  long long size = GetNumberOfEvents();
+
+  if(numberOfParts < 1) numberOfParts = 1;
+  if(part < 0) part = 0;
+  if(part > numberOfParts) part = numberOfParts;
+
+  first = size*part/numberOfParts;
+  last = size*(part + 1)/numberOfParts;
+  if(last > size) last = size;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,61 @@
+#ifndef DelphesEventIndex_h
+#define DelphesEventIndex_h
+
+/** \class DelphesEventIndex
+ *
+ *  Byte offsets of the event records in a HepMC or LHEF file.
+ *  The offsets are found in one pass over the lines of the file and
+ *  are kept in a sidecar file (input_file.idx) next to the input,
+ *  so that readers can seek directly to any event.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+
+class DelphesEventIndex
+{
+public:
+
+  enum Format { kHepMC, kLHEF };
+
+  DelphesEventIndex(Format format);
+
+  // reads the sidecar file of fileName, or builds the index when the sidecar
+  // is missing, older than the input or corrupt and tries to write it,
+  // returns false when fileName is not a regular file
+  bool Load(const char *fileName);
+
+  // scans inputFile from its beginning, inputFile is left at the end of file
+  void Build(FILE *inputFile);
+
+  bool Write(const char *indexName) const;
+
+  long long GetNumberOfEvents() const { return fOffsets.size(); }
+
+  // offset of the first line of event entry,
+  // returns the size of the file for entry == GetNumberOfEvents()
+  long long GetOffset(long long entry) const;
+
+  // splits the events into numberOfParts contiguous ranges [first, last)
+  void GetRange(int part, int numberOfParts, long long &first, long long &last) const;
+
+  static std::string GetIndexName(const char *fileName);
+
+private:
+
+  bool Read(const char *indexName);
+
+  Format fFormat;
+
+  long long fFileSize, fModificationTime;
+
+  std::vector< long long > fOffsets;
+};
+
+#endif // DelphesEventIndex_h
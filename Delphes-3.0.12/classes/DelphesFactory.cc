@@ -14,20 +14,33 @@
 
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesArena.h"
 
 #include "ExRootAnalysis/ExRootTreeBranch.h"
 
 #include "TClass.h"
+#include "TMutex.h"
 #include "TObjArray.h"
+#include "TVirtualMutex.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
 
 using namespace std;
 
 //------------------------------------------------------------------------------
 
 DelphesFactory::DelphesFactory(const char *name) :
-  TNamed(name, ""), fObjArrays(0)
+  TNamed(name, ""), fObjArrays(0), fObjectCount(0), fStamp(1), fMutex(0),
+  fCandidates(0), fArrays(0), fLastArena(0)
 {
   fObjArrays = new ExRootTreeBranch("PermanentObjArrays", TObjArray::Class(), 0);
+
+  // most frequently used classes are looked up only once
+  fCandidates = NewArena(Candidate::Class());
+  fArrays = NewArena(TObjArray::Class());
+  fLastArena = fCandidates;
 }
 
 //------------------------------------------------------------------------------
@@ -35,11 +48,12 @@ DelphesFactory::DelphesFactory(const char *name) :
 DelphesFactory::~DelphesFactory()
 {
   if(fObjArrays) delete fObjArrays;
+  if(fMutex) delete fMutex;
 
-  map< const TClass*, ExRootTreeBranch* >::iterator itBranches;
-  for(itBranches = fBranches.begin(); itBranches != fBranches.end(); ++itBranches)
+  map< const TClass*, DelphesArena* >::iterator itArenas;
+  for(itArenas = fArenas.begin(); itArenas != fArenas.end(); ++itArenas)
   {
-    delete (itBranches->second);
+    delete (itArenas->second);
   }
 }
 
@@ -47,62 +61,165 @@ DelphesFactory::~DelphesFactory()
 
 void DelphesFactory::Clear()
 {
-  set<TObject *>::iterator itPool;
-  for(itPool = fPool.begin(); itPool != fPool.end(); ++itPool)
+  vector< TObjArray * >::iterator itArrays;
+  for(itArrays = fPermanentArrays.begin(); itArrays != fPermanentArrays.end(); ++itArrays)
   {
-    (*itPool)->Clear();
+    (*itArrays)->Clear();
   }
 
   TProcessID::SetObjectCount(0);
+  fObjectCount = 0;
+
+  // objects are cleared when they are reused
+  map< const TClass*, DelphesArena* >::iterator itArenas;
+  for(itArenas = fArenas.begin(); itArenas != fArenas.end(); ++itArenas)
+  {
+    itArenas->second->Clear();
+  }
+}
+
+//------------------------------------------------------------------------------
 
-  map< const TClass*, ExRootTreeBranch* >::iterator itBranches;
-  for(itBranches = fBranches.begin(); itBranches != fBranches.end(); ++itBranches)
+Long64_t DelphesFactory::GetSize() const
+{
+  Long64_t size = 0;
+  map< const TClass*, DelphesArena* >::const_iterator itArenas;
+  for(itArenas = fArenas.begin(); itArenas != fArenas.end(); ++itArenas)
+  {
+    size += itArenas->second->GetSize();
+  }
+  return size;
+}
+
+//------------------------------------------------------------------------------
+
+Long64_t DelphesFactory::GetCapacity() const
+{
+  Long64_t capacity = 0;
+  map< const TClass*, DelphesArena* >::const_iterator itArenas;
+  for(itArenas = fArenas.begin(); itArenas != fArenas.end(); ++itArenas)
   {
-    itBranches->second->Clear();
+    capacity += itArenas->second->GetCapacity();
   }
+  return capacity;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesFactory::EnableLocking()
+{
+  if(!fMutex) fMutex = new TMutex;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesFactory::UpdateStamp()
+{
+  R__LOCKGUARD(fMutex);
+  ++fStamp;
 }
 
 //------------------------------------------------------------------------------
 
 TObjArray *DelphesFactory::NewPermanentArray()
 {
+  R__LOCKGUARD(fMutex);
   TObjArray *array = static_cast<TObjArray *>(fObjArrays->NewEntry());
-  fPool.insert(array);
+  fPermanentArrays.push_back(array);
   return array;
 }
 
 //------------------------------------------------------------------------------
 
-Candidate *DelphesFactory::NewCandidate()
+Int_t DelphesFactory::RegisterArray(const char *name, TObjArray *array)
 {
-  Candidate *object = New<Candidate>();
-  object->SetFactory(this);
-  TProcessID::AssignID(object);
-  return object;
+  stringstream message;
+  Int_t index;
+
+  R__LOCKGUARD(fMutex);
+  if(fArrayIndices.find(name) != fArrayIndices.end())
+  {
+    message << "array '" << name << "' is exported more than once";
+    throw runtime_error(message.str());
+  }
+
+  index = fRegisteredArrays.size();
+  fRegisteredArrays.push_back(array);
+  fArrayIndices.insert(make_pair(string(name), index));
+
+  return index;
 }
 
 //------------------------------------------------------------------------------
 
-TObject *DelphesFactory::New(TClass *cl)
+Int_t DelphesFactory::FindArray(const char *name) const
 {
-  TObject *object = 0;
-  ExRootTreeBranch *branch = 0;
-  map<const TClass *, ExRootTreeBranch *>::iterator it = fBranches.find(cl);
+  R__LOCKGUARD(fMutex);
+  map< string, Int_t >::const_iterator itArrayIndices = fArrayIndices.find(name);
+  return (itArrayIndices != fArrayIndices.end()) ? itArrayIndices->second : -1;
+}
 
-  if(it != fBranches.end())
+//------------------------------------------------------------------------------
+
+TObjArray *DelphesFactory::NewArray()
+{
+  TObjArray *object;
   {
-    branch = it->second;
+    R__LOCKGUARD(fMutex);
+    object = static_cast<TObjArray *>(fArrays->New());
   }
-  else
+  object->Clear();
+  return object;
+}
+
+//------------------------------------------------------------------------------
+
+Candidate *DelphesFactory::NewCandidate()
+{
+  Candidate *object;
+  UInt_t uid;
   {
-    branch = new ExRootTreeBranch(cl->GetName(), cl, 0);
-    fBranches.insert(make_pair(cl, branch));
+    R__LOCKGUARD(fMutex);
+    object = static_cast<Candidate *>(fCandidates->New());
+    uid = ++fObjectCount;
   }
+  object->Clear();
+  object->SetFactory(this);
+
+  // unique IDs are counted per factory, so that module chains
+  // running in parallel do not share the global TProcessID counter
+  object->SetUniqueID(uid & 0xffffff);
+  object->SetBit(kIsReferenced);
+
+  return object;
+}
+
+//------------------------------------------------------------------------------
 
-  object = branch->NewEntry();
+TObject *DelphesFactory::New(TClass *cl)
+{
+  TObject *object;
+  {
+    R__LOCKGUARD(fMutex);
+    if(fLastArena->GetClass() != cl)
+    {
+      map< const TClass*, DelphesArena* >::iterator itArenas = fArenas.find(cl);
+      fLastArena = (itArenas != fArenas.end()) ? itArenas->second : NewArena(cl);
+    }
+    object = fLastArena->New();
+  }
   object->Clear();
   return object;
 }
 
 //------------------------------------------------------------------------------
 
+DelphesArena *DelphesFactory::NewArena(TClass *cl)
+{
+  DelphesArena *arena = new DelphesArena(cl);
+  fArenas.insert(make_pair(cl, arena));
+  return arena;
+}
+
+//------------------------------------------------------------------------------
+
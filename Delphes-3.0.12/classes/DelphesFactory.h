@@ -17,11 +17,14 @@
 #include "TNamed.h"
 
 #include <map>
-#include <set>
+#include <string>
+#include <vector>
 
+class TMutex;
 class TObjArray;
 class Candidate;
 
+class DelphesArena;
 class ExRootTreeBranch;
 
 class DelphesFactory: public TNamed
@@ -32,10 +35,27 @@ public:
   ~DelphesFactory();
 
   void Clear();
+
+  // serializes object creation for modules running concurrently
+  void EnableLocking();
+  TMutex *GetMutex() const { return fMutex; }
+
+  // counts the changes of candidate constituents, the cached leaves of
+  // a candidate are valid while the stamp is the one they were filled with,
+  // GetStamp() must be called with the mutex held when locking is enabled
+  ULong64_t GetStamp() const { return fStamp; }
+  void UpdateStamp();
  
   TObjArray *NewPermanentArray();
 
-  TObjArray *NewArray() { return New<TObjArray>(); }
+  // registry of the arrays exported by modules, names are "Module/array",
+  // arrays are looked up by name once at Init and by index afterwards
+  Int_t RegisterArray(const char *name, TObjArray *array);
+  Int_t FindArray(const char *name) const;
+  TObjArray *GetArray(Int_t index) const { return fRegisteredArrays[index]; }
+  Int_t GetNumberOfArrays() const { return fRegisteredArrays.size(); }
+
+  TObjArray *NewArray();
 
   Candidate *NewCandidate();
 
@@ -44,12 +64,31 @@ public:
   template<typename T>
   T *New() { return static_cast<T *>(New(T::Class())); }
 
+  // number of objects created since the last Clear() and number of reusable objects
+  Long64_t GetSize() const;
+  Long64_t GetCapacity() const;
+
 private:
 
+  DelphesArena *NewArena(TClass *cl);
+
   ExRootTreeBranch *fObjArrays; //!
 
-  std::map< const TClass*, ExRootTreeBranch* > fBranches; //!
-  std::set< TObject* > fPool; //!
+  UInt_t fObjectCount; //!
+
+  ULong64_t fStamp; //!
+
+  TMutex *fMutex; //!
+
+  DelphesArena *fCandidates; //!
+  DelphesArena *fArrays; //!
+  DelphesArena *fLastArena; //!
+
+  std::map< const TClass*, DelphesArena* > fArenas; //!
+  std::vector< TObjArray* > fPermanentArrays; //!
+
+  std::vector< TObjArray* > fRegisteredArrays; //!
+  std::map< std::string, Int_t > fArrayIndices; //!
   
   ClassDef(DelphesFactory, 1)
 };
@@ -20,49 +20,56 @@
 
 #include <map>
 #include <vector>
+#include <string>
 
 #include <stdio.h>
+#include <string.h>
 
 #include "TObjArray.h"
 #include "TStopwatch.h"
-#include "TDatabasePDG.h"
-#include "TParticlePDG.h"
 #include "TLorentzVector.h"
 
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
+#include "classes/DelphesPDGTable.h"
 #include "classes/DelphesStream.h"
+#include "classes/DelphesInputBuffer.h"
 
 #include "ExRootAnalysis/ExRootTreeBranch.h"
 
 using namespace std;
 
-static const int kBufferSize  = 1024;
-
 //---------------------------------------------------------------------------
 
 DelphesHepMCReader::DelphesHepMCReader() :
-  fInputFile(0), fBuffer(0), fPDG(0),
+  fInputBuffer(0), fPDG(0),
   fVertexCounter(-1), fInCounter(-1), fOutCounter(-1),
   fParticleCounter(0)
 {
-  fBuffer = new char[kBufferSize];
+  fInputBuffer = new DelphesInputBuffer;
 
-  fPDG = TDatabasePDG::Instance();
+  fPDG = DelphesPDGTable::Instance();
 }
 
 //---------------------------------------------------------------------------
 
 DelphesHepMCReader::~DelphesHepMCReader()
 {
-  if(fBuffer) delete[] fBuffer;
+  if(fInputBuffer) delete fInputBuffer;
 }
 
 //---------------------------------------------------------------------------
 
-void DelphesHepMCReader::SetInputFile(FILE *inputFile)
+void DelphesHepMCReader::SetInputFile(FILE *inputFile, long long length)
 {
-  fInputFile = inputFile;
+  fInputBuffer->SetInputFile(inputFile, length);
+}
+
+//---------------------------------------------------------------------------
+
+long long DelphesHepMCReader::GetPosition() const
+{
+  return fInputBuffer->GetPosition();
 }
 
 //---------------------------------------------------------------------------
@@ -100,14 +107,16 @@ bool DelphesHepMCReader::ReadBlock(DelphesFactory *factory,
   map< int, pair< int, int > >::iterator itMotherMap;
   map< int, pair< int, int > >::iterator itDaughterMap;
   char key, momentumUnit[4], positionUnit[3];
+  const char *begin, *end;
   int i, rc, state;
   double weight;
 
-  if(!fgets(fBuffer, kBufferSize, fInputFile)) return kFALSE;
+  // lines are read as a whole, whatever their length
+  if(!fInputBuffer->ReadLine(begin, end)) return kFALSE;
 
-  DelphesStream bufferStream(fBuffer + 1);
+  key = (begin < end) ? begin[0] : '\0';
 
-  key = fBuffer[0];
+  DelphesStream bufferStream((begin < end) ? begin + 1 : end, end);
 
   if(key == 'E')
   {
@@ -159,7 +168,8 @@ bool DelphesHepMCReader::ReadBlock(DelphesFactory *factory,
   }
   else if(key == 'U')
   {
-    rc = sscanf(fBuffer + 1, "%3s %2s", momentumUnit, positionUnit);
+    string units(begin + 1, end);
+    rc = sscanf(units.c_str(), "%3s %2s", momentumUnit, positionUnit);
 
     if(rc != 2)
     {
@@ -325,18 +335,28 @@ void DelphesHepMCReader::AnalyzeParticle(DelphesFactory *factory,
   TObjArray *partonOutputArray)
 {
   Candidate *candidate;
-  TParticlePDG *pdgParticle;
+  const DelphesPDGProperties *pdgProperties;
   int pdgCode;
+  bool stable, parton;
+
+  pdgProperties = &fPDG->GetProperties(fPID);
+  pdgCode = TMath::Abs(fPID);
+
+  stable = pdgProperties->known && fStatus == 1 && pdgProperties->stable;
+  parton = pdgProperties->known && !stable && (pdgCode <= 5 || pdgCode == 21 || pdgCode == 15);
+
+  // arrays that no module reads are not filled
+  stableParticleOutputArray = stable ? stableParticleOutputArray : 0;
+  partonOutputArray = parton ? partonOutputArray : 0;
+  if(!allParticleOutputArray && !stableParticleOutputArray && !partonOutputArray) return;
 
   candidate = factory->NewCandidate();
 
   candidate->PID = fPID;
-  pdgCode = TMath::Abs(candidate->PID);
 
   candidate->Status = fStatus;
 
-  pdgParticle = fPDG->GetParticle(fPID);
-  candidate->Charge = pdgParticle ? int(pdgParticle->Charge()/3.0) : -999;
+  candidate->Charge = pdgProperties->charge;
   candidate->Mass = fMass;
 
   candidate->Momentum.SetPxPyPzE(fPx, fPy, fPz, fE);
@@ -370,18 +390,19 @@ void DelphesHepMCReader::AnalyzeParticle(DelphesFactory *factory,
     candidate->D1 = 1;
   }
 
-  allParticleOutputArray->Add(candidate);
-
-  if(!pdgParticle) return;
-
-  if(fStatus == 1 && pdgParticle->Stable())
+  if(!allParticleOutputArray)
   {
-    stableParticleOutputArray->Add(candidate);
+    // mothers and daughters are indices in the array of all particles
+    candidate->M1 = candidate->M2 = -1;
+    candidate->D1 = candidate->D2 = -1;
   }
-  else if(pdgCode <= 5 || pdgCode == 21 || pdgCode == 15)
+  else
   {
-    partonOutputArray->Add(candidate);
+    allParticleOutputArray->Add(candidate);
   }
+
+  if(stableParticleOutputArray) stableParticleOutputArray->Add(candidate);
+  if(partonOutputArray) partonOutputArray->Add(candidate);
 }
 
 //---------------------------------------------------------------------------
@@ -393,6 +414,8 @@ void DelphesHepMCReader::FinalizeParticles(TObjArray *allParticleOutputArray)
   map< int, pair< int, int > >::iterator itDaughterMap;
   int i;
 
+  if(!allParticleOutputArray) return;
+
   for(i = 0; i < allParticleOutputArray->GetEntriesFast(); ++i)
   {
     candidate = static_cast<Candidate *>(allParticleOutputArray->At(i));
@@ -21,9 +21,10 @@
 
 class TObjArray;
 class TStopwatch;
-class TDatabasePDG;
+class DelphesPDGTable;
 class ExRootTreeBranch;
 class DelphesFactory;
+class DelphesInputBuffer;
 
 class DelphesHepMCReader
 {
@@ -32,7 +33,12 @@ public:
   DelphesHepMCReader();
   ~DelphesHepMCReader();
 
-  void SetInputFile(FILE *inputFile);
+  // reads from the current position of inputFile,
+  // at most length bytes when length is not negative
+  void SetInputFile(FILE *inputFile, long long length = -1);
+
+  // offset in the input file of the next line to be read
+  long long GetPosition() const;
 
   void Clear();
   bool EventReady();
@@ -54,11 +60,9 @@ private:
 
   void FinalizeParticles(TObjArray *allParticleOutputArray);
 
-  FILE *fInputFile;
-
-  char *fBuffer;
+  DelphesInputBuffer *fInputBuffer;
 
-  TDatabasePDG *fPDG;
+  const DelphesPDGTable *fPDG;
 
   int fEventNumber, fMPI, fProcessID, fSignalCode, fVertexCounter, fBeamCode[2];
   double fScale, fAlphaQCD, fAlphaQED;
@@ -0,0 +1,112 @@
+
+/** \class DelphesIndexReader
+ *
+ *  Resolves the index references written by TreeWriter
+ *  with IndexReferences enabled. The indices of the entries of a branch
+ *  are stored in the ReferenceIndices entries of the branch with the same
+ *  name followed by "Index", for example TrackIndex for Track.
+ *  Particle indices are entry numbers in the particle branch.
+ *  Jet constituents are (branch << 24) | index, where the branch is
+ *  a position in the ReferenceBranches list that TreeWriter stores
+ *  in the user info of the tree:
+ *
+ *    ExRootTreeReader *treeReader = new ExRootTreeReader(chain);
+ *    DelphesIndexReader references(treeReader->UseBranch("Particle"));
+ *    TClonesArray *branchJetIndex = treeReader->UseBranch("JetIndex");
+ *    chain->LoadTree(0);
+ *    references.UseBranches(treeReader, chain->GetTree());
+ *    ...
+ *    ReferenceIndices *indices = (ReferenceIndices *) branchJetIndex->At(i);
+ *    GenParticle *particle = references.GetParticle(indices->ParticleIndices[0]);
+ *    TObject *constituent = references.GetConstituent(indices->ConstituentIndices[0]);
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesIndexReader.h"
+#include "classes/DelphesClasses.h"
+
+#include "ExRootAnalysis/ExRootTreeReader.h"
+
+#include "TTree.h"
+#include "TList.h"
+#include "TObjString.h"
+#include "TClonesArray.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+DelphesIndexReader::DelphesIndexReader(TClonesArray *particles) :
+  fParticles(particles)
+{
+}
+
+//------------------------------------------------------------------------------
+
+DelphesIndexReader::~DelphesIndexReader()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesIndexReader::SetBranchArray(Int_t number, TClonesArray *array)
+{
+  if(number < 0) return;
+  if(number >= Int_t(fBranchArrays.size())) fBranchArrays.resize(number + 1, 0);
+  fBranchArrays[number] = array;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesIndexReader::UseBranches(ExRootTreeReader *treeReader, TTree *tree)
+{
+  TObjArray *names;
+  Int_t i;
+
+  if(!tree || !tree->GetUserInfo()) return kFALSE;
+
+  names = static_cast<TObjArray *>(tree->GetUserInfo()->FindObject("ReferenceBranches"));
+  if(!names) return kFALSE;
+
+  fBranchArrays.clear();
+  for(i = 0; i < names->GetEntriesFast(); ++i)
+  {
+    SetBranchArray(i, treeReader->UseBranch(static_cast<TObjString *>(names->At(i))->GetString()));
+  }
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+TObject *DelphesIndexReader::GetEntry(const TClonesArray *array, Int_t index) const
+{
+  if(!array || index < 0 || index >= array->GetEntriesFast()) return 0;
+  return array->UncheckedAt(index);
+}
+
+//------------------------------------------------------------------------------
+
+GenParticle *DelphesIndexReader::GetParticle(Int_t index) const
+{
+  return static_cast<GenParticle*>(GetEntry(fParticles, index));
+}
+
+//------------------------------------------------------------------------------
+
+TObject *DelphesIndexReader::GetConstituent(Int_t reference) const
+{
+  UInt_t number;
+
+  if(reference < 0) return 0;
+
+  number = reference >> 24;
+  if(number >= fBranchArrays.size()) return 0;
+
+  return GetEntry(fBranchArrays[number], reference & 0xFFFFFF);
+}
+
+//------------------------------------------------------------------------------
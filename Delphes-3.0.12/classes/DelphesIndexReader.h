@@ -0,0 +1,73 @@
+#ifndef DelphesIndexReader_h
+#define DelphesIndexReader_h
+
+/** \class DelphesIndexReader
+ *
+ *  Resolves the index references written by TreeWriter
+ *  with IndexReferences enabled. The indices of the entries of a branch
+ *  are stored in the ReferenceIndices entries of the branch with the same
+ *  name followed by "Index", for example TrackIndex for Track.
+ *  Particle indices are entry numbers in the particle branch.
+ *  Jet constituents are (branch << 24) | index, where the branch is
+ *  a position in the ReferenceBranches list that TreeWriter stores
+ *  in the user info of the tree:
+ *
+ *    ExRootTreeReader *treeReader = new ExRootTreeReader(chain);
+ *    DelphesIndexReader references(treeReader->UseBranch("Particle"));
+ *    TClonesArray *branchJetIndex = treeReader->UseBranch("JetIndex");
+ *    chain->LoadTree(0);
+ *    references.UseBranches(treeReader, chain->GetTree());
+ *    ...
+ *    ReferenceIndices *indices = (ReferenceIndices *) branchJetIndex->At(i);
+ *    GenParticle *particle = references.GetParticle(indices->ParticleIndices[0]);
+ *    TObject *constituent = references.GetConstituent(indices->ConstituentIndices[0]);
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "TObject.h"
+
+#include <vector>
+
+class TTree;
+class TClonesArray;
+
+class GenParticle;
+class ExRootTreeReader;
+
+class DelphesIndexReader: public TObject
+{
+public:
+
+  DelphesIndexReader(TClonesArray *particles = 0);
+  ~DelphesIndexReader();
+
+  void SetParticleArray(TClonesArray *particles) { fParticles = particles; }
+
+  // array of the branch with the given number in the ReferenceBranches list
+  void SetBranchArray(Int_t number, TClonesArray *array);
+
+  // reads ReferenceBranches from the user info of the tree
+  // and calls UseBranch for each of them, returns kFALSE without the list
+  Bool_t UseBranches(ExRootTreeReader *treeReader, TTree *tree);
+
+  // return 0 for negative indices and for entries that are not in the branch
+  GenParticle *GetParticle(Int_t index) const;
+
+  // jet constituent, an entry of any branch in ReferenceBranches
+  TObject *GetConstituent(Int_t reference) const;
+
+private:
+
+  TObject *GetEntry(const TClonesArray *array, Int_t index) const;
+
+  TClonesArray *fParticles; //!
+
+  std::vector< TClonesArray * > fBranchArrays; //!
+
+  ClassDef(DelphesIndexReader, 2)
+};
+
+#endif /* DelphesIndexReader_h */
@@ -0,0 +1,177 @@
+
+/** \class DelphesInputBuffer
+ *
+ *  Reads a text input file line by line.
+ *  Regular files are memory-mapped from the current file position,
+ *  pipes and standard input are read in large blocks.
+ *  Lines are returned as ranges inside the mapping or the block,
+ *  they are not null-terminated and are valid until the next call.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesInputBuffer.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+DelphesInputBuffer::DelphesInputBuffer(size_t blockSize) :
+  fInputFile(0), fBlockSize(blockSize), fMap(0), fMapSize(0),
+  fRemaining(-1), fStart(0), fCurrent(0), fEnd(0), fOffset(0), fEndOfFile(true)
+{
+  if(fBlockSize < 4096) fBlockSize = 4096;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesInputBuffer::~DelphesInputBuffer()
+{
+  Close();
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputBuffer::Close()
+{
+  if(fMap) munmap(fMap, fMapSize);
+  fMap = 0;
+  fMapSize = 0;
+  fStart = fCurrent = fEnd = 0;
+  fOffset = 0;
+  fRemaining = -1;
+  fEndOfFile = true;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputBuffer::SetInputFile(FILE *inputFile, long long length)
+{
+  Close();
+
+  fInputFile = inputFile;
+  if(!fInputFile) return;
+
+  if(Map(length)) return;
+
+  fRemaining = length;
+
+  fOffset = ftello(fInputFile);
+  if(fOffset < 0) fOffset = 0;
+
+  if(fBlock.size() < fBlockSize) fBlock.resize(fBlockSize);
+
+  fStart = fCurrent = fEnd = &fBlock[0];
+  fEndOfFile = false;
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesInputBuffer::Map(long long length)
+{
+  struct stat status;
+  long long position, aligned, size, last;
+  long pageSize;
+  void *map;
+  int descriptor;
+
+  descriptor = fileno(fInputFile);
+  if(descriptor < 0 || fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode)) return false;
+
+  // the mapping starts at the current position of the stream
+  position = ftello(fInputFile);
+  if(position < 0 || position >= status.st_size) return false;
+
+  last = status.st_size;
+  if(length >= 0 && position + length < last) last = position + length;
+
+  pageSize = sysconf(_SC_PAGESIZE);
+  aligned = position - position % pageSize;
+  size = last - aligned;
+  if((long long)(size_t)(size) != size) return false;
+
+  map = mmap(0, size, PROT_READ, MAP_PRIVATE, descriptor, aligned);
+  if(map == MAP_FAILED) return false;
+
+  madvise(map, size, MADV_SEQUENTIAL);
+
+  fMap = static_cast<char *>(map);
+  fMapSize = size;
+
+  fOffset = aligned;
+  fStart = fMap;
+  fCurrent = fMap + (position - aligned);
+  fEnd = fMap + fMapSize;
+
+  fEndOfFile = true;
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesInputBuffer::Fill()
+{
+  size_t start, remainder, size, available;
+
+  start = fCurrent - fStart;
+  remainder = fEnd - fCurrent;
+
+  // a line longer than the block, make room for more data
+  if(remainder == fBlock.size()) fBlock.resize(2*fBlock.size());
+
+  memmove(&fBlock[0], &fBlock[0] + start, remainder);
+
+  available = fBlock.size() - remainder;
+  if(fRemaining >= 0 && (long long)(available) > fRemaining) available = fRemaining;
+
+  size = (available > 0) ? fread(&fBlock[remainder], 1, available, fInputFile) : 0;
+  if(fRemaining >= 0) fRemaining -= size;
+
+  fOffset += start;
+  fStart = fCurrent = &fBlock[0];
+  fEnd = fStart + remainder + size;
+
+  if(size == 0) fEndOfFile = true;
+
+  return size > 0;
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesInputBuffer::ReadLine(const char *&begin, const char *&end)
+{
+  const char *newline;
+
+  while(true)
+  {
+    newline = (fCurrent < fEnd) ? static_cast<const char *>(memchr(fCurrent, '\n', fEnd - fCurrent)) : 0;
+    if(newline)
+    {
+      begin = fCurrent;
+      end = newline;
+      fCurrent = newline + 1;
+      return true;
+    }
+
+    if(fEndOfFile || !Fill()) break;
+  }
+
+  if(fCurrent == fEnd) return false;
+
+  // last line without end-of-line character
+  begin = fCurrent;
+  end = fEnd;
+  fCurrent = fEnd;
+  return true;
+}
+
+//------------------------------------------------------------------------------
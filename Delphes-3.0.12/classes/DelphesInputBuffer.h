@@ -0,0 +1,69 @@
+#ifndef DelphesInputBuffer_h
+#define DelphesInputBuffer_h
+
+/** \class DelphesInputBuffer
+ *
+ *  Reads a text input file line by line.
+ *  Regular files are memory-mapped from the current file position,
+ *  pipes and standard input are read in large blocks.
+ *  Lines are returned as ranges inside the mapping or the block,
+ *  they are not null-terminated and are valid until the next call.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include <vector>
+
+#include <stdio.h>
+
+class DelphesInputBuffer
+{
+public:
+
+  DelphesInputBuffer(size_t blockSize = 4194304);
+  ~DelphesInputBuffer();
+
+  // reads from the current position of inputFile,
+  // at most length bytes when length is not negative
+  void SetInputFile(FILE *inputFile, long long length = -1);
+
+  // returns the next line without its end-of-line character,
+  // returns false at the end of the input
+  bool ReadLine(const char *&begin, const char *&end);
+
+  // offset in the input file of the next line
+  long long GetPosition() const { return fOffset + (fCurrent - fStart); }
+
+  bool IsMapped() const { return fMap != 0; }
+
+private:
+
+  void Close();
+
+  bool Map(long long length);
+
+  // block mode: keeps the incomplete last line and appends the next block
+  bool Fill();
+
+  FILE *fInputFile;
+
+  size_t fBlockSize;
+
+  char *fMap;
+  size_t fMapSize;
+
+  std::vector< char > fBlock;
+
+  // block mode: bytes left to read from the file, negative when unlimited
+  long long fRemaining;
+
+  // fOffset is the file offset of fStart, [fCurrent, fEnd) is not read yet
+  const char *fStart, *fCurrent, *fEnd;
+  long long fOffset;
+
+  bool fEndOfFile;
+};
+
+#endif // DelphesInputBuffer_h
@@ -0,0 +1,370 @@
+
+/** \class DelphesInputFile
+ *
+ *  Opens an input file for the readers.
+ *  Files compressed with gzip, bzip2, xz or zstd are recognized
+ *  by their magic number and decompressed on the fly by a child process
+ *  (pigz, lbzip2 and multi-threaded xz are used when available).
+ *  The returned stream can be passed to the SetInputFile methods
+ *  of the readers as if it was the uncompressed file.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesInputFile.h"
+
+#include <iostream>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+// decompressors in order of preference, the first one found in PATH is used
+static const char *const kGzipCommands[][4] =
+{
+  {"pigz", "-dc", 0, 0}, {"gzip", "-dc", 0, 0}, {0, 0, 0, 0}
+};
+
+static const char *const kBzip2Commands[][4] =
+{
+  {"lbzip2", "-dc", 0, 0}, {"bzip2", "-dc", 0, 0}, {0, 0, 0, 0}
+};
+
+static const char *const kXzCommands[][4] =
+{
+  {"xz", "-dc", "-T0", 0}, {0, 0, 0, 0}
+};
+
+static const char *const kZstdCommands[][4] =
+{
+  {"zstd", "-dcq", 0, 0}, {0, 0, 0, 0}
+};
+
+// bytes read in advance by Prefetch
+static const off_t kPrefetchSize = 67108864;
+
+static double GetTime()
+{
+  struct timeval now;
+  gettimeofday(&now, 0);
+  return now.tv_sec + 1.0E-6*now.tv_usec;
+}
+
+// all descriptors are closed on exec, otherwise the decompressor of the next file,
+// started while this one is open, would keep the read end of this pipe and this
+// decompressor would never get SIGPIPE when the file is closed before its end
+
+static int OpenPipe(int descriptors[2])
+{
+#if defined(__linux__)
+  return pipe2(descriptors, O_CLOEXEC);
+#else
+  if(pipe(descriptors) != 0) return -1;
+  fcntl(descriptors[0], F_SETFD, FD_CLOEXEC);
+  fcntl(descriptors[1], F_SETFD, FD_CLOEXEC);
+  return 0;
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+// the stream returned for compressed files reads the pipe from the decompressor,
+// its position is the number of uncompressed bytes and it can't be moved
+
+#if defined(__GLIBC__)
+
+static ssize_t CookieRead(void *cookie, char *buffer, size_t size)
+{
+  return static_cast<DelphesInputFile *>(cookie)->ReadUncompressed(buffer, size);
+}
+
+static int CookieSeek(void *cookie, off64_t *position, int whence)
+{
+  if(whence != SEEK_CUR || *position != 0)
+  {
+    errno = ESPIPE;
+    return -1;
+  }
+  *position = static_cast<DelphesInputFile *>(cookie)->GetUncompressedPosition();
+  return 0;
+}
+
+static FILE *OpenCookie(DelphesInputFile *cookie)
+{
+  cookie_io_functions_t functions;
+  functions.read = CookieRead;
+  functions.write = 0;
+  functions.seek = CookieSeek;
+  functions.close = 0;
+  return fopencookie(cookie, "r", functions);
+}
+
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+
+static int CookieRead(void *cookie, char *buffer, int size)
+{
+  return static_cast<DelphesInputFile *>(cookie)->ReadUncompressed(buffer, size);
+}
+
+static fpos_t CookieSeek(void *cookie, fpos_t position, int whence)
+{
+  if(whence != SEEK_CUR || position != 0)
+  {
+    errno = ESPIPE;
+    return -1;
+  }
+  return static_cast<DelphesInputFile *>(cookie)->GetUncompressedPosition();
+}
+
+static FILE *OpenCookie(DelphesInputFile *cookie)
+{
+  return funopen(cookie, CookieRead, 0, CookieSeek, 0);
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+DelphesInputFile::DelphesInputFile() :
+  fFile(0), fCompression(kNone), fDescriptor(-1), fPipe(-1), fPid(-1),
+  fSize(-1), fUncompressed(0), fEndOfFile(false), fStartTime(0.0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+DelphesInputFile::~DelphesInputFile()
+{
+  Close();
+}
+
+//------------------------------------------------------------------------------
+
+FILE *DelphesInputFile::Open(const char *fileName)
+{
+  unsigned char magic[6];
+  struct stat status;
+  ssize_t size;
+
+  Close();
+
+  fStartTime = GetTime();
+  fUncompressed = 0;
+  fEndOfFile = false;
+
+  if(strcmp(fileName, "-") == 0)
+  {
+    fFile = stdin;
+    fSize = -1;
+    return fFile;
+  }
+
+  fDescriptor = open(fileName, O_RDONLY | O_CLOEXEC);
+  if(fDescriptor < 0) return 0;
+
+  fSize = (fstat(fDescriptor, &status) == 0 && S_ISREG(status.st_mode)) ? status.st_size : -1;
+
+  size = pread(fDescriptor, magic, sizeof(magic), 0);
+
+  fCompression = kNone;
+  if(size >= 2 && magic[0] == 0x1F && magic[1] == 0x8B)
+  {
+    fCompression = kGzip;
+  }
+  else if(size >= 3 && memcmp(magic, "BZh", 3) == 0)
+  {
+    fCompression = kBzip2;
+  }
+  else if(size >= 6 && memcmp(magic, "\xFD" "7zXZ\0", 6) == 0)
+  {
+    fCompression = kXz;
+  }
+  else if(size >= 4 && memcmp(magic, "\x28\xB5\x2F\xFD", 4) == 0)
+  {
+    fCompression = kZstd;
+  }
+
+  if(fCompression == kNone)
+  {
+    fFile = fdopen(fDescriptor, "r");
+    if(!fFile) Close();
+    else fDescriptor = -1;
+    return fFile;
+  }
+
+  if(!StartDecompressor())
+  {
+    Close();
+    return 0;
+  }
+
+  return fFile;
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesInputFile::StartDecompressor()
+{
+  const char *const (*commands)[4] = 0;
+  int descriptors[2], i;
+
+#if defined(__GLIBC__) || defined(__APPLE__) || defined(__FreeBSD__)
+  switch(fCompression)
+  {
+    case kGzip: commands = kGzipCommands; break;
+    case kBzip2: commands = kBzip2Commands; break;
+    case kXz: commands = kXzCommands; break;
+    case kZstd: commands = kZstdCommands; break;
+    default: return false;
+  }
+
+  if(OpenPipe(descriptors) != 0) return false;
+
+  fPid = fork();
+  if(fPid < 0)
+  {
+    close(descriptors[0]);
+    close(descriptors[1]);
+    return false;
+  }
+
+  if(fPid == 0)
+  {
+    // the decompressor shares the file offset of fDescriptor,
+    // so that GetPosition can follow its progress,
+    // the copies made by dup2 are kept on exec
+    dup2(fDescriptor, STDIN_FILENO);
+    dup2(descriptors[1], STDOUT_FILENO);
+    close(descriptors[0]);
+    close(descriptors[1]);
+    close(fDescriptor);
+
+    // Close relies on SIGPIPE, which may be ignored by the parent
+    signal(SIGPIPE, SIG_DFL);
+
+    for(i = 0; commands[i][0]; ++i)
+    {
+      execvp(commands[i][0], const_cast<char *const *>(commands[i]));
+    }
+    _exit(127);
+  }
+
+  close(descriptors[1]);
+  fPipe = descriptors[0];
+
+  fFile = OpenCookie(this);
+
+  return fFile != 0;
+#else
+  return false;
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesInputFile::Close()
+{
+  int status;
+  bool rc = true;
+
+  if(fFile && fFile != stdin) fclose(fFile);
+  fFile = 0;
+
+  if(fPipe >= 0) close(fPipe);
+  fPipe = -1;
+
+  if(fPid > 0)
+  {
+    // when the input is not read to the end, the decompressor gets SIGPIPE
+    while(waitpid(fPid, &status, 0) < 0 && errno == EINTR);
+    if(fEndOfFile && (!WIFEXITED(status) || WEXITSTATUS(status) != 0)) rc = false;
+  }
+  fPid = -1;
+
+  if(fDescriptor >= 0) close(fDescriptor);
+  fDescriptor = -1;
+
+  fCompression = kNone;
+
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputFile::Prefetch()
+{
+#if defined(POSIX_FADV_WILLNEED)
+  // compressed files are already being read by the decompressor
+  if(fFile && fFile != stdin && fCompression == kNone)
+  {
+    posix_fadvise(fileno(fFile), 0, kPrefetchSize, POSIX_FADV_WILLNEED);
+  }
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+ssize_t DelphesInputFile::ReadUncompressed(char *buffer, size_t size)
+{
+  ssize_t rc;
+
+  do
+  {
+    rc = read(fPipe, buffer, size);
+  }
+  while(rc < 0 && errno == EINTR);
+
+  if(rc > 0) fUncompressed += rc;
+  if(rc == 0) fEndOfFile = true;
+
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+
+long long DelphesInputFile::GetPosition() const
+{
+  if(fCompression == kNone) return fFile ? ftello(fFile) : -1;
+  return lseek(fDescriptor, 0, SEEK_CUR);
+}
+
+//------------------------------------------------------------------------------
+
+long long DelphesInputFile::GetUncompressedPosition() const
+{
+  if(fCompression == kNone) return GetPosition();
+  return fUncompressed;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputFile::PrintStatistics() const
+{
+  static const char *const names[] = {"none", "gzip", "bzip2", "xz", "zstd"};
+  double time = GetTime() - fStartTime;
+  long long compressed = GetPosition();
+
+  if(fCompression == kNone) return;
+
+  cout << "** " << names[fCompression] << " input: ";
+  cout << compressed/1.0E6 << " MB compressed, " << fUncompressed/1.0E6 << " MB uncompressed";
+  if(time > 0.0)
+  {
+    cout << " in " << time << " s (" << compressed/1.0E6/time << " MB/s compressed, ";
+    cout << fUncompressed/1.0E6/time << " MB/s uncompressed)";
+  }
+  cout << endl;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,77 @@
+#ifndef DelphesInputFile_h
+#define DelphesInputFile_h
+
+/** \class DelphesInputFile
+ *
+ *  Opens an input file for the readers.
+ *  Files compressed with gzip, bzip2, xz or zstd are recognized
+ *  by their magic number and decompressed on the fly by a child process
+ *  (pigz, lbzip2 and multi-threaded xz are used when available).
+ *  The returned stream can be passed to the SetInputFile methods
+ *  of the readers as if it was the uncompressed file.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include <stdio.h>
+#include <sys/types.h>
+
+class DelphesInputFile
+{
+public:
+
+  enum Compression { kNone, kGzip, kBzip2, kXz, kZstd };
+
+  DelphesInputFile();
+  ~DelphesInputFile();
+
+  // returns 0 when the file can't be opened, - is the standard input
+  FILE *Open(const char *fileName);
+
+  // asks the system to start reading the beginning of the file
+  void Prefetch();
+
+  // returns false when the decompression failed
+  bool Close();
+
+  // stream returned by Open
+  FILE *GetStream() const { return fFile; }
+
+  Compression GetCompression() const { return fCompression; }
+  bool IsCompressed() const { return fCompression != kNone; }
+
+  // size of the file on disk
+  long long GetSize() const { return fSize; }
+
+  // bytes read from the file on disk
+  long long GetPosition() const;
+
+  // bytes delivered to the reader after decompression
+  long long GetUncompressedPosition() const;
+
+  // prints the compressed and uncompressed throughput since Open
+  void PrintStatistics() const;
+
+  // reads the output of the decompressor, called by the stream returned by Open
+  ssize_t ReadUncompressed(char *buffer, size_t size);
+
+private:
+
+  bool StartDecompressor();
+
+  FILE *fFile;
+
+  Compression fCompression;
+
+  int fDescriptor, fPipe;
+  pid_t fPid;
+
+  long long fSize, fUncompressed;
+  bool fEndOfFile;
+
+  double fStartTime;
+};
+
+#endif // DelphesInputFile_h
@@ -0,0 +1,386 @@
+
+/** \class DelphesInputManager
+ *
+ *  Hands out the input files of a reader.
+ *  The file that comes next in the list is opened in advance.
+ *  Several files can be read at the same time, their events are then
+ *  interleaved in round-robin order. The number of events, the bytes
+ *  read and the throughput of every file are kept for the output file.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesInputManager.h"
+
+#include "classes/DelphesInputFile.h"
+
+#include "TTree.h"
+#include "TDirectory.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include <glob.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+static double GetTime()
+{
+  struct timeval now;
+  gettimeofday(&now, 0);
+  return now.tv_sec + 1.0E-6*now.tv_usec;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesInputManager::DelphesInputManager(int numberOfStreams) :
+  fStream(-1), fNextFile(0), fPrefetched(0), fClosedSize(0)
+{
+  Stream stream;
+
+  if(numberOfStreams < 1) numberOfStreams = 1;
+
+  stream.file = 0;
+  stream.index = -1;
+  stream.newFile = false;
+  stream.position = 0;
+  stream.events = 0;
+  stream.startTime = 0.0;
+
+  fStreams.assign(numberOfStreams, stream);
+}
+
+//------------------------------------------------------------------------------
+
+DelphesInputManager::~DelphesInputManager()
+{
+  vector< Stream >::iterator itStreams;
+
+  for(itStreams = fStreams.begin(); itStreams != fStreams.end(); ++itStreams)
+  {
+    if(itStreams->file) delete itStreams->file;
+  }
+
+  if(fPrefetched) delete fPrefetched;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputManager::AddFile(const char *name)
+{
+  struct stat status;
+  glob_t files;
+  size_t i;
+
+  if(name[0] == '@')
+  {
+    AddList(name + 1);
+    return;
+  }
+
+  if(strpbrk(name, "*?["))
+  {
+    if(glob(name, 0, 0, &files) == 0)
+    {
+      for(i = 0; i < files.gl_pathc; ++i)
+      {
+        AddFile(files.gl_pathv[i]);
+      }
+      globfree(&files);
+      return;
+    }
+    globfree(&files);
+  }
+
+  fFiles.push_back(name);
+
+  if(strcmp(name, "-") != 0 && stat(name, &status) == 0 && S_ISREG(status.st_mode))
+  {
+    fSizes.push_back(status.st_size);
+  }
+  else
+  {
+    fSizes.push_back(-1);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputManager::AddList(const char *listName)
+{
+  stringstream message;
+  string line;
+  size_t first, last;
+
+  ifstream list(listName);
+  if(!list)
+  {
+    message << "can't open file list " << listName;
+    throw runtime_error(message.str());
+  }
+
+  while(getline(list, line))
+  {
+    first = line.find_first_not_of(" \t\r");
+    if(first == string::npos || line[first] == '#') continue;
+    last = line.find_last_not_of(" \t\r");
+    AddFile(line.substr(first, last - first + 1).c_str());
+  }
+}
+
+//------------------------------------------------------------------------------
+
+DelphesInputFile *DelphesInputManager::OpenFile(int index)
+{
+  DelphesInputFile *file = new DelphesInputFile;
+
+  if(!file->Open(fFiles[index].c_str()))
+  {
+    delete file;
+    return 0;
+  }
+
+  file->Prefetch();
+
+  return file;
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesInputManager::StartFile(Stream &stream)
+{
+  stringstream message;
+  DelphesInputFile *file;
+  int index;
+
+  while(fNextFile < GetNumberOfFiles())
+  {
+    index = fNextFile++;
+
+    file = fPrefetched ? fPrefetched : OpenFile(index);
+    fPrefetched = 0;
+
+    if(!file)
+    {
+      message << "can't open " << fFiles[index];
+      throw runtime_error(message.str());
+    }
+
+    // the following file is opened while this one is read
+    if(fNextFile < GetNumberOfFiles() && fFiles[fNextFile] != "-")
+    {
+      fPrefetched = OpenFile(fNextFile);
+    }
+
+    if(file->GetSize() == 0)
+    {
+      delete file;
+      continue;
+    }
+
+    if(fFiles[index] == "-")
+    {
+      cout << "** Reading standard input" << endl;
+    }
+    else
+    {
+      cout << "** Reading " << fFiles[index] << endl;
+    }
+
+    stream.file = file;
+    stream.index = index;
+    stream.newFile = true;
+    stream.position = 0;
+    stream.events = 0;
+    stream.startTime = GetTime();
+
+    return true;
+  }
+
+  return false;
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesInputManager::NextStream()
+{
+  int i, size = GetNumberOfStreams();
+
+  if(fStream >= 0) fStreams[fStream].newFile = false;
+
+  for(i = 0; i < size; ++i)
+  {
+    fStream = (fStream + 1) % size;
+    if(fStreams[fStream].file || StartFile(fStreams[fStream])) return true;
+  }
+
+  return false;
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesInputManager::IsNewFile() const
+{
+  return fStreams[fStream].newFile;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesInputFile *DelphesInputManager::GetFile() const
+{
+  return fStreams[fStream].file;
+}
+
+//------------------------------------------------------------------------------
+
+FILE *DelphesInputManager::GetInputFile() const
+{
+  const Stream &stream = fStreams[fStream];
+  return stream.file ? stream.file->GetStream() : 0;
+}
+
+//------------------------------------------------------------------------------
+
+const char *DelphesInputManager::GetFileName() const
+{
+  return fFiles[fStreams[fStream].index].c_str();
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputManager::SetPosition(long long position)
+{
+  fStreams[fStream].position = position;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputManager::CountEvent()
+{
+  ++fStreams[fStream].events;
+}
+
+//------------------------------------------------------------------------------
+
+long long DelphesInputManager::GetPosition(const Stream &stream) const
+{
+  long long position = stream.file->GetPosition();
+  return (position > stream.position) ? position : stream.position;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputManager::CloseFile()
+{
+  stringstream message;
+  Stream &stream = fStreams[fStream];
+  Statistics statistics;
+  bool rc;
+
+  if(!stream.file) return;
+
+  statistics.name = fFiles[stream.index];
+  statistics.events = stream.events;
+  statistics.bytes = GetPosition(stream);
+  statistics.uncompressedBytes = stream.file->GetUncompressedPosition();
+  statistics.time = GetTime() - stream.startTime;
+  if(statistics.uncompressedBytes < statistics.bytes) statistics.uncompressedBytes = statistics.bytes;
+
+  fStatistics.push_back(statistics);
+
+  stream.file->PrintStatistics();
+
+  rc = stream.file->Close();
+
+  delete stream.file;
+  stream.file = 0;
+  stream.newFile = false;
+
+  if(fSizes[stream.index] > 0) fClosedSize += fSizes[stream.index];
+
+  if(!rc)
+  {
+    message << "can't decompress " << statistics.name;
+    throw runtime_error(message.str());
+  }
+}
+
+//------------------------------------------------------------------------------
+
+long long DelphesInputManager::GetTotalSize() const
+{
+  vector< long long >::const_iterator itSizes;
+  long long size = 0;
+
+  for(itSizes = fSizes.begin(); itSizes != fSizes.end(); ++itSizes)
+  {
+    if(*itSizes < 0) return -1;
+    size += *itSizes;
+  }
+
+  return size;
+}
+
+//------------------------------------------------------------------------------
+
+long long DelphesInputManager::GetTotalPosition() const
+{
+  vector< Stream >::const_iterator itStreams;
+  long long position = fClosedSize;
+
+  for(itStreams = fStreams.begin(); itStreams != fStreams.end(); ++itStreams)
+  {
+    if(itStreams->file) position += GetPosition(*itStreams);
+  }
+
+  return position;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputManager::WriteStatistics(TDirectory *directory) const
+{
+  vector< Statistics >::const_iterator itStatistics;
+  TDirectory *currentDirectory = gDirectory;
+  TTree *tree;
+  char name[4096];
+  Long64_t events, bytes, uncompressedBytes;
+  Double_t time, throughput;
+
+  directory->cd();
+
+  // the tree belongs to the directory and is written with it
+  tree = new TTree("InputFiles", "Statistics of the input files");
+  tree->Branch("Name", name, "Name/C");
+  tree->Branch("Events", &events, "Events/L");
+  tree->Branch("Bytes", &bytes, "Bytes/L");
+  tree->Branch("UncompressedBytes", &uncompressedBytes, "UncompressedBytes/L");
+  tree->Branch("Time", &time, "Time/D");
+  tree->Branch("Throughput", &throughput, "Throughput/D");
+
+  for(itStatistics = fStatistics.begin(); itStatistics != fStatistics.end(); ++itStatistics)
+  {
+    strncpy(name, itStatistics->name.c_str(), sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    events = itStatistics->events;
+    bytes = itStatistics->bytes;
+    uncompressedBytes = itStatistics->uncompressedBytes;
+    time = itStatistics->time;
+    // MB/s of data on disk, time is the wall time while the file was open
+    throughput = (time > 0.0) ? bytes/1.0E6/time : 0.0;
+    tree->Fill();
+  }
+
+  currentDirectory->cd();
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,111 @@
+#ifndef DelphesInputManager_h
+#define DelphesInputManager_h
+
+/** \class DelphesInputManager
+ *
+ *  Hands out the input files of a reader.
+ *  The file that comes next in the list is opened in advance.
+ *  Several files can be read at the same time, their events are then
+ *  interleaved in round-robin order. The number of events, the bytes
+ *  read and the throughput of every file are kept for the output file.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+
+class TDirectory;
+class DelphesInputFile;
+
+class DelphesInputManager
+{
+public:
+
+  DelphesInputManager(int numberOfStreams = 1);
+  ~DelphesInputManager();
+
+  // names with wildcards are expanded, a name starting with @ is a text file
+  // with one input file per line, - is the standard input
+  void AddFile(const char *name);
+
+  int GetNumberOfFiles() const { return fFiles.size(); }
+  int GetNumberOfStreams() const { return fStreams.size(); }
+
+  // moves to the next stream in round-robin order, a stream without file
+  // is given the next file of the list, returns false when all files are read
+  bool NextStream();
+
+  int GetStream() const { return fStream; }
+
+  // true when the file of the current stream has just been opened
+  bool IsNewFile() const;
+
+  DelphesInputFile *GetFile() const;
+  FILE *GetInputFile() const;
+  const char *GetFileName() const;
+
+  // position reached in the current file by a reader that does not
+  // read through the stream, for example from a memory-mapped file
+  void SetPosition(long long position);
+
+  // counts an event processed from the current file
+  void CountEvent();
+
+  // closes the file of the current stream and records its statistics
+  void CloseFile();
+
+  // for the progress bar, the total size is -1 when a size is unknown
+  long long GetTotalSize() const;
+  long long GetTotalPosition() const;
+
+  // creates the InputFiles tree in directory, it is written together with
+  // the other objects of the directory
+  void WriteStatistics(TDirectory *directory) const;
+
+private:
+
+  struct Stream
+  {
+    DelphesInputFile *file;
+    int index;
+    bool newFile;
+    long long position, events;
+    double startTime;
+  };
+
+  struct Statistics
+  {
+    std::string name;
+    long long events, bytes, uncompressedBytes;
+    double time;
+  };
+
+  void AddList(const char *listName);
+
+  DelphesInputFile *OpenFile(int index);
+  bool StartFile(Stream &stream);
+
+  long long GetPosition(const Stream &stream) const;
+
+  std::vector< std::string > fFiles;
+  std::vector< long long > fSizes;
+
+  std::vector< Stream > fStreams;
+  int fStream;
+
+  // index of the next file to start and the file opened in advance for it
+  int fNextFile;
+  DelphesInputFile *fPrefetched;
+
+  // size of the files that have been closed
+  long long fClosedSize;
+
+  std::vector< Statistics > fStatistics;
+};
+
+#endif // DelphesInputManager_h
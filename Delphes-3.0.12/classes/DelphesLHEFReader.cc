@@ -14,61 +14,224 @@
 
 #include "classes/DelphesLHEFReader.h"
 
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
 
 #include <stdio.h>
+#include <string.h>
 
+#include "TTree.h"
 #include "TObjArray.h"
+#include "TObjString.h"
+#include "TDirectory.h"
 #include "TStopwatch.h"
-#include "TDatabasePDG.h"
-#include "TParticlePDG.h"
 #include "TLorentzVector.h"
 
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
+#include "classes/DelphesPDGTable.h"
 #include "classes/DelphesStream.h"
+#include "classes/DelphesInputBuffer.h"
 
 #include "ExRootAnalysis/ExRootTreeBranch.h"
 
 using namespace std;
 
-static const int kBufferSize  = 1024;
+//---------------------------------------------------------------------------
+
+// returns the next '<' in [begin, end),
+// memchr is vectorized in the C library and skips the lines without tags at once
+static const char *FindTag(const char *begin, const char *end)
+{
+  if(begin >= end) return 0;
+  return static_cast<const char *>(memchr(begin, '<', end - begin));
+}
+
+//---------------------------------------------------------------------------
+
+// tests whether the tag [tag, close) is <name>, <name/> or <name attributes>
+static bool IsTag(const char *tag, const char *close, const char *name)
+{
+  size_t length = strlen(name);
+  const char *next = tag + 1 + length;
+
+  if(next > close || memcmp(tag + 1, name, length) != 0) return false;
+
+  return next == close || *next == '/' || *next == ' ' || *next == '\t';
+}
+
+//---------------------------------------------------------------------------
+
+// finds the value of the attribute name="value" or name='value' in the tag [tag, close)
+static bool GetAttribute(const char *tag, const char *close, const char *name,
+  const char *&valueBegin, const char *&valueEnd)
+{
+  size_t length = strlen(name);
+  const char *position, *next;
+  char quote;
+
+  for(position = tag + 1; position + length < close; ++position)
+  {
+    if(position[-1] != ' ' && position[-1] != '\t') continue;
+    if(memcmp(position, name, length) != 0) continue;
+
+    next = position + length;
+    while(next < close && (*next == ' ' || *next == '\t')) ++next;
+    if(next == close || *next != '=') continue;
+
+    ++next;
+    while(next < close && (*next == ' ' || *next == '\t')) ++next;
+    if(next == close || (*next != '"' && *next != '\'')) continue;
+
+    quote = *next;
+    valueBegin = next + 1;
+    valueEnd = static_cast<const char *>(memchr(valueBegin, quote, close - valueBegin));
+    if(valueEnd) return true;
+  }
+
+  return false;
+}
+
+//---------------------------------------------------------------------------
+
+int DelphesLHEFWeightTable::AddID(const string &id)
+{
+  map< string, int >::iterator itIndex;
+
+  itIndex = fIndex.find(id);
+  if(itIndex != fIndex.end()) return itIndex->second;
+
+  fIndex[id] = fIDs.size();
+  fIDs.push_back(id);
+
+  return fIDs.size() - 1;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesLHEFWeightTable::AddHeaderIDs(const vector< string > &ids)
+{
+  stringstream message;
+  map< string, int >::iterator itIndex;
+  int i;
+
+  // weights without id are stored by position, which must mean the same in all files
+  for(i = 0; i < int(ids.size()); ++i)
+  {
+    itIndex = fIndex.find(ids[i]);
+    if((i < int(fIDs.size()) && fIDs[i] != ids[i]) || (i >= int(fIDs.size()) && itIndex != fIndex.end()))
+    {
+      message << "weight " << ids[i] << " is at position " << i << " in the LHEF header, ";
+      message << "the previous files have ";
+      if(i < int(fIDs.size())) message << fIDs[i];
+      else message << "it at position " << itIndex->second;
+      message << " there, files with different weights must be processed separately";
+      throw runtime_error(message.str());
+    }
+    if(i >= int(fIDs.size())) AddID(ids[i]);
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesLHEFHeaderList::Add(const string &name, const string &header, const string &init)
+{
+  fNames.push_back(name);
+  fHeaders.push_back(header);
+  fInits.push_back(init);
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesLHEFHeaderList::Write(TDirectory *directory) const
+{
+  TDirectory *currentDirectory = gDirectory;
+  TTree *tree;
+  vector< char > name, header, init;
+  size_t nameSize = 1, headerSize = 1, initSize = 1;
+  int i;
+
+  // the blocks have no size limit, the buffers fit the longest of them
+  for(i = 0; i < GetSize(); ++i)
+  {
+    nameSize = max(nameSize, fNames[i].size() + 1);
+    headerSize = max(headerSize, fHeaders[i].size() + 1);
+    initSize = max(initSize, fInits[i].size() + 1);
+  }
+  name.resize(nameSize);
+  header.resize(headerSize);
+  init.resize(initSize);
+
+  directory->cd();
+
+  // the tree belongs to the directory and is written with it
+  tree = new TTree("LHEFFiles", "Header and init blocks of the input files");
+  tree->Branch("Name", &name[0], "Name/C");
+  tree->Branch("Header", &header[0], "Header/C");
+  tree->Branch("Init", &init[0], "Init/C");
+
+  for(i = 0; i < GetSize(); ++i)
+  {
+    strcpy(&name[0], fNames[i].c_str());
+    strcpy(&header[0], fHeaders[i].c_str());
+    strcpy(&init[0], fInits[i].c_str());
+    tree->Fill();
+  }
+
+  // the buffers are released before the tree is written
+  tree->ResetBranchAddresses();
+
+  currentDirectory->cd();
+}
 
 //---------------------------------------------------------------------------
 
 DelphesLHEFReader::DelphesLHEFReader() :
-  fInputFile(0), fBuffer(0), fPDG(0),
-  fEventReady(kFALSE), fEventCounter(-1), fParticleCounter(-1)
+  fInputBuffer(0), fPDG(0), fBlock(kNone),
+  fEventReady(kFALSE), fWeightList(kFALSE),
+  fEventCounter(-1), fParticleCounter(-1), fWeightCounter(0),
+  fWeightTable(&fOwnWeightTable), fHeaderList(&fOwnHeaderList)
 {
-  fBuffer = new char[kBufferSize];
+  fInputBuffer = new DelphesInputBuffer;
 
-  fPDG = TDatabasePDG::Instance();
+  fPDG = DelphesPDGTable::Instance();
 }
 
 //---------------------------------------------------------------------------
 
 DelphesLHEFReader::~DelphesLHEFReader()
 {
-  if(fBuffer) delete[] fBuffer;
+  if(fInputBuffer) delete fInputBuffer;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesLHEFReader::SetInputFile(FILE *inputFile, long long length)
+{
+  fInputBuffer->SetInputFile(inputFile, length);
+  fBlock = kNone;
 }
 
 //---------------------------------------------------------------------------
 
-void DelphesLHEFReader::SetInputFile(FILE *inputFile)
+long long DelphesLHEFReader::GetPosition() const
 {
-  fInputFile = inputFile;
+  return fInputBuffer->GetPosition();
 }
 
 //---------------------------------------------------------------------------
 
 void DelphesLHEFReader::Clear()
 {
+  if(fBlock == kEvent) fBlock = kNone;
   fEventReady = kFALSE;
+  fWeightList = kFALSE;
   fEventCounter = -1;
   fParticleCounter = -1;
-  fRwgtList.clear();
+  fWeights.clear();
+  fWeightCounter = 0;
 }
 
 //---------------------------------------------------------------------------
@@ -85,20 +248,20 @@ bool DelphesLHEFReader::ReadBlock(DelphesFactory *factory,
   TObjArray *stableParticleOutputArray,
   TObjArray *partonOutputArray)
 {
+  const char *begin, *end, *tag, *close, *next, *idBegin, *idEnd;
   int rc;
-  char *pch;
   double weight;
 
-  if(!fgets(fBuffer, kBufferSize, fInputFile)) return kFALSE;
+  // lines are read as a whole, whatever their length
+  if(!fInputBuffer->ReadLine(begin, end)) return kFALSE;
 
-  if(strstr(fBuffer, "<event>"))
+  if(fBlock != kEvent)
   {
-    Clear();
-    fEventCounter = 1;
+    ReadMetadata(begin, end);
   }
   else if(fEventCounter > 0)
   {
-    DelphesStream bufferStream(fBuffer);
+    DelphesStream bufferStream(begin, end);
 
     rc = bufferStream.ReadInt(fParticleCounter)
       && bufferStream.ReadInt(fProcessID)
@@ -117,7 +280,7 @@ bool DelphesLHEFReader::ReadBlock(DelphesFactory *factory,
   }
   else if(fParticleCounter > 0)
   {
-    DelphesStream bufferStream(fBuffer);
+    DelphesStream bufferStream(begin, end);
 
     rc = bufferStream.ReadInt(fPID)
       && bufferStream.ReadInt(fStatus)
@@ -142,32 +305,174 @@ bool DelphesLHEFReader::ReadBlock(DelphesFactory *factory,
 
     --fParticleCounter;
   }
-  else if(strstr(fBuffer, "<wgt"))
+  else
   {
-    pch = strstr(fBuffer, ">");
-    if(!pch)
+    // optional blocks after the particles, several tags can share a line
+    while(begin < end)
     {
-      cerr << "** ERROR: " << "invalid weight format" << endl;
-      return kFALSE;
+      tag = FindTag(begin, end);
+
+      // values of <weights> can be on the following lines
+      if(fWeightList) ReadWeights(begin, tag ? tag : end);
+
+      if(!tag) break;
+
+      close = static_cast<const char *>(memchr(tag, '>', end - tag));
+      if(!close) break;
+
+      begin = close + 1;
+
+      if(IsTag(tag, close, "wgt"))
+      {
+        next = FindTag(begin, end);
+        if(!next) next = end;
+
+        DelphesStream bufferStream(begin, next);
+
+        if(!bufferStream.ReadDbl(weight))
+        {
+          cerr << "** ERROR: " << "invalid weight format" << endl;
+          return kFALSE;
+        }
+
+        if(!GetAttribute(tag, close, "id", idBegin, idEnd)) idBegin = idEnd = 0;
+
+        AddWeight(idBegin, idEnd, weight);
+
+        begin = next;
+      }
+      else if(IsTag(tag, close, "weights"))
+      {
+        fWeightList = kTRUE;
+      }
+      else if(IsTag(tag, close, "/weights"))
+      {
+        fWeightList = kFALSE;
+      }
+      else if(IsTag(tag, close, "/event"))
+      {
+        fEventReady = kTRUE;
+        break;
+      }
     }
+  }
 
-    DelphesStream bufferStream(pch + 1);
-    rc = bufferStream.ReadDbl(weight);
+  return kTRUE;
+}
 
-    if(!rc)
+//---------------------------------------------------------------------------
+
+void DelphesLHEFReader::ReadMetadata(const char *begin, const char *end)
+{
+  const char *tag, *close, *text, *idBegin, *idEnd;
+  string id;
+
+  text = begin;
+
+  for(tag = FindTag(begin, end); tag; tag = FindTag(close + 1, end))
+  {
+    close = static_cast<const char *>(memchr(tag, '>', end - tag));
+    if(!close) break;
+
+    if(fBlock == kHeader)
     {
-      cerr << "** ERROR: " << "invalid weight format" << endl;
-      return kFALSE;
+      if(IsTag(tag, close, "/header"))
+      {
+        fHeader.append(text, tag);
+        fBlock = kNone;
+        fWeightTable->AddHeaderIDs(fHeaderWeightIDs);
+      }
+      else if(IsTag(tag, close, "initrwgt"))
+      {
+        fHeaderWeightIDs.clear();
+      }
+      else if(IsTag(tag, close, "weight") && GetAttribute(tag, close, "id", idBegin, idEnd))
+      {
+        id.assign(idBegin, idEnd);
+        if(find(fHeaderWeightIDs.begin(), fHeaderWeightIDs.end(), id) == fHeaderWeightIDs.end())
+        {
+          fHeaderWeightIDs.push_back(id);
+        }
+      }
+    }
+    else if(fBlock == kInit)
+    {
+      if(IsTag(tag, close, "/init"))
+      {
+        fInit.append(text, tag);
+        fBlock = kNone;
+        // the init block follows the header, both are complete here
+        fHeaderList->Add(fFileName, fHeader, fInit);
+      }
+    }
+    else if(IsTag(tag, close, "event"))
+    {
+      Clear();
+      fBlock = kEvent;
+      fEventCounter = 1;
+      return;
     }
+    else if(IsTag(tag, close, "header"))
+    {
+      // every header declares the weight ids of its file
+      fHeader.clear();
+      fHeaderWeightIDs.clear();
+      fBlock = kHeader;
+      text = close + 1;
+    }
+    else if(IsTag(tag, close, "init"))
+    {
+      fInit.clear();
+      fBlock = kInit;
+      text = close + 1;
+    }
+  }
 
-    fRwgtList.push_back(weight);
+  // the header and init blocks are kept line by line
+  if(fBlock == kHeader && text < end)
+  {
+    fHeader.append(text, end);
+    fHeader.append(1, '\n');
   }
-  else if(strstr(fBuffer, "</event>"))
+  else if(fBlock == kInit && text < end)
   {
-    fEventReady = kTRUE;
+    fInit.append(text, end);
+    fInit.append(1, '\n');
   }
+}
 
-  return kTRUE;
+//---------------------------------------------------------------------------
+
+void DelphesLHEFReader::ReadWeights(const char *begin, const char *end)
+{
+  DelphesStream bufferStream(begin, end);
+  double weight;
+
+  while(bufferStream.ReadDbl(weight))
+  {
+    AddWeight(0, 0, weight);
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesLHEFReader::AddWeight(const char *idBegin, const char *idEnd, double weight)
+{
+  const vector< string > &ids = fWeightTable->GetIDs();
+  int index = fWeightCounter++;
+
+  // the weights usually come in the order of the header,
+  // the id is then compared in place without any lookup
+  if(idBegin && (index >= int(ids.size()) ||
+    ids[index].compare(0, string::npos, idBegin, idEnd - idBegin) != 0))
+  {
+    index = fWeightTable->AddID(string(idBegin, idEnd));
+  }
+
+  // weights that are missing in the event stay at zero
+  if(index >= int(fWeights.size())) fWeights.resize(index + 1, 0.0);
+
+  fWeights[index] = weight;
 }
 
 //---------------------------------------------------------------------------
@@ -195,59 +500,91 @@ void DelphesLHEFReader::AnalyzeEvent(ExRootTreeBranch *branch, long long eventNu
 void DelphesLHEFReader::AnalyzeRwgt(ExRootTreeBranch *branch)
 {
   Weight *element;
-  vector<double>::const_iterator itRwgtList;
+  vector< float >::const_iterator itWeights;
 
-  for(itRwgtList = fRwgtList.begin(); itRwgtList != fRwgtList.end(); ++itRwgtList)
+  for(itWeights = fWeights.begin(); itWeights != fWeights.end(); ++itWeights)
   {
     element = static_cast<Weight *>(branch->NewEntry());
 
-    element->Weight = *itRwgtList;
+    element->Weight = *itWeights;
   }
 }
 
 //---------------------------------------------------------------------------
 
+void DelphesLHEFReader::AnalyzeWeights(ExRootTreeBranch *branch)
+{
+  LHEFWeight *element;
+
+  // the entries of the branch are reused, so is the memory of their arrays
+  element = static_cast<LHEFWeight *>(branch->NewEntry());
+
+  element->Weights.assign(fWeights.begin(), fWeights.end());
+  if(int(element->Weights.size()) < fWeightTable->GetSize()) element->Weights.resize(fWeightTable->GetSize(), 0.0);
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesLHEFReader::WriteMetadata(TDirectory *directory) const
+{
+  vector< string >::const_iterator itWeightIDs;
+  TObjArray weightIDs;
+
+  weightIDs.SetOwner();
+  for(itWeightIDs = GetWeightIDs().begin(); itWeightIDs != GetWeightIDs().end(); ++itWeightIDs)
+  {
+    weightIDs.Add(new TObjString(itWeightIDs->c_str()));
+  }
+
+  fHeaderList->Write(directory);
+  directory->WriteTObject(&weightIDs, "LHEFWeightIDs", "SingleKey");
+}
+
+//---------------------------------------------------------------------------
+
 void DelphesLHEFReader::AnalyzeParticle(DelphesFactory *factory,
   TObjArray *allParticleOutputArray,
   TObjArray *stableParticleOutputArray,
   TObjArray *partonOutputArray)
 {
   Candidate *candidate;
-  TParticlePDG *pdgParticle;
+  const DelphesPDGProperties *pdgProperties;
   int pdgCode;
+  bool stable, parton;
+
+  pdgProperties = &fPDG->GetProperties(fPID);
+  pdgCode = TMath::Abs(fPID);
+
+  stable = pdgProperties->known && fStatus == 1 && pdgProperties->stable;
+  parton = pdgProperties->known && !stable && (pdgCode <= 5 || pdgCode == 21 || pdgCode == 15);
+
+  // arrays that no module reads are not filled
+  stableParticleOutputArray = stable ? stableParticleOutputArray : 0;
+  partonOutputArray = parton ? partonOutputArray : 0;
+  if(!allParticleOutputArray && !stableParticleOutputArray && !partonOutputArray) return;
 
   candidate = factory->NewCandidate();
 
   candidate->PID = fPID;
-  pdgCode = TMath::Abs(candidate->PID);
 
   candidate->Status = fStatus;
 
-  pdgParticle = fPDG->GetParticle(fPID);
-  candidate->Charge = pdgParticle ? int(pdgParticle->Charge()/3.0) : -999;
+  candidate->Charge = pdgProperties->charge;
   candidate->Mass = fMass;
 
   candidate->Momentum.SetPxPyPzE(fPx, fPy, fPz, fE);
   candidate->Position.SetXYZT(0.0, 0.0, 0.0, 0.0);
 
-  candidate->M1 = fM1 - 1;
-  candidate->M2 = fM2 - 1;
+  // mothers are indices in the array of all particles
+  candidate->M1 = allParticleOutputArray ? fM1 - 1 : -1;
+  candidate->M2 = allParticleOutputArray ? fM2 - 1 : -1;
 
   candidate->D1 = -1;
   candidate->D2 = -1;
 
-  allParticleOutputArray->Add(candidate);
-
-  if(!pdgParticle) return;
-
-  if(fStatus == 1 && pdgParticle->Stable())
-  {
-    stableParticleOutputArray->Add(candidate);
-  }
-  else if(pdgCode <= 5 || pdgCode == 21 || pdgCode == 15)
-  {
-    partonOutputArray->Add(candidate);
-  }
+  if(allParticleOutputArray) allParticleOutputArray->Add(candidate);
+  if(stableParticleOutputArray) stableParticleOutputArray->Add(candidate);
+  if(partonOutputArray) partonOutputArray->Add(candidate);
 }
 
 //---------------------------------------------------------------------------
@@ -16,13 +16,58 @@
 
 #include <stdio.h>
 
+#include <map>
+#include <string>
 #include <vector>
 
 class TObjArray;
 class TStopwatch;
-class TDatabasePDG;
+class TDirectory;
+class DelphesPDGTable;
 class ExRootTreeBranch;
 class DelphesFactory;
+class DelphesInputBuffer;
+
+// ids of the weights and their positions in the weight arrays,
+// shared by the readers of all input files of a run
+class DelphesLHEFWeightTable
+{
+public:
+
+  const std::vector< std::string > &GetIDs() const { return fIDs; }
+  int GetSize() const { return fIDs.size(); }
+
+  // position of the id, new ids are added at the end
+  int AddID(const std::string &id);
+
+  // ids in the order of the header of a file, throws when an id
+  // is not at the same position as in the headers of the previous files
+  void AddHeaderIDs(const std::vector< std::string > &ids);
+
+private:
+
+  std::vector< std::string > fIDs;
+  std::map< std::string, int > fIndex;
+};
+
+// header and init blocks of the input files of a run, in the order
+// they are read, shared by the readers of all input files like the weight table
+class DelphesLHEFHeaderList
+{
+public:
+
+  int GetSize() const { return fNames.size(); }
+
+  void Add(const std::string &name, const std::string &header, const std::string &init);
+
+  // one entry per input file in the LHEFFiles tree,
+  // with the Name, Header and Init branches
+  void Write(TDirectory *directory) const;
+
+private:
+
+  std::vector< std::string > fNames, fHeaders, fInits;
+};
 
 class DelphesLHEFReader
 {
@@ -31,7 +76,12 @@ public:
   DelphesLHEFReader();
   ~DelphesLHEFReader();
 
-  void SetInputFile(FILE *inputFile);
+  // reads from the current position of inputFile,
+  // at most length bytes when length is not negative
+  void SetInputFile(FILE *inputFile, long long length = -1);
+
+  // offset in the input file of the next line
+  long long GetPosition() const;
 
   void Clear();
   bool EventReady();
@@ -44,22 +94,55 @@ public:
   void AnalyzeEvent(ExRootTreeBranch *branch, long long eventNumber,
     TStopwatch *readStopWatch, TStopwatch *procStopWatch);
 
+  // one Weight object per weight of the event
   void AnalyzeRwgt(ExRootTreeBranch *branch);
 
+  // one LHEFWeight object holding all weights of the event
+  void AnalyzeWeights(ExRootTreeBranch *branch);
+
+  // contents of the <header> and <init> blocks of the last file
+  const std::string &GetHeader() const { return fHeader; }
+  const std::string &GetInit() const { return fInit; }
+
+  // name of the current input file, stored with its header and init blocks
+  void SetFileName(const char *name) { fFileName = name; }
+
+  // by default every reader has its own list of header and init blocks,
+  // the readers of one output file share the same list
+  void SetHeaderList(DelphesLHEFHeaderList *list) { fHeaderList = list; }
+
+  // by default every reader has its own table of weight ids,
+  // the readers of one output file share the same table
+  void SetWeightTable(DelphesLHEFWeightTable *table) { fWeightTable = table; }
+
+  // ids of the weights, from <initrwgt> or from the first events
+  const std::vector< std::string > &GetWeightIDs() const { return fWeightTable->GetIDs(); }
+
+  // writes the header and init blocks of every input file
+  // as the LHEFFiles tree and the weight ids as LHEFWeightIDs
+  void WriteMetadata(TDirectory *directory) const;
+
 private:
 
+  enum Block { kNone, kHeader, kInit, kEvent };
+
   void AnalyzeParticle(DelphesFactory *factory,
     TObjArray *allParticleOutputArray,
     TObjArray *stableParticleOutputArray,
     TObjArray *partonOutputArray);
 
-  FILE *fInputFile;
+  void ReadMetadata(const char *begin, const char *end);
 
-  char *fBuffer;
+  void ReadWeights(const char *begin, const char *end);
+  void AddWeight(const char *idBegin, const char *idEnd, double weight);
 
-  TDatabasePDG *fPDG;
+  DelphesInputBuffer *fInputBuffer;
 
-  bool fEventReady;
+  const DelphesPDGTable *fPDG;
+
+  Block fBlock;
+
+  bool fEventReady, fWeightList;
 
   int fEventCounter;
 
@@ -68,10 +151,21 @@ private:
 
   int fPID, fStatus, fM1, fM2, fC1, fC2;
   double fPx, fPy, fPz, fE, fMass;
-  
-  std::vector<double> fRwgtList;
-};
 
-#endif // DelphesLHEFReader_h
+  // weights of the event, at the position of their id in the weight table
+  std::vector< float > fWeights;
+  int fWeightCounter;
+
+  std::string fFileName, fHeader, fInit;
 
+  DelphesLHEFHeaderList fOwnHeaderList;
+  DelphesLHEFHeaderList *fHeaderList;
 
+  // ids of the weights declared by the header of the current file
+  std::vector< std::string > fHeaderWeightIDs;
+
+  DelphesLHEFWeightTable fOwnWeightTable;
+  DelphesLHEFWeightTable *fWeightTable;
+};
+
+#endif // DelphesLHEFReader_h
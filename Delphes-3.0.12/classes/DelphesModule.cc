@@ -14,6 +14,7 @@
 #include "classes/DelphesModule.h"
 
 #include "classes/DelphesFactory.h"
+#include "classes/DelphesRandom.h"
 
 #include "ExRootAnalysis/ExRootTreeReader.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
@@ -24,6 +25,7 @@
 #include "TClass.h"
 #include "TFolder.h"
 #include "TObjArray.h"
+#include "TRandom.h"
 
 #include <iostream>
 #include <stdexcept>
@@ -32,8 +34,8 @@
 using namespace std;
 
 DelphesModule::DelphesModule() :
-  fTreeWriter(0), fFactory(0), fPlots(0),
-  fPlotFolder(0), fExportFolder(0)
+  fTreeWriter(0), fFactory(0), fRandom(0), fSharedBranches(kFALSE),
+  fPlots(0), fPlotFolder(0), fExportFolder(0)
 {
 }
 
@@ -41,6 +43,7 @@ DelphesModule::DelphesModule() :
 
 DelphesModule::~DelphesModule()
 {
+  if(fRandom) delete fRandom;
 }
 
 //------------------------------------------------------------------------------
@@ -67,15 +70,33 @@ TObjArray *DelphesModule::ImportArray(const char *name)
 {
   stringstream message;
   TObjArray *object;
+  Int_t index;
 
-  object = static_cast<TObjArray *>(GetObject(Form("Export/%s", name), TObjArray::Class()));
-  if(!object)
+  // arrays are resolved through the factory registry,
+  // the export folder is only kept for browsing
+  index = GetFactory()->FindArray(name);
+  if(index < 0)
   {
     message << "can't access input list '" << name;
     message << "' in module '" << GetName() << "'";
     throw runtime_error(message.str());
   }
 
+  object = fFactory->GetArray(index);
+
+  fImportedArrays.insert(object);
+
+  return object;
+}
+
+//------------------------------------------------------------------------------
+
+TObjArray *DelphesModule::UpdateArray(const char *name)
+{
+  TObjArray *object = ImportArray(name);
+
+  fUpdatedArrays.insert(object);
+
   return object;
 }
 
@@ -94,6 +115,10 @@ TObjArray *DelphesModule::ExportArray(const char *name)
   array->SetName(name);
   fExportFolder->Add(array);
 
+  fFactory->RegisterArray(Form("%s/%s", GetName(), name), array);
+
+  fExportedArrays.insert(array);
+
   return array;
 }
 
@@ -102,6 +127,7 @@ TObjArray *DelphesModule::ExportArray(const char *name)
 ExRootTreeBranch *DelphesModule::NewBranch(const char *name, TClass *cl)
 {
   stringstream message;
+  ExRootTreeBranch *branch;
   if(!fTreeWriter)
   {
     fTreeWriter = static_cast<ExRootTreeWriter *>(GetObject("TreeWriter", ExRootTreeWriter::Class()));
@@ -111,6 +137,18 @@ ExRootTreeBranch *DelphesModule::NewBranch(const char *name, TClass *cl)
       throw runtime_error(message.str());
     }
   }
+
+  if(fSharedBranches)
+  {
+    branch = fTreeWriter->GetBranch(name);
+    if(!branch || branch->GetClass() != cl)
+    {
+      message << "branch '" << name << "' is not created by the first module chain";
+      throw runtime_error(message.str());
+    }
+    return branch;
+  }
+
   return fTreeWriter->NewBranch(name, cl);
 }
 
@@ -143,4 +181,19 @@ DelphesFactory *DelphesModule::GetFactory()
   return fFactory;
 }
 
+//------------------------------------------------------------------------------
 
+TRandom *DelphesModule::GetRandom()
+{
+  if(fRandom) return fRandom;
+  return gRandom;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesModule::SetRandomEvent(UInt_t seed, Long64_t eventNumber)
+{
+  if(!fRandom) fRandom = new DelphesRandom(GetName(), seed);
+  if(fRandom->GetSeed() != seed) fRandom->SetSeed(seed);
+  fRandom->SetEvent(eventNumber);
+}
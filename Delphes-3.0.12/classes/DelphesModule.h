@@ -15,10 +15,15 @@
 
 #include "ExRootAnalysis/ExRootTask.h"
 
+#include <set>
+
 class TClass;
 class TObject;
 class TFolder;
 class TClonesArray;
+class TRandom;
+
+class DelphesRandom;
 
 class ExRootResult;
 class ExRootTreeBranch;
@@ -40,15 +45,39 @@ public:
   TObjArray *ImportArray(const char *name);
   TObjArray *ExportArray(const char *name);
 
+  // imports an array whose candidates are modified in place by this module
+  TObjArray *UpdateArray(const char *name);
+
+  // arrays declared in Init, used to order modules running concurrently
+  const std::set< TObjArray * > &GetImportedArrays() const { return fImportedArrays; }
+  const std::set< TObjArray * > &GetUpdatedArrays() const { return fUpdatedArrays; }
+  const std::set< TObjArray * > &GetExportedArrays() const { return fExportedArrays; }
+
   ExRootTreeBranch *NewBranch(const char *name, TClass *cl);
 
+  // with shared branches, NewBranch returns the branch with the same name
+  // created by the first module chain of a worker pool instead of a new one
+  void SetSharedBranches(Bool_t shared) { fSharedBranches = shared; }
+
   ExRootResult *GetPlots();
   DelphesFactory *GetFactory();
+  // random sequence of this module for the current event,
+  // gRandom when per-event random streams are not enabled
+  TRandom *GetRandom();
+
+  // starts the random sequence keyed by seed, event number and module name
+  void SetRandomEvent(UInt_t seed, Long64_t eventNumber);
+
+  // tree writer used by this module, non-zero once it has created branches
+  ExRootTreeWriter *GetTreeWriter() const { return fTreeWriter; }
 
 protected:
 
   ExRootTreeWriter *fTreeWriter;
   DelphesFactory *fFactory;
+  DelphesRandom *fRandom; //!
+
+  Bool_t fSharedBranches; //!
 
 private:
 
@@ -56,6 +85,10 @@ private:
 
   TFolder *fPlotFolder, *fExportFolder;
 
+  std::set< TObjArray * > fImportedArrays; //!
+  std::set< TObjArray * > fUpdatedArrays; //!
+  std::set< TObjArray * > fExportedArrays; //!
+
   ClassDef(DelphesModule, 1)
 };
 
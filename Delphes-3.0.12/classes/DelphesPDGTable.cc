@@ -0,0 +1,94 @@
+
+/** \class DelphesPDGTable
+ *
+ *  Charge, mass and stability of the particles of TDatabasePDG,
+ *  copied once into a dense array indexed by the PDG code.
+ *  Codes outside of the array are looked up in a map.
+ *  The table is built by the first call of Instance and shared
+ *  by all readers and modules, in all threads.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesPDGTable.h"
+
+#include <pthread.h>
+
+#include "TDatabasePDG.h"
+#include "TParticlePDG.h"
+#include "THashList.h"
+
+using namespace std;
+
+static DelphesPDGTable *gPDGTable = 0;
+static pthread_once_t gPDGTableOnce = PTHREAD_ONCE_INIT;
+
+//------------------------------------------------------------------------------
+
+void DelphesPDGTable::Create()
+{
+  gPDGTable = new DelphesPDGTable;
+}
+
+//------------------------------------------------------------------------------
+
+const DelphesPDGTable *DelphesPDGTable::Instance()
+{
+  // the table is never modified after it is built
+  pthread_once(&gPDGTableOnce, Create);
+  return gPDGTable;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesPDGTable::DelphesPDGTable()
+{
+  TDatabasePDG *pdg = TDatabasePDG::Instance();
+  TParticlePDG *pdgParticle;
+  DelphesPDGProperties properties;
+  int i, pid;
+
+  fUnknown.mass = -999.9;
+  fUnknown.charge = -999;
+  fUnknown.known = false;
+  fUnknown.stable = false;
+
+  for(i = 0; i < 2*kDenseCode; ++i) fDense[i] = fUnknown;
+
+  // the particle list is only read on the first lookup
+  pdg->GetParticle(11);
+
+  TIter itParticles(pdg->ParticleList());
+  while((pdgParticle = static_cast<TParticlePDG *>(itParticles.Next())))
+  {
+    pid = pdgParticle->PdgCode();
+
+    properties.mass = pdgParticle->Mass();
+    properties.charge = int(pdgParticle->Charge()/3.0);
+    properties.known = true;
+    properties.stable = pdgParticle->Stable();
+
+    if(pid > -kDenseCode && pid < kDenseCode)
+    {
+      fDense[pid + kDenseCode] = properties;
+    }
+    else
+    {
+      fSparse[pid] = properties;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+const DelphesPDGProperties &DelphesPDGTable::GetSparseProperties(int pid) const
+{
+  map< int, DelphesPDGProperties >::const_iterator itSparse;
+
+  itSparse = fSparse.find(pid);
+  return itSparse != fSparse.end() ? itSparse->second : fUnknown;
+}
+
+//------------------------------------------------------------------------------
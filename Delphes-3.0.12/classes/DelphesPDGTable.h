@@ -0,0 +1,59 @@
+#ifndef DelphesPDGTable_h
+#define DelphesPDGTable_h
+
+/** \class DelphesPDGTable
+ *
+ *  Charge, mass and stability of the particles of TDatabasePDG,
+ *  copied once into a dense array indexed by the PDG code.
+ *  Codes outside of the array are looked up in a map.
+ *  The table is built by the first call of Instance and shared
+ *  by all readers and modules, in all threads.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include <map>
+
+struct DelphesPDGProperties
+{
+  double mass;
+  int charge;
+
+  // unknown particles have charge -999 and mass -999.9
+  bool known;
+  bool stable;
+};
+
+class DelphesPDGTable
+{
+public:
+
+  static const DelphesPDGTable *Instance();
+
+  const DelphesPDGProperties &GetProperties(int pid) const
+  {
+    unsigned int index = (unsigned int)(pid) + kDenseCode;
+    return index < 2*kDenseCode ? fDense[index] : GetSparseProperties(pid);
+  }
+
+private:
+
+  // covers quarks, leptons, bosons, light and heavy hadrons
+  static const int kDenseCode = 10000;
+
+  DelphesPDGTable();
+
+  static void Create();
+
+  const DelphesPDGProperties &GetSparseProperties(int pid) const;
+
+  DelphesPDGProperties fDense[2*kDenseCode];
+
+  std::map< int, DelphesPDGProperties > fSparse;
+
+  DelphesPDGProperties fUnknown;
+};
+
+#endif // DelphesPDGTable_h
@@ -0,0 +1,126 @@
+
+/** \class DelphesParticleStore
+ *
+ *  Columnar copy of the kinematics of an array of candidates.
+ *  Momentum, position, PID and charge of every candidate are stored
+ *  in contiguous arrays, so that the per-particle loops can run
+ *  over plain numbers, the candidates themselves are only accessed
+ *  when an output object has to be created.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesParticleStore.h"
+#include "classes/DelphesClasses.h"
+
+#include "TMath.h"
+#include "TObjArray.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+DelphesParticleStore::DelphesParticleStore() :
+  fSize(0)
+{
+  // columns are never empty, so that their first element can always be addressed
+  Resize(1);
+}
+
+//------------------------------------------------------------------------------
+
+DelphesParticleStore::~DelphesParticleStore()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesParticleStore::Resize(Int_t size)
+{
+  if(size <= Int_t(fCandidates.size())) return;
+
+  fPx.resize(size);
+  fPy.resize(size);
+  fPz.resize(size);
+  fE.resize(size);
+
+  fX.resize(size);
+  fY.resize(size);
+  fZ.resize(size);
+  fT.resize(size);
+
+  fPID.resize(size);
+  fCharge.resize(size);
+
+  fCandidates.resize(size);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesParticleStore::Clear()
+{
+  fSize = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesParticleStore::Fill(const TObjArray *array)
+{
+  Candidate *candidate;
+  Int_t i, n;
+
+  n = array->GetEntriesFast();
+  Resize(n);
+
+  fSize = 0;
+  for(i = 0; i < n; ++i)
+  {
+    candidate = static_cast<Candidate*>(array->UncheckedAt(i));
+    if(!candidate) continue;
+
+    const TLorentzVector &momentum = candidate->Momentum;
+    const TLorentzVector &position = candidate->Position;
+
+    fPx[fSize] = momentum.Px();
+    fPy[fSize] = momentum.Py();
+    fPz[fSize] = momentum.Pz();
+    fE[fSize] = momentum.E();
+
+    fX[fSize] = position.X();
+    fY[fSize] = position.Y();
+    fZ[fSize] = position.Z();
+    fT[fSize] = position.T();
+
+    fPID[fSize] = candidate->PID;
+    fCharge[fSize] = candidate->Charge;
+
+    fCandidates[fSize] = candidate;
+
+    ++fSize;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Double_t DelphesParticleStore::PositionEta(Int_t i) const
+{
+  Double_t x = fX[i], y = fY[i], z = fZ[i];
+  Double_t r = TMath::Sqrt(x*x + y*y + z*z);
+  Double_t cosTheta = (r == 0.0) ? 1.0 : z/r;
+
+  if(cosTheta*cosTheta < 1.0) return -0.5*TMath::Log((1.0 - cosTheta)/(1.0 + cosTheta));
+  if(z == 0.0) return 0.0;
+  return (z > 0.0) ? 10.0E10 : -10.0E10;
+}
+
+//------------------------------------------------------------------------------
+
+Double_t DelphesParticleStore::PositionPhi(Int_t i) const
+{
+  Double_t x = fX[i], y = fY[i];
+  return (x == 0.0 && y == 0.0) ? 0.0 : TMath::ATan2(y, x);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,70 @@
+#ifndef DelphesParticleStore_h
+#define DelphesParticleStore_h
+
+/** \class DelphesParticleStore
+ *
+ *  Columnar copy of the kinematics of an array of candidates.
+ *  Momentum, position, PID and charge of every candidate are stored
+ *  in contiguous arrays, so that the per-particle loops can run
+ *  over plain numbers, the candidates themselves are only accessed
+ *  when an output object has to be created.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class TObjArray;
+class Candidate;
+
+class DelphesParticleStore
+{
+public:
+
+  DelphesParticleStore();
+  ~DelphesParticleStore();
+
+  // copies kinematics of all candidates in the array, memory is reused between events
+  void Fill(const TObjArray *array);
+
+  void Clear();
+
+  Int_t GetSize() const { return fSize; }
+
+  const Double_t *Px() const { return &fPx[0]; }
+  const Double_t *Py() const { return &fPy[0]; }
+  const Double_t *Pz() const { return &fPz[0]; }
+  const Double_t *E() const { return &fE[0]; }
+
+  const Double_t *X() const { return &fX[0]; }
+  const Double_t *Y() const { return &fY[0]; }
+  const Double_t *Z() const { return &fZ[0]; }
+  const Double_t *T() const { return &fT[0]; }
+
+  const Int_t *PID() const { return &fPID[0]; }
+  const Int_t *Charge() const { return &fCharge[0]; }
+
+  Candidate *GetCandidate(Int_t i) const { return fCandidates[i]; }
+
+  // pseudorapidity and azimuthal angle of the position, same as TLorentzVector::Eta() and Phi()
+  Double_t PositionEta(Int_t i) const;
+  Double_t PositionPhi(Int_t i) const;
+
+private:
+
+  void Resize(Int_t size);
+
+  Int_t fSize;
+
+  std::vector< Double_t > fPx, fPy, fPz, fE;
+  std::vector< Double_t > fX, fY, fZ, fT;
+  std::vector< Int_t > fPID, fCharge;
+
+  std::vector< Candidate * > fCandidates;
+};
+
+#endif /* DelphesParticleStore_h */
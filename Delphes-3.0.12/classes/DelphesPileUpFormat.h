@@ -0,0 +1,71 @@
+#ifndef DelphesPileUpFormat_h
+#define DelphesPileUpFormat_h
+
+/** \class DelphesPileUpFormat
+ *
+ *  Layout of the columnar pile-up file, written in native byte order.
+ *
+ *  The file starts with DelphesPileUpHeader. Every event is a block
+ *  aligned on kPileUpAlignment bytes holding the column of PID indices
+ *  (short) followed by the columns x, y, z, t, px, py, pz, e (float),
+ *  each column padded to kPileUpAlignment bytes. The PID indices refer
+ *  to the table of PDG codes (int) at indexOffset, which is followed by
+ *  the index of the events (DelphesPileUpIndex).
+ *
+ *  Files of the older format (XDR records with a trailing index)
+ *  do not start with kPileUpMagic.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+static const char kPileUpMagic[8] = {'D', 'E', 'L', 'P', 'H', 'E', 'S', 'P'};
+static const unsigned int kPileUpByteOrder = 0x01020304;
+static const unsigned int kPileUpVersion = 1;
+
+static const int kPileUpAlignment = 64;
+
+enum DelphesPileUpColumn
+{
+  kPileUpX, kPileUpY, kPileUpZ, kPileUpT,
+  kPileUpPx, kPileUpPy, kPileUpPz, kPileUpE,
+  kPileUpColumns
+};
+
+struct DelphesPileUpHeader
+{
+  char magic[8];
+  unsigned int byteOrder;
+  unsigned int version;
+
+  // particles with a lower transverse momentum are not stored
+  float minPT;
+  int numberOfPIDs;
+
+  long long entries;
+  long long indexOffset;
+
+  char padding[kPileUpAlignment - 40];
+};
+
+struct DelphesPileUpIndex
+{
+  long long offset;
+  long long size;
+};
+
+// number of values of a column padded to kPileUpAlignment bytes
+inline long long GetPileUpColumnSize(long long size, long long valueSize)
+{
+  long long values = kPileUpAlignment/valueSize;
+  return (size + values - 1)/values*values;
+}
+
+// size in bytes of an event of size particles
+inline long long GetPileUpEntryBytes(long long size)
+{
+  return GetPileUpColumnSize(size, 2)*2 + kPileUpColumns*GetPileUpColumnSize(size, 4)*4;
+}
+
+#endif // DelphesPileUpFormat_h
@@ -0,0 +1,438 @@
+
+/** \class DelphesPileUpPool
+ *
+ *  Pile-up events decoded once into a POSIX shared-memory segment.
+ *
+ *  The first process that opens the segment loads the events of the
+ *  pile-up file, together with the charges and masses of their PDG codes.
+ *  The other processes of the node attach to the segment and wait until
+ *  it is ready, or until the process that loads it has ended.
+ *  The segment stays in memory after the jobs, it is
+ *  removed with rm /dev/shm/<name>.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesPileUpPool.h"
+#include "classes/DelphesPileUpReader.h"
+#include "classes/DelphesPDGTable.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+static const char kPoolMagic[8] = {'D', 'E', 'L', 'P', 'H', 'P', 'O', 'O'};
+static const unsigned int kPoolVersion = 2;
+
+// seconds to wait for the process that loads the events
+static const int kPoolTimeout = 3600;
+
+//------------------------------------------------------------------------------
+
+struct DelphesPileUpPool::Header
+{
+  char magic[8];
+  unsigned int version;
+
+  // set when all events are loaded
+  volatile int ready;
+
+  // process that loads the events
+  long long creator;
+
+  // pile-up file and number of events the segment was loaded from
+  long long fileSize;
+  long long modificationTime;
+  long long numberOfEvents;
+
+  long long entries;
+  long long particles;
+  int numberOfPIDs;
+};
+
+//------------------------------------------------------------------------------
+
+static size_t Align(size_t size)
+{
+  return (size + kPileUpAlignment - 1)/kPileUpAlignment*kPileUpAlignment;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesPileUpPool::DelphesPileUpPool(const char *segmentName, const char *fileName, long long numberOfEvents) :
+  fSegment(0), fSize(0), fEntries(0), fIndex(0), fAllPIDIndices(0), fParticles(0),
+  fEntrySize(0), fPIDIndices(0), fPIDs(0), fCharges(0), fMasses(0), fNumberOfPIDs(0)
+{
+  stringstream message;
+  struct stat status;
+  const Header *header;
+  int descriptor, i;
+
+  for(i = 0; i < kPileUpColumns; ++i) fAllColumns[i] = fColumns[i] = 0;
+
+  if(stat(fileName, &status) != 0)
+  {
+    message << "can't open pile-up file " << fileName;
+    throw runtime_error(message.str());
+  }
+
+  // only one process creates the segment
+  descriptor = shm_open(segmentName, O_RDWR | O_CREAT | O_EXCL, 0644);
+  if(descriptor >= 0)
+  {
+    try
+    {
+      Create(descriptor, fileName, status, numberOfEvents);
+    }
+    catch(...)
+    {
+      if(fSegment) munmap(fSegment, fSize);
+      fSegment = 0;
+      close(descriptor);
+      shm_unlink(segmentName);
+      throw;
+    }
+  }
+  else
+  {
+    if(errno != EEXIST || (descriptor = shm_open(segmentName, O_RDONLY, 0)) < 0)
+    {
+      message << "can't open pile-up pool " << segmentName;
+      throw runtime_error(message.str());
+    }
+
+    try
+    {
+      Attach(descriptor, segmentName);
+    }
+    catch(...)
+    {
+      close(descriptor);
+      throw;
+    }
+  }
+
+  close(descriptor);
+
+  header = reinterpret_cast<const Header *>(fSegment);
+
+  if(header->fileSize != (long long)(status.st_size) ||
+    header->modificationTime != (long long)(status.st_mtime) ||
+    header->numberOfEvents != numberOfEvents)
+  {
+    munmap(fSegment, fSize);
+    fSegment = 0;
+    message << "pile-up pool " << segmentName << " was loaded from another pile-up file or size, ";
+    message << "remove /dev/shm" << segmentName << " or use another PileUpPool";
+    throw runtime_error(message.str());
+  }
+
+  SetPointers();
+}
+
+//------------------------------------------------------------------------------
+
+DelphesPileUpPool::~DelphesPileUpPool()
+{
+  if(fSegment) munmap(fSegment, fSize);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPileUpPool::Map(int descriptor, size_t size, int protection)
+{
+  void *segment;
+
+  segment = mmap(0, size, protection, MAP_SHARED, descriptor, 0);
+  if(segment == MAP_FAILED)
+  {
+    throw runtime_error("can't map pile-up pool");
+  }
+
+  fSegment = static_cast<char *>(segment);
+  fSize = size;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPileUpPool::Create(int descriptor, const char *fileName, const struct stat &status, long long numberOfEvents)
+{
+  DelphesPileUpReader reader(fileName);
+  const DelphesPDGTable *pdg = DelphesPDGTable::Instance();
+  const DelphesPDGProperties *pdgProperties;
+  Header *header;
+  DelphesPileUpIndex *index;
+  short *pidIndices;
+  float *columns[kPileUpColumns];
+  long long allEntries, entries, entry, k, particles, offset;
+  size_t size, position;
+  int *pids, *charges;
+  double *masses;
+  int i, numberOfPIDs, entrySize;
+
+  // the header comes first, so that the other processes know who loads the events
+  size = Align(sizeof(Header));
+  if(ftruncate(descriptor, size) != 0)
+  {
+    throw runtime_error("can't allocate pile-up pool");
+  }
+
+  Map(descriptor, size, PROT_READ | PROT_WRITE);
+  header = reinterpret_cast<Header *>(fSegment);
+  memcpy(header->magic, kPoolMagic, sizeof(kPoolMagic));
+  header->version = kPoolVersion;
+  header->creator = getpid();
+
+  allEntries = reader.GetEntries();
+  entries = (numberOfEvents > 0 && numberOfEvents < allEntries) ? numberOfEvents : allEntries;
+
+  cout << "** Loading " << entries << " pile-up events into the shared memory" << endl;
+
+  // events are taken at regular intervals over the whole file,
+  // their sizes are read first to allocate the segment
+  particles = 0;
+  for(k = 0; k < entries; ++k)
+  {
+    particles += reader.GetEntrySize(k*allEntries/entries);
+  }
+
+  // header, index, PID indices and columns, then PDG codes, charges and masses
+  size = Align(sizeof(Header));
+  size += Align(entries*sizeof(DelphesPileUpIndex));
+  size += Align(particles*sizeof(short));
+  size += kPileUpColumns*Align(particles*sizeof(float));
+
+  if(ftruncate(descriptor, size) != 0)
+  {
+    throw runtime_error("can't allocate pile-up pool");
+  }
+
+  munmap(fSegment, fSize);
+  fSegment = 0;
+  Map(descriptor, size, PROT_READ | PROT_WRITE);
+
+  position = Align(sizeof(Header));
+  index = reinterpret_cast<DelphesPileUpIndex *>(fSegment + position);
+  position += Align(entries*sizeof(DelphesPileUpIndex));
+  pidIndices = reinterpret_cast<short *>(fSegment + position);
+  position += Align(particles*sizeof(short));
+  for(i = 0; i < kPileUpColumns; ++i)
+  {
+    columns[i] = reinterpret_cast<float *>(fSegment + position);
+    position += Align(particles*sizeof(float));
+  }
+
+  // the events are copied from the file or from the decoded record into the segment
+  offset = 0;
+  for(k = 0; k < entries; ++k)
+  {
+    entry = k*allEntries/entries;
+    reader.ReadEntry(entry);
+
+    entrySize = reader.GetEntrySize();
+    if(offset + entrySize > particles)
+    {
+      throw runtime_error("pile-up file changed while loading the pool");
+    }
+
+    index[k].offset = offset;
+    index[k].size = entrySize;
+
+    if(entrySize == 0) continue;
+
+    memcpy(pidIndices + offset, reader.GetPIDIndices(), entrySize*sizeof(short));
+    for(i = 0; i < kPileUpColumns; ++i)
+    {
+      memcpy(columns[i] + offset, reader.GetColumn(i), entrySize*sizeof(float));
+    }
+
+    offset += entrySize;
+  }
+
+  // the table of PDG codes of the older format is complete once all events are decoded
+  numberOfPIDs = reader.GetNumberOfPIDs();
+
+  position = size;
+  size += 3*Align(numberOfPIDs*sizeof(double));
+
+  if(ftruncate(descriptor, size) != 0)
+  {
+    throw runtime_error("can't allocate pile-up pool");
+  }
+
+  munmap(fSegment, fSize);
+  fSegment = 0;
+  Map(descriptor, size, PROT_READ | PROT_WRITE);
+
+  // the candidates do not need any lookup in the PDG table
+  pids = reinterpret_cast<int *>(fSegment + position);
+  position += Align(numberOfPIDs*sizeof(double));
+  charges = reinterpret_cast<int *>(fSegment + position);
+  position += Align(numberOfPIDs*sizeof(double));
+  masses = reinterpret_cast<double *>(fSegment + position);
+  for(i = 0; i < numberOfPIDs; ++i)
+  {
+    pids[i] = reader.GetPIDs()[i];
+    pdgProperties = &pdg->GetProperties(pids[i]);
+    charges[i] = pdgProperties->charge;
+    masses[i] = pdgProperties->mass;
+  }
+
+  header = reinterpret_cast<Header *>(fSegment);
+  header->fileSize = status.st_size;
+  header->modificationTime = status.st_mtime;
+  header->numberOfEvents = numberOfEvents;
+  header->entries = entries;
+  header->particles = particles;
+  header->numberOfPIDs = numberOfPIDs;
+
+  // the other processes only read the events once they see the flag
+  __sync_synchronize();
+  header->ready = 1;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPileUpPool::Attach(int descriptor, const char *segmentName)
+{
+  stringstream message;
+  struct stat status, current;
+  const Header *header = 0;
+  void *segment;
+  int seconds, descriptorCurrent;
+  long long creator;
+
+  for(seconds = 0; seconds <= kPoolTimeout; ++seconds)
+  {
+    // the creator writes the header before it loads the events
+    if(!header && fstat(descriptor, &status) == 0 && size_t(status.st_size) >= sizeof(Header))
+    {
+      segment = mmap(0, sizeof(Header), PROT_READ, MAP_SHARED, descriptor, 0);
+      if(segment == MAP_FAILED)
+      {
+        throw runtime_error("can't map pile-up pool");
+      }
+      header = static_cast<const Header *>(segment);
+    }
+
+    if(header && header->ready)
+    {
+      __sync_synchronize();
+
+      if(memcmp(header->magic, kPoolMagic, sizeof(kPoolMagic)) != 0 || header->version != kPoolVersion)
+      {
+        munmap(const_cast<Header *>(header), sizeof(Header));
+        message << "invalid pile-up pool " << segmentName;
+        throw runtime_error(message.str());
+      }
+
+      munmap(const_cast<Header *>(header), sizeof(Header));
+
+      // the segment has its final size once it is ready
+      if(fstat(descriptor, &status) != 0)
+      {
+        throw runtime_error("can't map pile-up pool");
+      }
+      Map(descriptor, status.st_size, PROT_READ);
+
+      return;
+    }
+
+    // a creator that was killed leaves the segment behind without loading it
+    creator = header ? header->creator : 0;
+    if(creator > 0 && kill(pid_t(creator), 0) != 0 && errno == ESRCH)
+    {
+      munmap(const_cast<Header *>(header), sizeof(Header));
+      message << "process " << creator << " that was loading pile-up pool " << segmentName;
+      message << " has ended, remove /dev/shm" << segmentName;
+      throw runtime_error(message.str());
+    }
+
+    // the segment is removed when its creation fails
+    descriptorCurrent = shm_open(segmentName, O_RDONLY, 0);
+    if(descriptorCurrent < 0) break;
+    fstat(descriptorCurrent, &current);
+    close(descriptorCurrent);
+    fstat(descriptor, &status);
+    if(current.st_ino != status.st_ino) break;
+
+    if(seconds == 0) cout << "** Waiting for pile-up pool " << segmentName << endl;
+
+    sleep(1);
+  }
+
+  if(header) munmap(const_cast<Header *>(header), sizeof(Header));
+
+  message << "pile-up pool " << segmentName << " was not loaded";
+  throw runtime_error(message.str());
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPileUpPool::SetPointers()
+{
+  const Header *header = reinterpret_cast<const Header *>(fSegment);
+  size_t offset;
+  int i;
+
+  fEntries = header->entries;
+  fParticles = header->particles;
+  fNumberOfPIDs = header->numberOfPIDs;
+
+  offset = Align(sizeof(Header));
+  fIndex = reinterpret_cast<const DelphesPileUpIndex *>(fSegment + offset);
+
+  offset += Align(fEntries*sizeof(DelphesPileUpIndex));
+  fAllPIDIndices = reinterpret_cast<const short *>(fSegment + offset);
+
+  offset += Align(fParticles*sizeof(short));
+  for(i = 0; i < kPileUpColumns; ++i)
+  {
+    fAllColumns[i] = reinterpret_cast<const float *>(fSegment + offset);
+    offset += Align(fParticles*sizeof(float));
+  }
+
+  fPIDs = reinterpret_cast<const int *>(fSegment + offset);
+
+  offset += Align(fNumberOfPIDs*sizeof(double));
+  fCharges = reinterpret_cast<const int *>(fSegment + offset);
+
+  offset += Align(fNumberOfPIDs*sizeof(double));
+  fMasses = reinterpret_cast<const double *>(fSegment + offset);
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesPileUpPool::ReadEntry(long long entry)
+{
+  long long offset;
+  int i;
+
+  if(entry < 0 || entry >= fEntries) return false;
+
+  // the events are slices of the columns of the segment
+  offset = fIndex[entry].offset;
+  fEntrySize = fIndex[entry].size;
+
+  fPIDIndices = fAllPIDIndices + offset;
+  for(i = 0; i < kPileUpColumns; ++i)
+  {
+    fColumns[i] = fAllColumns[i] + offset;
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,79 @@
+#ifndef DelphesPileUpPool_h
+#define DelphesPileUpPool_h
+
+/** \class DelphesPileUpPool
+ *
+ *  Pile-up events decoded once into a POSIX shared-memory segment.
+ *
+ *  The first process that opens the segment loads the events of the
+ *  pile-up file, together with the charges and masses of their PDG codes.
+ *  The other processes of the node attach to the segment and wait until
+ *  it is ready, or until the process that loads it has ended.
+ *  The segment stays in memory after the jobs, it is
+ *  removed with rm /dev/shm/<name>.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include <stddef.h>
+#include <sys/stat.h>
+
+#include "classes/DelphesPileUpFormat.h"
+
+class DelphesPileUpPool
+{
+public:
+
+  // loads numberOfEvents events spread over the pile-up file,
+  // or all of them when numberOfEvents is not positive
+  DelphesPileUpPool(const char *segmentName, const char *fileName, long long numberOfEvents = 0);
+
+  ~DelphesPileUpPool();
+
+  long long GetEntries() const { return fEntries; }
+
+  bool ReadEntry(long long entry);
+
+  // columns of the current entry, see DelphesPileUpFormat.h
+  int GetEntrySize() const { return fEntrySize; }
+  const short *GetPIDIndices() const { return fPIDIndices; }
+  const float *GetColumn(int column) const { return fColumns[column]; }
+
+  // PDG codes, charges and masses of the PID indices
+  const int *GetPIDs() const { return fPIDs; }
+  const int *GetCharges() const { return fCharges; }
+  const double *GetMasses() const { return fMasses; }
+  int GetNumberOfPIDs() const { return fNumberOfPIDs; }
+
+private:
+
+  struct Header;
+
+  void Create(int descriptor, const char *fileName, const struct stat &status, long long numberOfEvents);
+  void Attach(int descriptor, const char *segmentName);
+  void Map(int descriptor, size_t size, int protection);
+  void SetPointers();
+
+  char *fSegment;
+  size_t fSize;
+
+  long long fEntries;
+  const DelphesPileUpIndex *fIndex;
+
+  const short *fAllPIDIndices;
+  const float *fAllColumns[kPileUpColumns];
+  long long fParticles;
+
+  int fEntrySize;
+  const short *fPIDIndices;
+  const float *fColumns[kPileUpColumns];
+
+  const int *fPIDs;
+  const int *fCharges;
+  const double *fMasses;
+  int fNumberOfPIDs;
+};
+
+#endif // DelphesPileUpPool_h
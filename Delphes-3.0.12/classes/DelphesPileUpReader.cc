@@ -1,8 +1,13 @@
 
+
 /** \class DelphesPileUpReader
  *
  *  Reads pile-up binary file
  *
+ *  The file is mapped read-only and shared by all readers of the process,
+ *  the page cache shares it between processes.
+ *  Events of the columnar format are used in place,
+ *  events of the older XDR format are decoded into columns.
  *
  *  $Date: 2013-03-08 09:25:30 +0100 (Fri, 08 Mar 2013) $
  *  $Revision: 1046 $
@@ -17,72 +22,242 @@
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
+#include <utility>
+#include <map>
 
-#include <stdio.h>
-#include <rpc/types.h>
-#include <rpc/xdr.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
 
 using namespace std;
 
-static const int kIndexSize = 10000000;
-static const int kBufferSize = 1000000;
+// older format: XDR records of pid, x, y, z, t, px, py, pz, e
 static const int kRecordSize = 9;
 
 //------------------------------------------------------------------------------
 
-DelphesPileUpReader::DelphesPileUpReader(const char *fileName) :
-  fEntries(0), fEntrySize(0), fCounter(0),
-  fPileUpFile(0), fIndex(0), fBuffer(0),
-  fInputXDR(0), fIndexXDR(0), fBufferXDR(0)
+// files are identified by device and inode, whatever the path used to open them
+typedef pair< dev_t, ino_t > MappingKey;
+
+struct Mapping
 {
-  stringstream message;
+  char *data;
+  size_t size;
+  int users;
+};
+
+static map< MappingKey, Mapping > gMappings;
+static pthread_mutex_t gMappingMutex = PTHREAD_MUTEX_INITIALIZER;
 
-  fIndex = new char[kIndexSize*8];
-  fBuffer = new char[kBufferSize*kRecordSize*4];
-  fInputXDR = new XDR;
-  fIndexXDR = new XDR;
-  fBufferXDR = new XDR;
-  xdrmem_create(fIndexXDR, fIndex, kIndexSize*8, XDR_DECODE);
-  xdrmem_create(fBufferXDR, fBuffer, kBufferSize*kRecordSize*4, XDR_DECODE);
+//------------------------------------------------------------------------------
+
+static char *AcquireMapping(const char *fileName, size_t &size)
+{
+  stringstream message;
+  map< MappingKey, Mapping >::iterator itMappings;
+  struct stat status;
+  Mapping mapping;
+  MappingKey key;
+  void *data;
+  int descriptor;
 
-  fPileUpFile = fopen(fileName, "r");
+  descriptor = open(fileName, O_RDONLY);
 
-  if(fPileUpFile == NULL)
+  if(descriptor < 0)
   {
     message << "can't open pile-up file " << fileName;
     throw runtime_error(message.str());
   }
 
-  xdrstdio_create(fInputXDR, fPileUpFile, XDR_DECODE);
+  if(fstat(descriptor, &status) != 0 || status.st_size <= 0 ||
+    (long long)(size_t)(status.st_size) != (long long)(status.st_size))
+  {
+    close(descriptor);
+    message << "can't map pile-up file " << fileName;
+    throw runtime_error(message.str());
+  }
 
-  // read number of events
-  fseek(fPileUpFile, -8, SEEK_END);
-  xdr_hyper(fInputXDR, &fEntries);
+  key = MappingKey(status.st_dev, status.st_ino);
+
+  pthread_mutex_lock(&gMappingMutex);
 
-  if(fEntries >= kIndexSize)
+  itMappings = gMappings.find(key);
+  if(itMappings == gMappings.end())
   {
-    message << "too many events in pile-up file " << fileName;
-    throw runtime_error(message.str());
+    data = mmap(0, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+    if(data == MAP_FAILED)
+    {
+      pthread_mutex_unlock(&gMappingMutex);
+      close(descriptor);
+      message << "can't map pile-up file " << fileName;
+      throw runtime_error(message.str());
+    }
+
+    // the events are picked at random, reading ahead would only evict useful pages
+    madvise(data, status.st_size, MADV_RANDOM);
+
+    mapping.data = static_cast<char *>(data);
+    mapping.size = status.st_size;
+    mapping.users = 0;
+    itMappings = gMappings.insert(make_pair(key, mapping)).first;
   }
 
-  // read index of events
-  fseek(fPileUpFile, -8 - 8*fEntries, SEEK_END);
-  xdr_opaque(fInputXDR, fIndex, fEntries*8);
+  ++(itMappings->second.users);
+  size = itMappings->second.size;
+  data = itMappings->second.data;
+
+  pthread_mutex_unlock(&gMappingMutex);
+
+  close(descriptor);
+
+  return static_cast<char *>(data);
+}
+
+//------------------------------------------------------------------------------
+
+static void ReleaseMapping(const char *data)
+{
+  map< MappingKey, Mapping >::iterator itMappings;
+
+  pthread_mutex_lock(&gMappingMutex);
+
+  for(itMappings = gMappings.begin(); itMappings != gMappings.end(); ++itMappings)
+  {
+    if(itMappings->second.data != data) continue;
+
+    if(--(itMappings->second.users) == 0)
+    {
+      munmap(itMappings->second.data, itMappings->second.size);
+      gMappings.erase(itMappings);
+    }
+    break;
+  }
+
+  pthread_mutex_unlock(&gMappingMutex);
+}
+
+//------------------------------------------------------------------------------
+
+// the older format is written in XDR, that is in big-endian byte order
+
+static inline int DecodeInt(const char *buffer)
+{
+  unsigned int word;
+  memcpy(&word, buffer, 4);
+  return int(ntohl(word));
+}
+
+static inline quad_t DecodeHyper(const char *buffer)
+{
+  unsigned int high, low;
+  memcpy(&high, buffer, 4);
+  memcpy(&low, buffer + 4, 4);
+  return quad_t((u_quad_t(ntohl(high)) << 32) | u_quad_t(ntohl(low)));
+}
+
+//------------------------------------------------------------------------------
+
+DelphesPileUpReader::DelphesPileUpReader(const char *fileName) :
+  fEntries(0), fEntrySize(0), fCounter(0), fRecords(false), fMinPT(0.0),
+  fData(0), fIndex(0), fDataSize(0), fPIDIndices(0), fPIDs(0), fNumberOfPIDs(0)
+{
+  size_t size;
+  int i;
+
+  for(i = 0; i < kPileUpColumns; ++i) fColumns[i] = 0;
+
+  fData = AcquireMapping(fileName, size);
+
+  try
+  {
+    if(size >= sizeof(DelphesPileUpHeader) && memcmp(fData, kPileUpMagic, sizeof(kPileUpMagic)) == 0)
+    {
+      OpenColumns(fileName, size);
+    }
+    else
+    {
+      OpenRecords(fileName, size);
+    }
+  }
+  catch(runtime_error &)
+  {
+    ReleaseMapping(fData);
+    throw;
+  }
 }
 
 //------------------------------------------------------------------------------
 
 DelphesPileUpReader::~DelphesPileUpReader()
 {
-  xdr_destroy(fInputXDR);
-  if(fPileUpFile) fclose(fPileUpFile);
-  xdr_destroy(fBufferXDR);
-  xdr_destroy(fIndexXDR);
-  if(fBufferXDR) delete fBufferXDR;
-  if(fIndexXDR) delete fIndexXDR;
-  if(fInputXDR) delete fInputXDR;
-  if(fBuffer) delete[] fBuffer;
-  if(fIndex) delete[] fIndex;
+  if(fData) ReleaseMapping(fData);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPileUpReader::OpenColumns(const char *fileName, size_t size)
+{
+  stringstream message;
+  DelphesPileUpHeader header;
+  long long indexSize;
+
+  memcpy(&header, fData, sizeof(header));
+
+  if(header.byteOrder != kPileUpByteOrder)
+  {
+    message << "pile-up file " << fileName << " was written with another byte order";
+    throw runtime_error(message.str());
+  }
+
+  if(header.version != kPileUpVersion)
+  {
+    message << "unknown version " << header.version << " of pile-up file " << fileName;
+    throw runtime_error(message.str());
+  }
+
+  // table of PDG codes, padded to 8 bytes, and index of the events
+  indexSize = (header.numberOfPIDs*4 + 7)/8*8 + header.entries*sizeof(DelphesPileUpIndex);
+
+  if(header.entries < 0 || header.numberOfPIDs < 0 || header.indexOffset < 0 ||
+    header.indexOffset % 8 != 0 || header.indexOffset + indexSize != (long long)(size))
+  {
+    message << "invalid pile-up file " << fileName;
+    throw runtime_error(message.str());
+  }
+
+  fEntries = header.entries;
+  fMinPT = header.minPT;
+
+  fDataSize = header.indexOffset;
+  fPIDs = reinterpret_cast<const int *>(fData + header.indexOffset);
+  fNumberOfPIDs = header.numberOfPIDs;
+  fIndex = fData + header.indexOffset + (header.numberOfPIDs*4 + 7)/8*8;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPileUpReader::OpenRecords(const char *fileName, size_t size)
+{
+  stringstream message;
+
+  fRecords = true;
+
+  // read number of events
+  if(size >= 8) fEntries = DecodeHyper(fData + size - 8);
+
+  if(size < 8 || fEntries < 0 || fEntries > quad_t((size - 8)/8))
+  {
+    message << "invalid pile-up file " << fileName;
+    throw runtime_error(message.str());
+  }
+
+  // index of events
+  fIndex = fData + size - 8 - 8*fEntries;
+  fDataSize = fIndex - fData;
 }
 
 //------------------------------------------------------------------------------
@@ -93,15 +268,15 @@ bool DelphesPileUpReader::ReadParticle(int &pid,
 {
   if(fCounter >= fEntrySize) return false;
 
-  xdr_int(fBufferXDR, &pid);
-  xdr_float(fBufferXDR, &x);
-  xdr_float(fBufferXDR, &y);
-  xdr_float(fBufferXDR, &z);
-  xdr_float(fBufferXDR, &t);
-  xdr_float(fBufferXDR, &px);
-  xdr_float(fBufferXDR, &py);
-  xdr_float(fBufferXDR, &pz);
-  xdr_float(fBufferXDR, &e);
+  pid = fPIDs[fPIDIndices[fCounter]];
+  x = fColumns[kPileUpX][fCounter];
+  y = fColumns[kPileUpY][fCounter];
+  z = fColumns[kPileUpZ][fCounter];
+  t = fColumns[kPileUpT][fCounter];
+  px = fColumns[kPileUpPx][fCounter];
+  py = fColumns[kPileUpPy][fCounter];
+  pz = fColumns[kPileUpPz][fCounter];
+  e = fColumns[kPileUpE][fCounter];
 
   ++fCounter;
 
@@ -110,30 +285,162 @@ bool DelphesPileUpReader::ReadParticle(int &pid,
 
 //------------------------------------------------------------------------------
 
-bool DelphesPileUpReader::ReadEntry(quad_t entry)
+int DelphesPileUpReader::GetEntrySize(quad_t entry) const
 {
+  DelphesPileUpIndex index;
   quad_t offset;
+  int size;
+
+  if(entry < 0 || entry >= fEntries) return 0;
+
+  if(fRecords)
+  {
+    offset = DecodeHyper(fIndex + 8*entry);
 
-  if(entry >= fEntries) return false;
+    if(offset < 0 || offset + 4 > fDataSize)
+    {
+      throw runtime_error("invalid pile-up event offset");
+    }
 
-  // read event position
-  xdr_setpos(fIndexXDR, 8*entry);
-  xdr_hyper(fIndexXDR, &offset);
+    size = DecodeInt(fData + offset);
 
-  // read event
-  fseek(fPileUpFile, offset, SEEK_SET);
-  xdr_int(fInputXDR, &fEntrySize);
+    if(size < 0 || offset + 4 + quad_t(4*kRecordSize)*size > fDataSize)
+    {
+      throw runtime_error("too many particles in pile-up event");
+    }
 
-  if(fEntrySize >= kBufferSize)
+    return size;
+  }
+
+  memcpy(&index, fIndex + sizeof(DelphesPileUpIndex)*entry, sizeof(index));
+
+  if(index.offset < 0 || index.offset % kPileUpAlignment != 0 || index.size < 0 ||
+    index.size > fDataSize || index.offset + GetPileUpEntryBytes(index.size) > fDataSize)
   {
-    throw runtime_error("too many particles in pile-up event");
+    throw runtime_error("invalid pile-up event offset");
   }
 
-  xdr_opaque(fInputXDR, fBuffer, fEntrySize*kRecordSize*4);
-  xdr_setpos(fBufferXDR, 0);
+  return int(index.size);
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesPileUpReader::ReadEntry(quad_t entry)
+{
+  DelphesPileUpIndex index;
+  quad_t offset, columnSize;
+  const char *buffer;
+  int i;
+
+  if(entry < 0 || entry >= fEntries) return false;
+
   fCounter = 0;
 
+  if(fRecords)
+  {
+    // read event position
+    offset = DecodeHyper(fIndex + 8*entry);
+
+    if(offset < 0 || offset + 4 > fDataSize)
+    {
+      throw runtime_error("invalid pile-up event offset");
+    }
+
+    // read event
+    fEntrySize = DecodeInt(fData + offset);
+
+    if(fEntrySize < 0 || offset + 4 + quad_t(4*kRecordSize)*fEntrySize > fDataSize)
+    {
+      throw runtime_error("too many particles in pile-up event");
+    }
+
+    DecodeRecords(fData + offset + 4);
+
+    return true;
+  }
+
+  memcpy(&index, fIndex + sizeof(DelphesPileUpIndex)*entry, sizeof(index));
+
+  if(index.offset < 0 || index.offset % kPileUpAlignment != 0 || index.size < 0 ||
+    index.size > fDataSize || index.offset + GetPileUpEntryBytes(index.size) > fDataSize)
+  {
+    throw runtime_error("invalid pile-up event offset");
+  }
+
+  fEntrySize = index.size;
+
+  // the columns are used in place
+  buffer = fData + index.offset;
+  fPIDIndices = reinterpret_cast<const short *>(buffer);
+  buffer += GetPileUpColumnSize(fEntrySize, sizeof(short))*sizeof(short);
+
+  columnSize = GetPileUpColumnSize(fEntrySize, sizeof(float));
+  for(i = 0; i < kPileUpColumns; ++i)
+  {
+    fColumns[i] = reinterpret_cast<const float *>(buffer + i*columnSize*sizeof(float));
+  }
+
+  // the PID indices are used to look up the table of PDG codes without any check
+  for(i = 0; i < fEntrySize; ++i)
+  {
+    if(fPIDIndices[i] < 0 || fPIDIndices[i] >= fNumberOfPIDs)
+    {
+      throw runtime_error("invalid PID index in pile-up event");
+    }
+  }
+
   return true;
 }
 
 //------------------------------------------------------------------------------
+
+void DelphesPileUpReader::DecodeRecords(const char *records)
+{
+  map< int, short >::iterator itPIDMap;
+  unsigned int words[kRecordSize];
+  float values[kRecordSize];
+  float *columns;
+  int i, j, pid;
+
+  fPIDIndexBuffer.resize(fEntrySize);
+  fColumnBuffer.resize(kPileUpColumns*fEntrySize);
+
+  columns = fColumnBuffer.empty() ? 0 : &fColumnBuffer[0];
+
+  for(i = 0; i < fEntrySize; ++i)
+  {
+    // all fields of the record are swapped in one loop, which the compiler vectorizes
+    memcpy(words, records + 4*kRecordSize*i, sizeof(words));
+    for(j = 0; j < kRecordSize; ++j) words[j] = ntohl(words[j]);
+    memcpy(values, words, sizeof(values));
+
+    pid = int(words[0]);
+    itPIDMap = fPIDMap.find(pid);
+    if(itPIDMap == fPIDMap.end())
+    {
+      if(fPIDBuffer.size() >= 32767)
+      {
+        throw runtime_error("too many different particles in pile-up file");
+      }
+      itPIDMap = fPIDMap.insert(make_pair(pid, short(fPIDBuffer.size()))).first;
+      fPIDBuffer.push_back(pid);
+    }
+    fPIDIndexBuffer[i] = itPIDMap->second;
+
+    for(j = 0; j < kPileUpColumns; ++j)
+    {
+      columns[j*fEntrySize + i] = values[j + 1];
+    }
+  }
+
+  fPIDs = fPIDBuffer.empty() ? 0 : &fPIDBuffer[0];
+  fNumberOfPIDs = fPIDBuffer.size();
+
+  fPIDIndices = fPIDIndexBuffer.empty() ? 0 : &fPIDIndexBuffer[0];
+  for(j = 0; j < kPileUpColumns; ++j)
+  {
+    fColumns[j] = columns ? columns + j*fEntrySize : 0;
+  }
+}
+
+//------------------------------------------------------------------------------
@@ -5,6 +5,11 @@
  *
  *  Reads pile-up binary file
  *
+ *  The file is mapped read-only and shared by all readers of the process,
+ *  the page cache shares it between processes.
+ *  Events of the columnar format are used in place,
+ *  events of the older XDR format are decoded into columns.
+ *
  *
  *  $Date: 2013-03-08 09:25:30 +0100 (Fri, 08 Mar 2013) $
  *  $Revision: 1046 $
@@ -14,9 +19,12 @@
  *
  */
 
-#include <stdio.h>
 #include <rpc/types.h>
-#include <rpc/xdr.h>
+
+#include <map>
+#include <vector>
+
+#include "classes/DelphesPileUpFormat.h"
 
 class DelphesPileUpReader
 {
@@ -30,26 +38,60 @@ public:
     float &x, float &y, float &z, float &t,
     float &px, float &py, float &pz, float &e);
 
+  // columnar format: points to the entry in the mapped file, nothing is copied
   bool ReadEntry(quad_t entry);
 
   quad_t GetEntries() const { return fEntries; }
 
+  // number of particles of an entry, without reading the entry
+  int GetEntrySize(quad_t entry) const;
+
+  // columns of the current entry, see DelphesPileUpFormat.h
+  int GetEntrySize() const { return fEntrySize; }
+  const short *GetPIDIndices() const { return fPIDIndices; }
+  const float *GetColumn(int column) const { return fColumns[column]; }
+
+  // PDG codes of the PID indices, the table grows while events
+  // of the older format are read
+  const int *GetPIDs() const { return fPIDs; }
+  int GetNumberOfPIDs() const { return fNumberOfPIDs; }
+
+  // particles with a lower transverse momentum were not stored
+  float GetMinPT() const { return fMinPT; }
+
 private:
 
+  void OpenColumns(const char *fileName, size_t size);
+  void OpenRecords(const char *fileName, size_t size);
+
+  void DecodeRecords(const char *records);
+
   quad_t fEntries;
 
   int fEntrySize;
   int fCounter;
 
-  FILE *fPileUpFile;
-  char *fIndex;
-  char *fBuffer;
+  bool fRecords;
 
-  XDR *fInputXDR;
-  XDR *fIndexXDR;
-  XDR *fBufferXDR;
-};
+  float fMinPT;
 
-#endif // DelphesPileUpReader_h
+  // mapped file and index of the events
+  const char *fData;
+  const char *fIndex;
+  quad_t fDataSize;
+
+  // columns of the current entry
+  const short *fPIDIndices;
+  const float *fColumns[kPileUpColumns];
 
+  const int *fPIDs;
+  int fNumberOfPIDs;
 
+  // older format: decoded entry and table of PDG codes
+  std::vector< short > fPIDIndexBuffer;
+  std::vector< float > fColumnBuffer;
+  std::vector< int > fPIDBuffer;
+  std::map< int, short > fPIDMap;
+};
+
+#endif // DelphesPileUpReader_h
@@ -1,8 +1,9 @@
-
 /** \class DelphesPileUpWriter
  *
  *  Writes pile-up binary file
  *
+ *  The particles of an event are collected in columns and written
+ *  as one aligned block, see DelphesPileUpFormat.h.
  *
  *  $Date: 2013-03-10 01:53:09 +0100 (Sun, 10 Mar 2013) $
  *  $Revision: 1054 $
@@ -19,31 +20,19 @@
 #include <sstream>
 
 #include <stdio.h>
-#include <rpc/types.h>
-#include <rpc/xdr.h>
+#include <string.h>
 
 using namespace std;
 
-static const int kIndexSize = 10000000;
-static const int kBufferSize = 1000000;
-static const int kRecordSize = 9;
+static const int kMaxPIDs = 32767;
 
 //------------------------------------------------------------------------------
 
-DelphesPileUpWriter::DelphesPileUpWriter(const char *fileName) :
-  fEntries(0), fEntrySize(0), fOffset(0),
-  fPileUpFile(0), fIndex(0), fBuffer(0),
-  fOutputXDR(0), fIndexXDR(0), fBufferXDR(0)
+DelphesPileUpWriter::DelphesPileUpWriter(const char *fileName, float minPT) :
+  fMinPT(minPT), fOffset(0), fPileUpFile(0)
 {
   stringstream message;
-
-  fIndex = new char[kIndexSize*8];
-  fBuffer = new char[kBufferSize*kRecordSize*4];
-  fOutputXDR = new XDR;
-  fIndexXDR = new XDR;
-  fBufferXDR = new XDR;
-  xdrmem_create(fIndexXDR, fIndex, kIndexSize*8, XDR_ENCODE);
-  xdrmem_create(fBufferXDR, fBuffer, kBufferSize*kRecordSize*4, XDR_ENCODE);
+  DelphesPileUpHeader header;
 
   fPileUpFile = fopen(fileName, "w+");
 
@@ -53,22 +42,28 @@ DelphesPileUpWriter::DelphesPileUpWriter(const char *fileName) :
     throw runtime_error(message.str());
   }
 
-  xdrstdio_create(fOutputXDR, fPileUpFile, XDR_ENCODE);
+  // the header is written again by WriteIndex
+  memset(&header, 0, sizeof(header));
+  Write(&header, sizeof(header));
 }
 
 //------------------------------------------------------------------------------
 
 DelphesPileUpWriter::~DelphesPileUpWriter()
 {
-  xdr_destroy(fOutputXDR);
   if(fPileUpFile) fclose(fPileUpFile);
-  xdr_destroy(fBufferXDR);
-  xdr_destroy(fIndexXDR);
-  if(fBufferXDR) delete fBufferXDR;
-  if(fIndexXDR) delete fIndexXDR;
-  if(fOutputXDR) delete fOutputXDR;
-  if(fBuffer) delete[] fBuffer;
-  if(fIndex) delete[] fIndex;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPileUpWriter::Write(const void *buffer, size_t size)
+{
+  if(size > 0 && fwrite(buffer, size, 1, fPileUpFile) != 1)
+  {
+    throw runtime_error("can't write pile-up file");
+  }
+
+  fOffset += size;
 }
 
 //------------------------------------------------------------------------------
@@ -77,51 +72,112 @@ void DelphesPileUpWriter::WriteParticle(int pid,
   float x, float y, float z, float t,
   float px, float py, float pz, float e)
 {
-  if(fEntrySize >= kBufferSize)
+  map< int, short >::iterator itPIDMap;
+  short index;
+
+  if(fMinPT > 0.0 && px*px + py*py < fMinPT*fMinPT) return;
+
+  // PDG codes are stored as indices in the table of the file
+  itPIDMap = fPIDMap.find(pid);
+  if(itPIDMap == fPIDMap.end())
+  {
+    if(fPIDs.size() >= size_t(kMaxPIDs))
+    {
+      throw runtime_error("too many different particles in pile-up file");
+    }
+
+    index = fPIDs.size();
+    fPIDMap[pid] = index;
+    fPIDs.push_back(pid);
+  }
+  else
   {
-    throw runtime_error("too many particles in pile-up event");
+    index = itPIDMap->second;
   }
 
-  xdr_int(fBufferXDR, &pid);
-  xdr_float(fBufferXDR, &x);
-  xdr_float(fBufferXDR, &y);
-  xdr_float(fBufferXDR, &z);
-  xdr_float(fBufferXDR, &t);
-  xdr_float(fBufferXDR, &px);
-  xdr_float(fBufferXDR, &py);
-  xdr_float(fBufferXDR, &pz);
-  xdr_float(fBufferXDR, &e);
-
-  ++fEntrySize;
+  fPIDIndices.push_back(index);
+  fColumns[kPileUpX].push_back(x);
+  fColumns[kPileUpY].push_back(y);
+  fColumns[kPileUpZ].push_back(z);
+  fColumns[kPileUpT].push_back(t);
+  fColumns[kPileUpPx].push_back(px);
+  fColumns[kPileUpPy].push_back(py);
+  fColumns[kPileUpPz].push_back(pz);
+  fColumns[kPileUpE].push_back(e);
 }
 
 //------------------------------------------------------------------------------
 
 void DelphesPileUpWriter::WriteEntry()
 {
-  if(fEntries >= kIndexSize)
+  DelphesPileUpIndex index;
+  long long size, pidSize, columnSize;
+  char *buffer;
+  int i;
+
+  size = fPIDIndices.size();
+  pidSize = GetPileUpColumnSize(size, sizeof(short));
+  columnSize = GetPileUpColumnSize(size, sizeof(float));
+
+  // the event is assembled with its padding and written at once
+  fBuffer.assign(GetPileUpEntryBytes(size), 0);
+  buffer = fBuffer.empty() ? 0 : &fBuffer[0];
+
+  if(size > 0)
   {
-    throw runtime_error("too many pile-up events");
+    memcpy(buffer, &fPIDIndices[0], size*sizeof(short));
+    buffer += pidSize*sizeof(short);
+
+    for(i = 0; i < kPileUpColumns; ++i)
+    {
+      memcpy(buffer, &fColumns[i][0], size*sizeof(float));
+      buffer += columnSize*sizeof(float);
+    }
   }
 
-  xdr_int(fOutputXDR, &fEntrySize);
-  xdr_opaque(fOutputXDR, fBuffer, fEntrySize*kRecordSize*4);
+  index.offset = fOffset;
+  index.size = size;
+  fIndex.push_back(index);
 
-  xdr_hyper(fIndexXDR, &fOffset);
-  fOffset += fEntrySize*kRecordSize*4 + 4;
+  if(!fBuffer.empty()) Write(&fBuffer[0], fBuffer.size());
 
-  xdr_setpos(fBufferXDR, 0);
-  fEntrySize = 0;
-        
-  ++fEntries;
+  fPIDIndices.clear();
+  for(i = 0; i < kPileUpColumns; ++i)
+  {
+    fColumns[i].clear();
+  }
 }
 
 //------------------------------------------------------------------------------
 
 void DelphesPileUpWriter::WriteIndex()
 {
-  xdr_opaque(fOutputXDR, fIndex, fEntries*8);
-  xdr_hyper(fOutputXDR, &fEntries);
+  DelphesPileUpHeader header;
+  long long indexOffset;
+  char padding[8] = {0};
+
+  // the table of PDG codes is followed by the index of the events
+  indexOffset = fOffset;
+
+  if(!fPIDs.empty()) Write(&fPIDs[0], fPIDs.size()*sizeof(int));
+  Write(padding, (8 - fOffset % 8) % 8);
+  if(!fIndex.empty()) Write(&fIndex[0], fIndex.size()*sizeof(DelphesPileUpIndex));
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kPileUpMagic, sizeof(header.magic));
+  header.byteOrder = kPileUpByteOrder;
+  header.version = kPileUpVersion;
+  header.minPT = fMinPT;
+  header.numberOfPIDs = fPIDs.size();
+  header.entries = fIndex.size();
+  header.indexOffset = indexOffset;
+
+  if(fseeko(fPileUpFile, 0, SEEK_SET) != 0 ||
+    fwrite(&header, sizeof(header), 1, fPileUpFile) != 1 ||
+    fflush(fPileUpFile) != 0)
+  {
+    throw runtime_error("can't write pile-up file");
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -5,9 +5,11 @@
  *
  *  Writes pile-up binary file
  *
+ *  The particles of an event are collected in columns and written
+ *  as one aligned block, see DelphesPileUpFormat.h.
  *
- *  $Date: 2013-03-10 01:53:09 +0100 (Sun, 10 Mar 2013) $
- *  $Revision: 1054 $
+ *  $Date: 2013-03-08 09:25:30 +0100 (Fri, 08 Mar 2013) $
+ *  $Revision: 1046 $
  *
  *
  *  \author P. Demin - UCL, Louvain-la-Neuve
@@ -15,14 +17,18 @@
  */
 
 #include <stdio.h>
-#include <rpc/types.h>
-#include <rpc/xdr.h>
+
+#include <map>
+#include <vector>
+
+#include "classes/DelphesPileUpFormat.h"
 
 class DelphesPileUpWriter
 {
 public:
 
-  DelphesPileUpWriter(const char *fileName);
+  // particles with transverse momentum below minPT are not written
+  DelphesPileUpWriter(const char *fileName, float minPT = 0.0);
 
   ~DelphesPileUpWriter();
 
@@ -36,19 +42,23 @@ public:
 
 private:
 
-  quad_t fEntries;
-  int fEntrySize;
-  quad_t fOffset;
+  void Write(const void *buffer, size_t size);
+
+  float fMinPT;
+
+  long long fOffset;
 
   FILE *fPileUpFile;
-  char *fIndex;
-  char *fBuffer;
 
-  XDR *fOutputXDR;
-  XDR *fIndexXDR;
-  XDR *fBufferXDR;
-};
+  std::vector< short > fPIDIndices;
+  std::vector< float > fColumns[kPileUpColumns];
 
-#endif // DelphesPileUpWriter_h
+  std::vector< int > fPIDs;
+  std::map< int, short > fPIDMap;
+
+  std::vector< DelphesPileUpIndex > fIndex;
 
+  std::vector< char > fBuffer;
+};
 
+#endif // DelphesPileUpWriter_h
@@ -0,0 +1,381 @@
+
+/** \class DelphesProMCReader
+ *
+ *  Reads ProMC file.
+ *  A prefetch thread decompresses the zip entries and decodes them
+ *  into a ring of ProMCEvent messages that are reused from one event
+ *  to the next. Decoded events are handed over in batches.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesProMCReader.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+#include "TMath.h"
+#include "TMutex.h"
+#include "TThread.h"
+#include "TCondition.h"
+#include "TObjArray.h"
+#include "TStopwatch.h"
+#include "TLorentzVector.h"
+
+#include "classes/DelphesClasses.h"
+#include "classes/DelphesFactory.h"
+#include "classes/DelphesPDGTable.h"
+
+#include "ExRootAnalysis/ExRootTreeBranch.h"
+
+#include "ProMC/ProMC.pb.h"
+#include "ProMC/ProMCBook.h"
+#include "ProMC/ProMCHeader.pb.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+
+DelphesProMCReader::DelphesProMCReader(Int_t batchSize) :
+  fInputFile(0), fThread(0), fMutex(0), fCondition(0),
+  fBatchSize(batchSize), fEvent(0),
+  fProduced(0), fReleasedLocal(0), fPublished(0), fReleased(0),
+  fEnd(kTRUE), fStop(kFALSE), fConsumed(0), fAvailable(0),
+  fNumberOfEvents(0), fMomentumUnit(1.0), fLengthUnit(1.0)
+{
+  Int_t i;
+
+  if(fBatchSize < 1) fBatchSize = 1;
+
+  for(i = 0; i < 2*fBatchSize; ++i)
+  {
+    fEvents.push_back(new ProMCEvent);
+  }
+
+  TThread::Initialize();
+
+  fMutex = new TMutex;
+  fCondition = new TCondition(fMutex);
+
+  fPDG = DelphesPDGTable::Instance();
+}
+
+//---------------------------------------------------------------------------
+
+DelphesProMCReader::~DelphesProMCReader()
+{
+  vector< ProMCEvent * >::iterator itEvents;
+
+  Close();
+
+  for(itEvents = fEvents.begin(); itEvents != fEvents.end(); ++itEvents)
+  {
+    delete *itEvents;
+  }
+
+  delete fCondition;
+  delete fMutex;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesProMCReader::SetInputFile(ProMCBook *inputFile)
+{
+  Close();
+
+  fInputFile = inputFile;
+
+  // the header comes before the events
+  ProMCHeader header = fInputFile->getHeader();
+
+  fMomentumUnit = header.momentumunit() > 0 ? header.momentumunit() : 1.0;
+  fLengthUnit = header.lengthunit() > 0 ? header.lengthunit() : 1.0;
+
+  fNumberOfEvents = fInputFile->getEvents();
+
+  fEvent = 0;
+  fProduced = fReleasedLocal = 0;
+  fPublished = fReleased = 0;
+  fConsumed = fAvailable = 0;
+  fEnd = kFALSE;
+  fStop = kFALSE;
+  fError.clear();
+
+  fThread = new TThread("DelphesProMCReader", &DelphesProMCReader::Prefetch, this);
+  fThread->Run();
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesProMCReader::Close()
+{
+  if(!fThread) return;
+
+  fMutex->Lock();
+  fStop = kTRUE;
+  fCondition->Broadcast();
+  fMutex->UnLock();
+
+  fThread->Join();
+  delete fThread;
+  fThread = 0;
+
+  fInputFile = 0;
+}
+
+//---------------------------------------------------------------------------
+
+void *DelphesProMCReader::Prefetch(void *arg)
+{
+  DelphesProMCReader *reader = static_cast<DelphesProMCReader *>(arg);
+  string error;
+
+  try
+  {
+    reader->Decode();
+  }
+  catch(runtime_error &e)
+  {
+    error = e.what();
+  }
+
+  reader->fMutex->Lock();
+  reader->fPublished = reader->fProduced;
+  reader->fEnd = kTRUE;
+  reader->fError = error;
+  reader->fCondition->Broadcast();
+  reader->fMutex->UnLock();
+
+  return 0;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesProMCReader::Decode()
+{
+  stringstream message;
+  Long64_t size = fEvents.size();
+  ProMCEvent *event;
+
+  while(fProduced < fNumberOfEvents)
+  {
+    // all events of the ring are still in use, hand over what has been decoded
+    if(fProduced - fReleasedLocal >= size)
+    {
+      fMutex->Lock();
+      fPublished = fProduced;
+      fCondition->Broadcast();
+      while(!fStop && fProduced - fReleased >= size) fCondition->Wait();
+      fReleasedLocal = fReleased;
+      fMutex->UnLock();
+    }
+
+    if(fStop) break;
+
+    if(fInputFile->next(fRecord) != 0) break;
+
+    // the repeated fields of the message keep their memory
+    event = fEvents[fProduced % size];
+    if(!event->ParseFromString(fRecord))
+    {
+      message << "can't decode ProMC event " << fProduced;
+      throw runtime_error(message.str());
+    }
+
+    ++fProduced;
+
+    if(fProduced % fBatchSize == 0)
+    {
+      fMutex->Lock();
+      fPublished = fProduced;
+      fReleasedLocal = fReleased;
+      fCondition->Broadcast();
+      fMutex->UnLock();
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+
+Bool_t DelphesProMCReader::ReadEvent()
+{
+  string error;
+
+  if(!fThread) return kFALSE;
+
+  // the previous event is released together with its batch
+  if(fConsumed == fAvailable || fConsumed % fBatchSize == 0)
+  {
+    fMutex->Lock();
+    fReleased = fConsumed;
+    fCondition->Broadcast();
+    while(fPublished == fConsumed && !fEnd) fCondition->Wait();
+    fAvailable = fPublished;
+    error = fError;
+    fMutex->UnLock();
+
+    if(!error.empty()) throw runtime_error(error);
+  }
+
+  if(fConsumed == fAvailable) return kFALSE;
+
+  fEvent = fEvents[fConsumed % fEvents.size()];
+  ++fConsumed;
+
+  return kTRUE;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesProMCReader::AnalyzeEvent(ExRootTreeBranch *branch, Long64_t eventNumber,
+  TStopwatch *readStopWatch, TStopwatch *procStopWatch)
+{
+  const ProMCEvent_Event &event = fEvent->event();
+  HepMCEvent *element;
+
+  element = static_cast<HepMCEvent *>(branch->NewEntry());
+
+  element->Number = event.number();
+
+  element->ProcessID = event.process_id();
+  element->MPI = event.mpi();
+  element->Weight = event.weight();
+  element->Scale = event.scale();
+  element->AlphaQED = event.alpha_qed();
+  element->AlphaQCD = event.alpha_qcd();
+
+  element->ID1 = event.id1();
+  element->ID2 = event.id2();
+  element->X1 = event.x1();
+  element->X2 = event.x2();
+  element->ScalePDF = event.scale_pdf();
+  element->PDF1 = event.pdf1();
+  element->PDF2 = event.pdf2();
+
+  element->ReadTime = readStopWatch->RealTime();
+  element->ProcTime = procStopWatch->RealTime();
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesProMCReader::AnalyzeParticles(DelphesFactory *factory,
+  TObjArray *allParticleOutputArray,
+  TObjArray *stableParticleOutputArray,
+  TObjArray *partonOutputArray)
+{
+  const ProMCEvent_Particles &particles = fEvent->particles();
+
+  Candidate *candidate;
+  const DelphesPDGProperties *pdgProperties;
+  int pdgCode, pid;
+  unsigned int status;
+  bool all, stable, parton;
+
+  int i, number;
+  const ::google::protobuf::int64 *px, *py, *pz;
+  const ::google::protobuf::uint64 *mass;
+  const ::google::protobuf::int32 *x, *y, *z, *t;
+  Double_t *momenta, *vertices;
+  Double_t momentumScale, lengthScale;
+
+  number = particles.pdg_id_size();
+  if(number == 0) return;
+
+  // convert the packed arrays in one pass before creating the candidates,
+  // vertices are optional and stay at zero when they are not stored
+  fMomenta.assign(4*number, 0.0);
+  fVertices.assign(4*number, 0.0);
+
+  momenta = &fMomenta[0];
+  vertices = &fVertices[0];
+
+  momentumScale = 1.0/fMomentumUnit;
+  lengthScale = 1.0/fLengthUnit;
+
+  if(particles.px_size() == number && particles.py_size() == number &&
+    particles.pz_size() == number && particles.mass_size() == number)
+  {
+    px = particles.px().data();
+    py = particles.py().data();
+    pz = particles.pz().data();
+    mass = particles.mass().data();
+
+    for(i = 0; i < number; ++i)
+    {
+      momenta[4*i] = px[i]*momentumScale;
+      momenta[4*i + 1] = py[i]*momentumScale;
+      momenta[4*i + 2] = pz[i]*momentumScale;
+      momenta[4*i + 3] = mass[i]*momentumScale;
+    }
+  }
+
+  if(particles.x_size() == number && particles.y_size() == number &&
+    particles.z_size() == number && particles.t_size() == number)
+  {
+    x = particles.x().data();
+    y = particles.y().data();
+    z = particles.z().data();
+    t = particles.t().data();
+
+    for(i = 0; i < number; ++i)
+    {
+      vertices[4*i] = x[i]*lengthScale;
+      vertices[4*i + 1] = y[i]*lengthScale;
+      vertices[4*i + 2] = z[i]*lengthScale;
+      vertices[4*i + 3] = t[i]*lengthScale;
+    }
+  }
+
+  // mothers and daughters are indices in the array of all particles
+  all = (allParticleOutputArray != 0);
+
+  for(i = 0; i < number; ++i)
+  {
+    pid = particles.pdg_id(i);
+    status = particles.status(i);
+
+    pdgProperties = &fPDG->GetProperties(pid);
+    pdgCode = TMath::Abs(pid);
+
+    stable = pdgProperties->known && status == 1;
+    parton = pdgProperties->known && !stable && (pdgCode <= 5 || pdgCode == 21 || pdgCode == 15);
+
+    // arrays that no module reads are not filled
+    if(!all && !(stable && stableParticleOutputArray) && !(parton && partonOutputArray)) continue;
+
+    candidate = factory->NewCandidate();
+
+    candidate->PID = pid;
+
+    candidate->Status = status;
+
+    candidate->M1 = all ? int(particles.mother1(i)) : -1;
+    candidate->M2 = all ? int(particles.mother2(i)) : -1;
+
+    candidate->D1 = all ? int(particles.daughter1(i)) : -1;
+    candidate->D2 = all ? int(particles.daughter2(i)) : -1;
+
+    candidate->Charge = pdgProperties->charge;
+    candidate->Mass = momenta[4*i + 3];
+
+    candidate->Momentum.SetXYZM(momenta[4*i], momenta[4*i + 1], momenta[4*i + 2], momenta[4*i + 3]);
+
+    candidate->Position.SetXYZT(vertices[4*i], vertices[4*i + 1], vertices[4*i + 2], vertices[4*i + 3]);
+
+    if(all) allParticleOutputArray->Add(candidate);
+
+    if(stable && stableParticleOutputArray)
+    {
+      stableParticleOutputArray->Add(candidate);
+    }
+    else if(parton && partonOutputArray)
+    {
+      partonOutputArray->Add(candidate);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,102 @@
+#ifndef DelphesProMCReader_h
+#define DelphesProMCReader_h
+
+/** \class DelphesProMCReader
+ *
+ *  Reads ProMC file.
+ *  A prefetch thread decompresses the zip entries and decodes them
+ *  into a ring of ProMCEvent messages that are reused from one event
+ *  to the next. Decoded events are handed over in batches.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <string>
+#include <vector>
+
+class TThread;
+class TMutex;
+class TCondition;
+class TObjArray;
+class TStopwatch;
+class DelphesPDGTable;
+class ExRootTreeBranch;
+class DelphesFactory;
+
+class ProMCBook;
+
+namespace promc
+{
+  class ProMCEvent;
+}
+
+class DelphesProMCReader
+{
+public:
+
+  DelphesProMCReader(Int_t batchSize = 64);
+  ~DelphesProMCReader();
+
+  // reads the header and starts the prefetch thread
+  void SetInputFile(ProMCBook *inputFile);
+
+  // stops the prefetch thread
+  void Close();
+
+  // moves to the next event, returns false at the end of the file
+  Bool_t ReadEvent();
+
+  void AnalyzeEvent(ExRootTreeBranch *branch, Long64_t eventNumber,
+    TStopwatch *readStopWatch, TStopwatch *procStopWatch);
+
+  void AnalyzeParticles(DelphesFactory *factory,
+    TObjArray *allParticleOutputArray,
+    TObjArray *stableParticleOutputArray,
+    TObjArray *partonOutputArray);
+
+private:
+
+  static void *Prefetch(void *arg);
+
+  void Decode();
+
+  ProMCBook *fInputFile;
+
+  TThread *fThread;
+  TMutex *fMutex;
+  TCondition *fCondition;
+
+  Int_t fBatchSize;
+
+  // ring of decoded events, two batches long
+  std::vector< promc::ProMCEvent * > fEvents;
+
+  promc::ProMCEvent *fEvent;
+
+  // used by the prefetch thread only
+  std::string fRecord;
+  Long64_t fProduced, fReleasedLocal;
+
+  // shared between the threads
+  Long64_t fPublished, fReleased;
+  Bool_t fEnd, fStop;
+  std::string fError;
+
+  // used by the calling thread only
+  Long64_t fConsumed, fAvailable;
+
+  Long64_t fNumberOfEvents;
+
+  Double_t fMomentumUnit, fLengthUnit;
+
+  // momenta and vertices of the current event converted to GeV and mm
+  std::vector< Double_t > fMomenta, fVertices;
+
+  const DelphesPDGTable *fPDG;
+};
+
+#endif // DelphesProMCReader_h
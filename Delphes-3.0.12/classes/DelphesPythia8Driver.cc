@@ -0,0 +1,450 @@
+
+/** \class DelphesPythia8Driver
+ *
+ *  Runs several Pythia8 instances in generator threads.
+ *  Every instance has its own random seed and generates its share of
+ *  the events into a ring of event records, two batches long.
+ *  Events are taken from the generators in round-robin order,
+ *  so that the output does not depend on the thread timing.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesPythia8Driver.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+#include <time.h>
+
+#include "Pythia.h"
+
+#include "TMath.h"
+#include "TMutex.h"
+#include "TThread.h"
+#include "TString.h"
+#include "TCondition.h"
+#include "TObjArray.h"
+#include "TStopwatch.h"
+#include "TLorentzVector.h"
+
+#include "classes/DelphesClasses.h"
+#include "classes/DelphesFactory.h"
+#include "classes/DelphesPDGTable.h"
+
+#include "ExRootAnalysis/ExRootTreeBranch.h"
+
+using namespace std;
+
+static const Int_t kDefaultSeed = 19780503;
+static const Int_t kMaxSeed = 900000000;
+
+//---------------------------------------------------------------------------
+
+DelphesPythia8Driver::DelphesPythia8Driver(const char *cardName, Int_t numberOfGenerators, Int_t batchSize) :
+  fCurrent(0), fBatchSize(batchSize), fNumberOfEvents(0), fTimesAllowErrors(0),
+  fMutex(0), fCondition(0), fStop(kFALSE), fRecord(0)
+{
+  stringstream message;
+  Generator *generator;
+  Pythia8::Pythia *pythia;
+  Int_t i, seed;
+
+  if(numberOfGenerators < 1) numberOfGenerators = 1;
+  if(fBatchSize < 1) fBatchSize = 1;
+
+  TThread::Initialize();
+
+  fMutex = new TMutex;
+  fCondition = new TCondition(fMutex);
+
+  fPDG = DelphesPDGTable::Instance();
+
+  seed = kDefaultSeed;
+
+  // the instances are initialized one after the other in this thread
+  for(i = 0; i < numberOfGenerators; ++i)
+  {
+    pythia = new Pythia8::Pythia;
+
+    // Read in commands from configuration file
+    if(!pythia->readFile(cardName))
+    {
+      delete pythia;
+      message << "can't read Pythia8 card " << cardName;
+      throw runtime_error(message.str());
+    }
+
+    if(i == 0)
+    {
+      // Extract settings to be used in the main program
+      fNumberOfEvents = pythia->mode("Main:numberOfEvents");
+      fTimesAllowErrors = pythia->mode("Main:timesAllowErrors");
+
+      if(numberOfGenerators > 1 && pythia->mode("Beams:frameType") == 4)
+      {
+        delete pythia;
+        throw runtime_error("generator threads can't share a Les Houches Event File");
+      }
+
+      if(pythia->flag("Random:setSeed"))
+      {
+        seed = pythia->mode("Random:seed");
+        // a negative seed is taken from the time by Pythia8,
+        // this would give the same seed to all instances
+        if(seed < 0) seed = time(0) % kMaxSeed;
+        else if(seed == 0) seed = kDefaultSeed;
+      }
+    }
+
+    if(numberOfGenerators > 1)
+    {
+      pythia->readString("Random:setSeed = on");
+      pythia->readString(Form("Random:seed = %d", (seed + i) % kMaxSeed + 1));
+    }
+
+    pythia->init();
+
+    generator = new Generator;
+    generator->driver = this;
+    generator->pythia = pythia;
+    generator->thread = 0;
+    generator->records.resize(2*fBatchSize);
+    generator->numberOfEvents = fNumberOfEvents/numberOfGenerators + (i < fNumberOfEvents%numberOfGenerators ? 1 : 0);
+    generator->errors = 0;
+    generator->produced = generator->releasedLocal = 0;
+    generator->published = generator->released = 0;
+    generator->end = kFALSE;
+    generator->consumed = generator->available = 0;
+
+    fGenerators.push_back(generator);
+  }
+}
+
+//---------------------------------------------------------------------------
+
+DelphesPythia8Driver::~DelphesPythia8Driver()
+{
+  vector< Generator * >::iterator itGenerators;
+
+  Stop();
+
+  for(itGenerators = fGenerators.begin(); itGenerators != fGenerators.end(); ++itGenerators)
+  {
+    delete (*itGenerators)->pythia;
+    delete *itGenerators;
+  }
+
+  delete fCondition;
+  delete fMutex;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesPythia8Driver::Start()
+{
+  vector< Generator * >::iterator itGenerators;
+  Generator *generator;
+  Int_t i;
+
+  fStop = kFALSE;
+
+  for(itGenerators = fGenerators.begin(), i = 0; itGenerators != fGenerators.end(); ++itGenerators, ++i)
+  {
+    generator = *itGenerators;
+    generator->thread = new TThread(Form("DelphesGenerator%d", i), &DelphesPythia8Driver::Run, generator);
+    generator->thread->Run();
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesPythia8Driver::Stop()
+{
+  vector< Generator * >::iterator itGenerators;
+  Generator *generator;
+
+  fMutex->Lock();
+  fStop = kTRUE;
+  fCondition->Broadcast();
+  fMutex->UnLock();
+
+  for(itGenerators = fGenerators.begin(); itGenerators != fGenerators.end(); ++itGenerators)
+  {
+    generator = *itGenerators;
+    if(!generator->thread) continue;
+
+    generator->thread->Join();
+    delete generator->thread;
+    generator->thread = 0;
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void *DelphesPythia8Driver::Run(void *arg)
+{
+  Generator *generator = static_cast<Generator *>(arg);
+  DelphesPythia8Driver *driver = generator->driver;
+
+  driver->Generate(generator);
+
+  driver->fMutex->Lock();
+  generator->published = generator->produced;
+  generator->end = kTRUE;
+  driver->fCondition->Broadcast();
+  driver->fMutex->UnLock();
+
+  return 0;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesPythia8Driver::Generate(Generator *generator)
+{
+  Long64_t size = generator->records.size();
+  Pythia8::Pythia *pythia = generator->pythia;
+
+  while(generator->produced < generator->numberOfEvents)
+  {
+    // all records of the ring are still in use, hand over what has been generated
+    if(generator->produced - generator->releasedLocal >= size)
+    {
+      fMutex->Lock();
+      generator->published = generator->produced;
+      fCondition->Broadcast();
+      while(!fStop && generator->produced - generator->released >= size) fCondition->Wait();
+      generator->releasedLocal = generator->released;
+      fMutex->UnLock();
+    }
+
+    if(fStop) break;
+
+    if(!pythia->next())
+    {
+      // If failure because reached end of file then exit event loop
+      if(pythia->info.atEndOfFile())
+      {
+        cerr << "Aborted since reached end of Les Houches Event File" << endl;
+        break;
+      }
+
+      // First few failures write off as "acceptable" errors, then quit
+      if(++generator->errors < fTimesAllowErrors) continue;
+      cerr << "Event generation aborted prematurely, owing to error!" << endl;
+      break;
+    }
+
+    Fill(pythia, generator->records[generator->produced % size]);
+
+    ++generator->produced;
+
+    if(generator->produced % fBatchSize == 0)
+    {
+      fMutex->Lock();
+      generator->published = generator->produced;
+      generator->releasedLocal = generator->released;
+      fCondition->Broadcast();
+      fMutex->UnLock();
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesPythia8Driver::Fill(Pythia8::Pythia *pythia, Record &record)
+{
+  Int_t i, number;
+  Particle *particle;
+
+  record.processID = pythia->info.code();
+  record.weight = pythia->info.weight();
+  record.scale = pythia->info.QRen();
+  record.alphaQED = pythia->info.alphaEM();
+  record.alphaQCD = pythia->info.alphaS();
+
+  record.id1 = pythia->info.id1();
+  record.id2 = pythia->info.id2();
+  record.x1 = pythia->info.x1();
+  record.x2 = pythia->info.x2();
+  record.scalePDF = pythia->info.QFac();
+  record.pdf1 = pythia->info.pdf1();
+  record.pdf2 = pythia->info.pdf2();
+
+  // the particle vector keeps its memory from one event to the next
+  number = pythia->event.size();
+  record.particles.resize(number);
+
+  for(i = 0; i < number; ++i)
+  {
+    Pythia8::Particle &source = pythia->event[i];
+    particle = &record.particles[i];
+
+    particle->pid = source.id();
+    particle->status = pythia->event.statusHepMC(i);
+
+    particle->m1 = source.mother1() - 1;
+    particle->m2 = source.mother2() - 1;
+
+    particle->d1 = source.daughter1() - 1;
+    particle->d2 = source.daughter2() - 1;
+
+    particle->px = source.px(); particle->py = source.py(); particle->pz = source.pz();
+    particle->e = source.e(); particle->mass = source.m();
+
+    particle->x = source.xProd(); particle->y = source.yProd();
+    particle->z = source.zProd(); particle->t = source.tProd();
+  }
+}
+
+//---------------------------------------------------------------------------
+
+Bool_t DelphesPythia8Driver::Next(Generator *generator)
+{
+  // the previous record is released together with its batch
+  if(generator->consumed == generator->available || generator->consumed % fBatchSize == 0)
+  {
+    fMutex->Lock();
+    generator->released = generator->consumed;
+    fCondition->Broadcast();
+    while(generator->published == generator->consumed && !generator->end) fCondition->Wait();
+    generator->available = generator->published;
+    fMutex->UnLock();
+  }
+
+  if(generator->consumed == generator->available) return kFALSE;
+
+  fRecord = &generator->records[generator->consumed % generator->records.size()];
+  ++generator->consumed;
+
+  return kTRUE;
+}
+
+//---------------------------------------------------------------------------
+
+Bool_t DelphesPythia8Driver::ReadEvent()
+{
+  Int_t i, numberOfGenerators = fGenerators.size();
+
+  // generators that are done are skipped
+  for(i = 0; i < numberOfGenerators; ++i)
+  {
+    if(Next(fGenerators[fCurrent]))
+    {
+      fCurrent = (fCurrent + 1) % numberOfGenerators;
+      return kTRUE;
+    }
+    fCurrent = (fCurrent + 1) % numberOfGenerators;
+  }
+
+  return kFALSE;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesPythia8Driver::AnalyzeEvent(ExRootTreeBranch *branch, Long64_t eventNumber,
+  TStopwatch *readStopWatch, TStopwatch *procStopWatch)
+{
+  HepMCEvent *element;
+
+  element = static_cast<HepMCEvent *>(branch->NewEntry());
+
+  element->Number = eventNumber;
+
+  element->ProcessID = fRecord->processID;
+  element->MPI = 1;
+  element->Weight = fRecord->weight;
+  element->Scale = fRecord->scale;
+  element->AlphaQED = fRecord->alphaQED;
+  element->AlphaQCD = fRecord->alphaQCD;
+
+  element->ID1 = fRecord->id1;
+  element->ID2 = fRecord->id2;
+  element->X1 = fRecord->x1;
+  element->X2 = fRecord->x2;
+  element->ScalePDF = fRecord->scalePDF;
+  element->PDF1 = fRecord->pdf1;
+  element->PDF2 = fRecord->pdf2;
+
+  element->ReadTime = readStopWatch->RealTime();
+  element->ProcTime = procStopWatch->RealTime();
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesPythia8Driver::AnalyzeParticles(DelphesFactory *factory,
+  TObjArray *allParticleOutputArray,
+  TObjArray *stableParticleOutputArray,
+  TObjArray *partonOutputArray)
+{
+  vector< Particle >::const_iterator itParticles;
+  const Particle *particle;
+  Candidate *candidate;
+  const DelphesPDGProperties *pdgProperties;
+  Int_t pdgCode;
+  Bool_t all, stable, parton;
+
+  // mothers and daughters are indices in the array of all particles
+  all = (allParticleOutputArray != 0);
+
+  for(itParticles = fRecord->particles.begin(); itParticles != fRecord->particles.end(); ++itParticles)
+  {
+    particle = &(*itParticles);
+
+    pdgProperties = &fPDG->GetProperties(particle->pid);
+    pdgCode = TMath::Abs(particle->pid);
+
+    stable = pdgProperties->known && particle->status == 1;
+    parton = pdgProperties->known && !stable && (pdgCode <= 5 || pdgCode == 21 || pdgCode == 15);
+
+    // arrays that no module reads are not filled
+    if(!all && !(stable && stableParticleOutputArray) && !(parton && partonOutputArray)) continue;
+
+    candidate = factory->NewCandidate();
+
+    candidate->PID = particle->pid;
+
+    candidate->Status = particle->status;
+
+    candidate->M1 = all ? particle->m1 : -1;
+    candidate->M2 = all ? particle->m2 : -1;
+
+    candidate->D1 = all ? particle->d1 : -1;
+    candidate->D2 = all ? particle->d2 : -1;
+
+    candidate->Charge = pdgProperties->charge;
+    candidate->Mass = particle->mass;
+
+    candidate->Momentum.SetPxPyPzE(particle->px, particle->py, particle->pz, particle->e);
+
+    candidate->Position.SetXYZT(particle->x, particle->y, particle->z, particle->t);
+
+    if(all) allParticleOutputArray->Add(candidate);
+
+    if(stable && stableParticleOutputArray)
+    {
+      stableParticleOutputArray->Add(candidate);
+    }
+    else if(parton && partonOutputArray)
+    {
+      partonOutputArray->Add(candidate);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesPythia8Driver::PrintStatistics()
+{
+  vector< Generator * >::iterator itGenerators;
+
+  for(itGenerators = fGenerators.begin(); itGenerators != fGenerators.end(); ++itGenerators)
+  {
+    (*itGenerators)->pythia->statistics();
+  }
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,129 @@
+#ifndef DelphesPythia8Driver_h
+#define DelphesPythia8Driver_h
+
+/** \class DelphesPythia8Driver
+ *
+ *  Runs several Pythia8 instances in generator threads.
+ *  Every instance has its own random seed and generates its share of
+ *  the events into a ring of event records, two batches long.
+ *  Events are taken from the generators in round-robin order,
+ *  so that the output does not depend on the thread timing.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <string>
+#include <vector>
+
+class TThread;
+class TMutex;
+class TCondition;
+class TObjArray;
+class TStopwatch;
+class DelphesPDGTable;
+class ExRootTreeBranch;
+class DelphesFactory;
+
+namespace Pythia8
+{
+  class Pythia;
+}
+
+class DelphesPythia8Driver
+{
+public:
+
+  // reads the Pythia8 card and initializes numberOfGenerators instances,
+  // with more than one instance the random seeds are set to seed + k
+  DelphesPythia8Driver(const char *cardName, Int_t numberOfGenerators, Int_t batchSize = 16);
+  ~DelphesPythia8Driver();
+
+  // Main:numberOfEvents of the card
+  Long64_t GetNumberOfEvents() const { return fNumberOfEvents; }
+
+  // starts the generator threads
+  void Start();
+
+  // stops the generator threads
+  void Stop();
+
+  // moves to the next event, returns false when all generators are done
+  Bool_t ReadEvent();
+
+  void AnalyzeEvent(ExRootTreeBranch *branch, Long64_t eventNumber,
+    TStopwatch *readStopWatch, TStopwatch *procStopWatch);
+
+  void AnalyzeParticles(DelphesFactory *factory,
+    TObjArray *allParticleOutputArray,
+    TObjArray *stableParticleOutputArray,
+    TObjArray *partonOutputArray);
+
+  void PrintStatistics();
+
+private:
+
+  struct Particle
+  {
+    Int_t pid, status;
+    Int_t m1, m2, d1, d2;
+    Double_t px, py, pz, e, mass;
+    Double_t x, y, z, t;
+  };
+
+  struct Record
+  {
+    Int_t processID, id1, id2;
+    Double_t weight, scale, alphaQED, alphaQCD;
+    Double_t x1, x2, scalePDF, pdf1, pdf2;
+    std::vector< Particle > particles;
+  };
+
+  struct Generator
+  {
+    DelphesPythia8Driver *driver;
+    Pythia8::Pythia *pythia;
+    TThread *thread;
+
+    std::vector< Record > records;
+
+    Long64_t numberOfEvents, errors;
+
+    // used by the generator thread only
+    Long64_t produced, releasedLocal;
+
+    // shared between the threads
+    Long64_t published, released;
+    Bool_t end;
+
+    // used by the calling thread only
+    Long64_t consumed, available;
+  };
+
+  static void *Run(void *arg);
+
+  void Generate(Generator *generator);
+  void Fill(Pythia8::Pythia *pythia, Record &record);
+
+  Bool_t Next(Generator *generator);
+
+  std::vector< Generator * > fGenerators;
+  Int_t fCurrent;
+
+  Int_t fBatchSize;
+  Long64_t fNumberOfEvents, fTimesAllowErrors;
+
+  TMutex *fMutex;
+  TCondition *fCondition;
+
+  Bool_t fStop;
+
+  Record *fRecord;
+
+  const DelphesPDGTable *fPDG;
+};
+
+#endif // DelphesPythia8Driver_h
@@ -0,0 +1,111 @@
+
+/** \class DelphesRandom
+ *
+ *  Counter-based random number generator.
+ *  The n-th number of a sequence is a hash of the key and of n,
+ *  the key is built from the random seed, the event number
+ *  and the name of the stream (module), so that every module
+ *  gets an independent sequence for every event.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesRandom.h"
+
+using namespace std;
+
+static const ULong64_t kGoldenGamma = 0x9E3779B97F4A7C15ULL;
+
+//------------------------------------------------------------------------------
+
+static ULong64_t Mix(ULong64_t z)
+{
+  // splitmix64 finalizer
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+//------------------------------------------------------------------------------
+
+DelphesRandom::DelphesRandom(const char *stream, UInt_t seed) :
+  TRandom(seed), fStream(0), fEventNumber(0), fKey(0), fCounter(0)
+{
+  SetName("DelphesRandom");
+  SetTitle("Counter-based random number generator");
+  SetStream(stream);
+  SetSeed(seed);
+}
+
+//------------------------------------------------------------------------------
+
+DelphesRandom::~DelphesRandom()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesRandom::SetSeed(UInt_t seed)
+{
+  fSeed = seed;
+  SetEvent(fEventNumber);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesRandom::SetStream(const char *stream)
+{
+  // 64-bit FNV-1a hash of the stream name
+  fStream = 0xCBF29CE484222325ULL;
+  while(stream && *stream)
+  {
+    fStream ^= (unsigned char)(*stream++);
+    fStream *= 0x100000001B3ULL;
+  }
+  SetEvent(fEventNumber);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesRandom::SetEvent(Long64_t eventNumber)
+{
+  fEventNumber = eventNumber;
+  fKey = Mix(Mix(ULong64_t(fSeed) + kGoldenGamma) ^ fStream);
+  fKey = Mix(fKey + ULong64_t(eventNumber)*kGoldenGamma);
+  fCounter = 0;
+}
+
+//------------------------------------------------------------------------------
+
+ULong64_t DelphesRandom::Next()
+{
+  return Mix(fKey + (++fCounter)*kGoldenGamma);
+}
+
+//------------------------------------------------------------------------------
+
+Double_t DelphesRandom::Rndm(Int_t)
+{
+  // 53 random bits, uniform in the open interval (0, 1)
+  return (Double_t(Next() >> 11) + 0.5) * (1.0/9007199254740992.0);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesRandom::RndmArray(Int_t n, Float_t *array)
+{
+  Int_t i;
+  for(i = 0; i < n; ++i) array[i] = Float_t(Rndm());
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesRandom::RndmArray(Int_t n, Double_t *array)
+{
+  Int_t i;
+  for(i = 0; i < n; ++i) array[i] = Rndm();
+}
+
+//------------------------------------------------------------------------------
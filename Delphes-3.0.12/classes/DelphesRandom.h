@@ -0,0 +1,52 @@
+#ifndef DelphesRandom_h
+#define DelphesRandom_h
+
+/** \class DelphesRandom
+ *
+ *  Counter-based random number generator.
+ *  The n-th number of a sequence is a hash of the key and of n,
+ *  the key is built from the random seed, the event number
+ *  and the name of the stream (module), so that every module
+ *  gets an independent sequence for every event.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "TRandom.h"
+
+class DelphesRandom: public TRandom
+{
+public:
+
+  DelphesRandom(const char *stream = "", UInt_t seed = 0);
+  ~DelphesRandom();
+
+  virtual void SetSeed(UInt_t seed = 0);
+
+  void SetStream(const char *stream);
+
+  // starts the sequence of the given event
+  void SetEvent(Long64_t eventNumber);
+
+  Long64_t GetEvent() const { return fEventNumber; }
+  ULong64_t GetCounter() const { return fCounter; }
+
+  virtual Double_t Rndm(Int_t i = 0);
+  virtual void RndmArray(Int_t n, Float_t *array);
+  virtual void RndmArray(Int_t n, Double_t *array);
+
+private:
+
+  ULong64_t Next();
+
+  ULong64_t fStream; // hash of the stream name
+  Long64_t fEventNumber;
+  ULong64_t fKey;
+  ULong64_t fCounter;
+
+  ClassDef(DelphesRandom, 1)
+};
+
+#endif /* DelphesRandom_h */
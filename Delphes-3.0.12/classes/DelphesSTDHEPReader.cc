@@ -20,17 +20,17 @@
 
 #include <stdio.h>
 #include <errno.h>
+#include <string.h>
 #include <rpc/types.h>
 #include <rpc/xdr.h>
 
 #include "TObjArray.h"
 #include "TStopwatch.h"
-#include "TDatabasePDG.h"
-#include "TParticlePDG.h"
 #include "TLorentzVector.h"
 
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
+#include "classes/DelphesPDGTable.h"
 
 #include "ExRootAnalysis/ExRootTreeBranch.h"
 
@@ -40,13 +40,62 @@ static const int kBufferSize  = 1000000;
 
 //---------------------------------------------------------------------------
 
+// XDR arrays are big-endian, the byte swaps are written as plain shifts
+// that compilers turn into single byte-swap instructions
+
+static inline unsigned int SwapBytes(unsigned int value)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return value;
+#else
+  return (value >> 24) | ((value >> 8) & 0xFF00U) | ((value << 8) & 0xFF0000U) | (value << 24);
+#endif
+}
+
+static inline unsigned long long SwapBytes(unsigned long long value)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return value;
+#else
+  return (unsigned long long)(SwapBytes((unsigned int)(value))) << 32 | SwapBytes((unsigned int)(value >> 32));
+#endif
+}
+
+static void DecodeInt(const char *source, int *destination, int size)
+{
+  unsigned int value;
+  int i;
+
+  for(i = 0; i < size; ++i)
+  {
+    memcpy(&value, source + 4*i, 4);
+    value = SwapBytes(value);
+    memcpy(destination + i, &value, 4);
+  }
+}
+
+static void DecodeDbl(const char *source, double *destination, int size)
+{
+  unsigned long long value;
+  int i;
+
+  for(i = 0; i < size; ++i)
+  {
+    memcpy(&value, source + 8*i, 8);
+    value = SwapBytes(value);
+    memcpy(destination + i, &value, 8);
+  }
+}
+
+//---------------------------------------------------------------------------
+
 DelphesSTDHEPReader::DelphesSTDHEPReader() :
   fInputFile(0), fInputXDR(0), fBuffer(0), fPDG(0), fBlockType(-1)
 {
   fInputXDR = new XDR;
   fBuffer = new char[kBufferSize*96 + 24];
 
-  fPDG = TDatabasePDG::Instance();
+  fPDG = DelphesPDGTable::Instance();
 }
 
 //---------------------------------------------------------------------------
@@ -344,6 +393,20 @@ void DelphesSTDHEPReader::ReadSTDHEP()
     throw runtime_error("Inconsistent size of arrays. File is probably corrupted.");
   }
 
+  // convert the whole block at once instead of field by field
+  if(fIntegers.size() < size_t(6*fEventSize)) fIntegers.resize(6*fEventSize);
+  if(fDoubles.size() < size_t(9*fEventSize)) fDoubles.resize(9*fEventSize);
+
+  if(fEventSize > 0)
+  {
+    DecodeInt(fBuffer + 4*1, &fIntegers[0], fEventSize);
+    DecodeInt(fBuffer + 4*2 + 4*1*fEventSize, &fIntegers[fEventSize], fEventSize);
+    DecodeInt(fBuffer + 4*3 + 4*2*fEventSize, &fIntegers[2*fEventSize], 2*fEventSize);
+    DecodeInt(fBuffer + 4*4 + 4*4*fEventSize, &fIntegers[4*fEventSize], 2*fEventSize);
+    DecodeDbl(fBuffer + 4*5 + 4*6*fEventSize, &fDoubles[0], 5*fEventSize);
+    DecodeDbl(fBuffer + 4*6 + 4*16*fEventSize, &fDoubles[5*fEventSize], 4*fEventSize);
+  }
+
   fWeight = 1.0;
   fAlphaQED = 0.0;
   fAlphaQCD = 0.0;
@@ -409,72 +472,70 @@ void DelphesSTDHEPReader::AnalyzeParticles(DelphesFactory *factory,
   TObjArray *partonOutputArray)
 {
   Candidate *candidate;
-  TParticlePDG *pdgParticle;
+  const DelphesPDGProperties *pdgProperties;
   int pdgCode;
+  bool all, stable, parton;
 
   int number;
-  int pid, status, m1, m2, d1, d2;
-  double px, py, pz, e, mass;
-  double x, y, z, t;
-
-  XDR bufferXDR[6];
-  xdrmem_create(&bufferXDR[0], fBuffer + 4*1, 4*fEventSize, XDR_DECODE);
-  xdrmem_create(&bufferXDR[1], fBuffer + 4*2 + 4*1*fEventSize, 4*fEventSize, XDR_DECODE);
-  xdrmem_create(&bufferXDR[2], fBuffer + 4*3 + 4*2*fEventSize, 8*fEventSize, XDR_DECODE);
-  xdrmem_create(&bufferXDR[3], fBuffer + 4*4 + 4*4*fEventSize, 8*fEventSize, XDR_DECODE);
-  xdrmem_create(&bufferXDR[4], fBuffer + 4*5 + 4*6*fEventSize, 40*fEventSize, XDR_DECODE);
-  xdrmem_create(&bufferXDR[5], fBuffer + 4*6 + 4*16*fEventSize, 32*fEventSize, XDR_DECODE);
+  int pid, status;
+  const int *statuses, *pids, *mothers, *daughters;
+  const double *momentum, *position;
+
+  if(fEventSize <= 0) return;
+
+  statuses = &fIntegers[0];
+  pids = statuses + fEventSize;
+  mothers = pids + fEventSize;
+  daughters = mothers + 2*fEventSize;
+
+  momentum = &fDoubles[0];
+  position = momentum + 5*fEventSize;
+
+  // mothers and daughters are indices in the array of all particles
+  all = (allParticleOutputArray != 0);
 
   for(number = 0; number < fEventSize; ++number)
   {
-    xdr_int(&bufferXDR[0], &status);
-    xdr_int(&bufferXDR[1], &pid);
-    xdr_int(&bufferXDR[2], &m1);
-    xdr_int(&bufferXDR[2], &m2);
-    xdr_int(&bufferXDR[3], &d1);
-    xdr_int(&bufferXDR[3], &d2);
-
-    xdr_double(&bufferXDR[4], &px);
-    xdr_double(&bufferXDR[4], &py);
-    xdr_double(&bufferXDR[4], &pz);
-    xdr_double(&bufferXDR[4], &e);
-    xdr_double(&bufferXDR[4], &mass);
-
-    xdr_double(&bufferXDR[5], &x);
-    xdr_double(&bufferXDR[5], &y);
-    xdr_double(&bufferXDR[5], &z);
-    xdr_double(&bufferXDR[5], &t);
+    status = statuses[number];
+    pid = pids[number];
+
+    pdgProperties = &fPDG->GetProperties(pid);
+    pdgCode = TMath::Abs(pid);
+
+    stable = pdgProperties->known && status == 1 && pdgProperties->stable;
+    parton = pdgProperties->known && !stable && (pdgCode <= 5 || pdgCode == 21 || pdgCode == 15);
+
+    // arrays that no module reads are not filled
+    if(!all && !(stable && stableParticleOutputArray) && !(parton && partonOutputArray)) continue;
 
     candidate = factory->NewCandidate();
 
     candidate->PID = pid;
-    pdgCode = TMath::Abs(candidate->PID);
 
     candidate->Status = status;
 
-    candidate->M1 = m1 - 1;
-    candidate->M2 = m2 - 1;
-
-    candidate->D1 = d1 - 1;
-    candidate->D2 = d2 - 1;
+    candidate->M1 = all ? mothers[2*number] - 1 : -1;
+    candidate->M2 = all ? mothers[2*number + 1] - 1 : -1;
 
-    pdgParticle = fPDG->GetParticle(pid);
-    candidate->Charge = pdgParticle ? int(pdgParticle->Charge()/3.0) : -999;
-    candidate->Mass = mass;
+    candidate->D1 = all ? daughters[2*number] - 1 : -1;
+    candidate->D2 = all ? daughters[2*number + 1] - 1 : -1;
 
-    candidate->Momentum.SetPxPyPzE(px, py, pz, e);
+    candidate->Charge = pdgProperties->charge;
+    candidate->Mass = momentum[5*number + 4];
 
-    candidate->Position.SetXYZT(x, y, z, t);
+    candidate->Momentum.SetPxPyPzE(momentum[5*number], momentum[5*number + 1],
+      momentum[5*number + 2], momentum[5*number + 3]);
 
-    allParticleOutputArray->Add(candidate);
+    candidate->Position.SetXYZT(position[4*number], position[4*number + 1],
+      position[4*number + 2], position[4*number + 3]);
 
-    if(!pdgParticle) continue;
+    if(all) allParticleOutputArray->Add(candidate);
 
-    if(status == 1 && pdgParticle->Stable())
+    if(stable && stableParticleOutputArray)
     {
       stableParticleOutputArray->Add(candidate);
     }
-    else if(pdgCode <= 5 || pdgCode == 21 || pdgCode == 15)
+    else if(parton && partonOutputArray)
     {
       partonOutputArray->Add(candidate);
     }
@@ -14,13 +14,15 @@
  *
  */
 
+#include <vector>
+
 #include <stdio.h>
 #include <rpc/types.h>
 #include <rpc/xdr.h>
 
 class TObjArray;
 class TStopwatch;
-class TDatabasePDG;
+class DelphesPDGTable;
 class ExRootTreeBranch;
 class DelphesFactory;
 
@@ -78,7 +80,12 @@ private:
 
   char *fBuffer;
 
-  TDatabasePDG *fPDG;
+  // HEPEVT arrays of the current event converted to the native byte order:
+  // isthep, idhep, jmohep and jdahep in fIntegers, phep and vhep in fDoubles
+  std::vector< int > fIntegers;
+  std::vector< double > fDoubles;
+
+  const DelphesPDGTable *fPDG;
 
   u_int fEntries;
   int fBlockType, fEventNumber, fEventSize;
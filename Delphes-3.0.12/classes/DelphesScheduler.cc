@@ -0,0 +1,244 @@
+
+/** \class DelphesScheduler
+ *
+ *  Runs the modules of one event on a pool of threads.
+ *  The order of execution is given by a dependency graph
+ *  built from the arrays imported, updated and exported by
+ *  the modules, independent modules run concurrently.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "classes/DelphesScheduler.h"
+#include "classes/DelphesModule.h"
+
+#include "TMutex.h"
+#include "TThread.h"
+#include "TString.h"
+#include "TObjArray.h"
+#include "TCondition.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+#include <set>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+static Bool_t Intersect(const set< TObjArray * > &a, const set< TObjArray * > &b)
+{
+  set< TObjArray * >::const_iterator itA = a.begin(), itB = b.begin();
+
+  while(itA != a.end() && itB != b.end())
+  {
+    if(*itA < *itB) ++itA;
+    else if(*itB < *itA) ++itB;
+    else return kTRUE;
+  }
+
+  return kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesScheduler::DelphesScheduler(Int_t numberOfThreads) :
+  fRemaining(0), fStop(kFALSE), fMutex(0), fCondition(0)
+{
+  Int_t i;
+  TThread *thread;
+
+  TThread::Initialize();
+
+  fMutex = new TMutex;
+  fCondition = new TCondition(fMutex);
+
+  // the calling thread executes modules as well
+  for(i = 1; i < numberOfThreads; ++i)
+  {
+    thread = new TThread(Form("DelphesScheduler%d", i), &DelphesScheduler::Run, this);
+    fThreads.push_back(thread);
+    thread->Run();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+DelphesScheduler::~DelphesScheduler()
+{
+  vector< TThread * >::iterator itThreads;
+
+  fMutex->Lock();
+  fStop = kTRUE;
+  fCondition->Broadcast();
+  fMutex->UnLock();
+
+  for(itThreads = fThreads.begin(); itThreads != fThreads.end(); ++itThreads)
+  {
+    (*itThreads)->Join();
+    delete (*itThreads);
+  }
+
+  delete fCondition;
+  delete fMutex;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesScheduler::Build(const vector< ExRootTask * > &modules)
+{
+  vector< ExRootTask * >::size_type i, j, size = modules.size();
+  DelphesModule *first, *second;
+  Bool_t dependent;
+  Node node;
+
+  fNodes.clear();
+
+  node.numberOfPredecessors = 0;
+  node.pending = 0;
+
+  for(i = 0; i < size; ++i)
+  {
+    node.task = modules[i];
+    fNodes.push_back(node);
+  }
+
+  // a module depends on an earlier module in the ExecutionPath if it
+  // reads an array produced by that module or if one of the two modules
+  // modifies the candidates of an array used by the other one,
+  // modules that are not DelphesModules keep their original order
+  for(j = 0; j < size; ++j)
+  {
+    for(i = 0; i < j; ++i)
+    {
+      if(!modules[i]->InheritsFrom(DelphesModule::Class()) ||
+         !modules[j]->InheritsFrom(DelphesModule::Class()))
+      {
+        dependent = kTRUE;
+      }
+      else
+      {
+        first = static_cast<DelphesModule *>(modules[i]);
+        second = static_cast<DelphesModule *>(modules[j]);
+
+        dependent =
+          Intersect(first->GetExportedArrays(), second->GetImportedArrays()) ||
+          Intersect(first->GetUpdatedArrays(), second->GetImportedArrays()) ||
+          Intersect(first->GetImportedArrays(), second->GetUpdatedArrays());
+      }
+
+      if(dependent)
+      {
+        fNodes[i].successors.push_back(j);
+        ++fNodes[j].numberOfPredecessors;
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesScheduler::Process()
+{
+  vector< Node >::size_type i, size = fNodes.size();
+  Int_t index;
+  string error;
+
+  fMutex->Lock();
+
+  fError.clear();
+  fRemaining = size;
+  for(i = 0; i < size; ++i)
+  {
+    fNodes[i].pending = fNodes[i].numberOfPredecessors;
+    if(fNodes[i].pending == 0) fQueue.push_back(i);
+  }
+  fCondition->Broadcast();
+
+  while(fRemaining > 0)
+  {
+    if(fQueue.empty())
+    {
+      fCondition->Wait();
+      continue;
+    }
+
+    index = fQueue.front();
+    fQueue.pop_front();
+
+    fMutex->UnLock();
+    Execute(index);
+    fMutex->Lock();
+  }
+
+  error = fError;
+
+  fMutex->UnLock();
+
+  if(!error.empty()) throw runtime_error(error);
+}
+
+//------------------------------------------------------------------------------
+
+void *DelphesScheduler::Run(void *arg)
+{
+  DelphesScheduler *scheduler = static_cast<DelphesScheduler *>(arg);
+  Int_t index;
+
+  scheduler->fMutex->Lock();
+
+  while(true)
+  {
+    while(!scheduler->fStop && scheduler->fQueue.empty()) scheduler->fCondition->Wait();
+    if(scheduler->fStop) break;
+
+    index = scheduler->fQueue.front();
+    scheduler->fQueue.pop_front();
+
+    scheduler->fMutex->UnLock();
+    scheduler->Execute(index);
+    scheduler->fMutex->Lock();
+  }
+
+  scheduler->fMutex->UnLock();
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesScheduler::Execute(Int_t index)
+{
+  Node &node = fNodes[index];
+  vector< Int_t >::iterator itSuccessors;
+  string error;
+
+  try
+  {
+    if(node.task->IsActive()) node.task->Process();
+  }
+  catch(runtime_error &e)
+  {
+    error = e.what();
+  }
+
+  fMutex->Lock();
+
+  if(!error.empty() && fError.empty()) fError = error;
+
+  // successors become ready when all their predecessors are done
+  for(itSuccessors = node.successors.begin(); itSuccessors != node.successors.end(); ++itSuccessors)
+  {
+    if(--fNodes[*itSuccessors].pending == 0) fQueue.push_back(*itSuccessors);
+  }
+
+  --fRemaining;
+  fCondition->Broadcast();
+
+  fMutex->UnLock();
+}
+
+//------------------------------------------------------------------------------
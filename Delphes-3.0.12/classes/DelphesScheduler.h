@@ -0,0 +1,68 @@
+#ifndef DelphesScheduler_h
+#define DelphesScheduler_h
+
+/** \class DelphesScheduler
+ *
+ *  Runs the modules of one event on a pool of threads.
+ *  The order of execution is given by a dependency graph
+ *  built from the arrays imported, updated and exported by
+ *  the modules, independent modules run concurrently.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <deque>
+#include <string>
+#include <vector>
+
+class TThread;
+class TMutex;
+class TCondition;
+
+class ExRootTask;
+
+class DelphesScheduler
+{
+public:
+
+  DelphesScheduler(Int_t numberOfThreads);
+  ~DelphesScheduler();
+
+  // modules must be given in the order of the ExecutionPath
+  void Build(const std::vector< ExRootTask * > &modules);
+
+  void Process();
+
+private:
+
+  struct Node
+  {
+    ExRootTask *task;
+    Int_t numberOfPredecessors;
+    Int_t pending;
+    std::vector< Int_t > successors;
+  };
+
+  static void *Run(void *arg);
+
+  void Execute(Int_t index);
+
+  std::vector< Node > fNodes;
+  std::deque< Int_t > fQueue;
+
+  Int_t fRemaining;
+  Bool_t fStop;
+
+  std::string fError;
+
+  std::vector< TThread * > fThreads;
+
+  TMutex *fMutex;
+  TCondition *fCondition;
+};
+
+#endif /* DelphesScheduler_h */
@@ -19,9 +19,11 @@
 #include <string.h>
 #include <stdio.h>
 #include <errno.h>
+#include <float.h>
 #include <math.h>
 
 #include <iostream>
+#include <string>
 
 using namespace std;
 
@@ -33,10 +35,54 @@ bool DelphesStream::fFirstHugePos = true;
 bool DelphesStream::fFirstHugeNeg = true;
 bool DelphesStream::fFirstZero = true;
 
+// powers of ten that are exactly representable as double
+static const double kPow10[] =
+{
+  1.0E0, 1.0E1, 1.0E2, 1.0E3, 1.0E4, 1.0E5, 1.0E6, 1.0E7,
+  1.0E8, 1.0E9, 1.0E10, 1.0E11, 1.0E12, 1.0E13, 1.0E14, 1.0E15,
+  1.0E16, 1.0E17, 1.0E18, 1.0E19, 1.0E20, 1.0E21, 1.0E22
+};
+
+// x87 extended precision has a 64-bit significand, the powers of ten
+// up to 1.0E27 and all 19-digit mantissas are exactly representable
+#if (defined(__x86_64__) || defined(__i386__)) && LDBL_MANT_DIG == 64
+#define DELPHES_STREAM_EXTENDED
+static const long double kPow10Extended[] =
+{
+  1.0E0L, 1.0E1L, 1.0E2L, 1.0E3L, 1.0E4L, 1.0E5L, 1.0E6L, 1.0E7L,
+  1.0E8L, 1.0E9L, 1.0E10L, 1.0E11L, 1.0E12L, 1.0E13L, 1.0E14L, 1.0E15L,
+  1.0E16L, 1.0E17L, 1.0E18L, 1.0E19L, 1.0E20L, 1.0E21L, 1.0E22L, 1.0E23L,
+  1.0E24L, 1.0E25L, 1.0E26L, 1.0E27L
+};
+#endif
+
+static inline bool IsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool IsDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+static inline const char *FindSpace(const char *p, const char *end)
+{
+  while(p < end && !IsSpace(*p)) ++p;
+  return p;
+}
+
 //------------------------------------------------------------------------------
 
 DelphesStream::DelphesStream(char *buffer) :
-  fBuffer(buffer)
+  fBuffer(buffer), fEnd(buffer + strlen(buffer))
+{
+}
+
+//------------------------------------------------------------------------------
+
+DelphesStream::DelphesStream(const char *begin, const char *end) :
+  fBuffer(begin), fEnd(end)
 {
 }
 
@@ -44,52 +90,215 @@ DelphesStream::DelphesStream(char *buffer) :
 
 bool DelphesStream::ReadDbl(double &value)
 {
-  char *start = fBuffer;
+  return ParseDbl(value) || ReadDblSlow(value);
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesStream::ReadInt(int &value)
+{
+  return ParseInt(value) || ReadIntSlow(value);
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesStream::ParseDbl(double &value)
+{
+  const char *p = fBuffer;
+  unsigned long long mantissa = 0;
+  int digits = 0, exponent = 0, exponentValue = 0;
+  bool negative = false, negativeExponent = false, valid = false;
+  double result;
+
+  while(p < fEnd && IsSpace(*p)) ++p;
+
+  if(p < fEnd && (*p == '+' || *p == '-'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
+
+  // at most 19 significant digits, so that the mantissa fits into 64 bits
+  for(; p < fEnd && IsDigit(*p); ++p)
+  {
+    if(digits == 19) return false;
+    mantissa = mantissa*10 + (*p - '0');
+    if(mantissa > 0) ++digits;
+    valid = true;
+  }
+
+  if(p < fEnd && *p == '.')
+  {
+    for(++p; p < fEnd && IsDigit(*p); ++p)
+    {
+      if(digits == 19) return false;
+      mantissa = mantissa*10 + (*p - '0');
+      if(mantissa > 0) ++digits;
+      --exponent;
+      valid = true;
+    }
+  }
+
+  if(!valid) return false;
+
+  if(p < fEnd && (*p == 'e' || *p == 'E'))
+  {
+    ++p;
+    if(p < fEnd && (*p == '+' || *p == '-'))
+    {
+      negativeExponent = (*p == '-');
+      ++p;
+    }
+    if(p == fEnd || !IsDigit(*p)) return false;
+    for(; p < fEnd && IsDigit(*p); ++p)
+    {
+      exponentValue = exponentValue*10 + (*p - '0');
+      if(exponentValue > 9999) return false;
+    }
+    exponent += negativeExponent ? -exponentValue : exponentValue;
+  }
+
+  // hexadecimal numbers, nan, inf and malformed numbers are left to strtod
+  if(p < fEnd && !IsSpace(*p)) return false;
+
+  if(mantissa == 0)
+  {
+    result = 0.0;
+  }
+  else if(mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22)
+  {
+    // both operands are exact, so the result is correctly rounded
+    result = double(mantissa);
+    result = (exponent < 0) ? result/kPow10[-exponent] : result*kPow10[exponent];
+  }
+#ifdef DELPHES_STREAM_EXTENDED
+  else if(exponent >= -27 && exponent <= 27)
+  {
+    unsigned long long significand;
+    long double extended = (long double)(mantissa);
+    extended = (exponent < 0) ? extended/kPow10Extended[-exponent] : extended*kPow10Extended[exponent];
+
+    // rounding the extended result to double is correct unless
+    // it lies exactly half-way between two doubles
+    memcpy(&significand, &extended, sizeof(significand));
+    if((significand & 0x7FF) == 0x400) return false;
+
+    result = double(extended);
+  }
+#endif
+  else
+  {
+    return false;
+  }
+
+  value = negative ? -result : result;
+  fBuffer = p;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesStream::ParseInt(int &value)
+{
+  const char *p = fBuffer;
+  long long result = 0;
+  int digits = 0;
+  bool negative = false;
+
+  while(p < fEnd && IsSpace(*p)) ++p;
+
+  if(p < fEnd && (*p == '+' || *p == '-'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
+
+  for(; p < fEnd && IsDigit(*p); ++p)
+  {
+    if(digits == 18) return false;
+    result = result*10 + (*p - '0');
+    ++digits;
+  }
+
+  if(digits == 0 || (p < fEnd && !IsSpace(*p))) return false;
+
+  value = long(negative ? -result : result);
+  fBuffer = p;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesStream::ReadDblSlow(double &value)
+{
+  const char *p = fBuffer;
+  const char *buffer;
+  char *end;
+
+  while(p < fEnd && IsSpace(*p)) ++p;
+  string word(p, FindSpace(p, fEnd));
+  buffer = word.c_str();
+
   errno = 0;
-  value = strtod(start, &fBuffer);
+  value = strtod(buffer, &end);
   if(errno == ERANGE)
   {
     if(fFirstHugePos && value == HUGE_VAL)
     {
-      fFirstHugePos = false; 
+      fFirstHugePos = false;
       cout << "** WARNING: too large positive value, return " << value << endl;
     }
     else if(fFirstHugeNeg && value == -HUGE_VAL)
     {
-      fFirstHugeNeg = false; 
+      fFirstHugeNeg = false;
       cout << "** WARNING: too large negative value, return " << value << endl;
     }
     else if(fFirstZero)
     {
-      fFirstZero = false; 
+      fFirstZero = false;
       value = 0.0;
       cout << "** WARNING: too small value, return " << value << endl;
     }
   }
-  return start != fBuffer;
+
+  if(end == buffer) return false;
+
+  fBuffer = p + (end - buffer);
+  return true;
 }
 
 //------------------------------------------------------------------------------
 
-bool DelphesStream::ReadInt(int &value)
+bool DelphesStream::ReadIntSlow(int &value)
 {
-  char *start = fBuffer;
+  const char *p = fBuffer;
+  const char *buffer;
+  char *end;
+
+  while(p < fEnd && IsSpace(*p)) ++p;
+  string word(p, FindSpace(p, fEnd));
+  buffer = word.c_str();
+
   errno = 0;
-  value = strtol(start, &fBuffer, 10);
+  value = strtol(buffer, &end, 10);
   if(errno == ERANGE)
   {
     if(fFirstLongMin && value == LONG_MIN)
     {
-      fFirstLongMin = false; 
+      fFirstLongMin = false;
       cout << "** WARNING: too large positive value, return " << value << endl;
     }
     else if(fFirstLongMax && value == LONG_MAX)
     {
-      fFirstLongMax = false; 
+      fFirstLongMax = false;
       cout << "** WARNING: too large negative value, return " << value << endl;
     }
   }
-  return start != fBuffer;
+
+  if(end == buffer) return false;
+
+  fBuffer = p + (end - buffer);
+  return true;
 }
 
 //------------------------------------------------------------------------------
@@ -20,13 +20,27 @@ public:
 
   DelphesStream(char *buffer);
 
+  // reads numbers from [begin, end), the range does not need to be null-terminated
+  DelphesStream(const char *begin, const char *end);
+
   bool ReadDbl(double &value);
   bool ReadInt(int &value);
 
+  const char *GetPosition() const { return fBuffer; }
+
 private:
 
-  char *fBuffer;
-  
+  // locale independent parsers for the common cases,
+  // return false when the number has to be parsed by strtod or strtol
+  bool ParseDbl(double &value);
+  bool ParseInt(int &value);
+
+  // copies the next word into a null-terminated buffer and parses it with strtod or strtol
+  bool ReadDblSlow(double &value);
+  bool ReadIntSlow(int &value);
+
+  const char *fBuffer, *fEnd;
+
   static bool fFirstLongMin;
   static bool fFirstLongMax;
   static bool fFirstHugePos;
@@ -36,4 +50,3 @@ private:
 
 #endif // DelphesStream_h
 
-
@@ -1,4 +1,6 @@
 #include "classes/DelphesTF2.h"
+#include "TMath.h"
+#include "TRandom.h"
 #include "TString.h"
 #include <stdexcept>
 #include <string>
@@ -44,3 +46,51 @@ Int_t DelphesTF2::DefinedVariable(TString &chaine, Int_t &action)
 }
 
 //------------------------------------------------------------------------------
+
+void DelphesTF2::GetRandom2(Double_t &xrandom, Double_t &yrandom, TRandom *random)
+{
+  Int_t i, j, cell, ncells;
+  Double_t dx, dy, integral, r, ddx, ddy, dxint;
+
+  dx = (fXmax - fXmin)/fNpx;
+  dy = (fYmax - fYmin)/fNpy;
+  ncells = fNpx*fNpy;
+
+  if(fCellIntegral.empty())
+  {
+    fCellIntegral.resize(ncells + 1);
+    fCellIntegral[0] = 0.0;
+    cell = 0;
+    for(j = 0; j < fNpy; ++j)
+    {
+      for(i = 0; i < fNpx; ++i)
+      {
+        integral = Integral(fXmin + i*dx, fXmin + i*dx + dx, fYmin + j*dy, fYmin + j*dy + dy);
+        if(integral < 0.0) integral = -integral;
+        fCellIntegral[cell + 1] = fCellIntegral[cell] + integral;
+        ++cell;
+      }
+    }
+    if(fCellIntegral[ncells] == 0.0)
+    {
+      fCellIntegral.clear();
+      throw runtime_error("Integral of function is zero.");
+    }
+    for(i = 1; i <= ncells; ++i)
+    {
+      fCellIntegral[i] /= fCellIntegral[ncells];
+    }
+  }
+
+  r = random->Rndm();
+  cell = TMath::BinarySearch(ncells, &fCellIntegral[0], r);
+  dxint = fCellIntegral[cell + 1] - fCellIntegral[cell];
+  ddx = dxint > 0.0 ? dx*(r - fCellIntegral[cell])/dxint : 0.0;
+  ddy = dy*random->Rndm();
+  j = cell/fNpx;
+  i = cell%fNpx;
+  xrandom = fXmin + dx*i + ddx;
+  yrandom = fYmin + dy*j + ddy;
+}
+
+//------------------------------------------------------------------------------
@@ -5,6 +5,9 @@
 #include "TFormula.h"
 
 #include <string>
+#include <vector>
+
+class TRandom;
 
 class DelphesTF2: public TF2
 {
@@ -18,6 +21,14 @@ public:
 
   Int_t DefinedVariable(TString &variable, Int_t &action);
 
+  // same as TF2::GetRandom2 but draws from the given generator instead of gRandom
+  void GetRandom2(Double_t &xrandom, Double_t &yrandom, TRandom *random);
+
+  using TF2::GetRandom2;
+
+private:
+
+  std::vector< Double_t > fCellIntegral;
 };
 
 #endif /* DelphesTF2_h */
@@ -0,0 +1,94 @@
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <ctype.h>
+
+#include "classes/DelphesEventIndex.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+
+// LHEF files start with an XML tag, HepMC files with a plain text line
+static DelphesEventIndex::Format DetectFormat(FILE *inputFile)
+{
+  int c;
+
+  while((c = fgetc(inputFile)) != EOF && isspace(c));
+  rewind(inputFile);
+
+  return (c == '<') ? DelphesEventIndex::kLHEF : DelphesEventIndex::kHepMC;
+}
+
+//---------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  char appName[] = "event2index";
+  stringstream message;
+  FILE *inputFile = 0;
+  DelphesEventIndex::Format format;
+  int part, numberOfParts = 1;
+  long long first, last;
+
+  if(argc < 2 || argc > 3)
+  {
+    cout << " Usage: " << appName << " input_file" << " [number_of_parts]" << endl;
+    cout << " input_file - input file in HepMC or LHEF format," << endl;
+    cout << " number_of_parts - number of parts to split the events into (default 1)." << endl;
+    return 1;
+  }
+
+  if(argc > 2) numberOfParts = atoi(argv[2]);
+
+  try
+  {
+    if(numberOfParts < 1)
+    {
+      throw runtime_error("number_of_parts must be positive");
+    }
+
+    inputFile = fopen(argv[1], "r");
+
+    if(inputFile == NULL)
+    {
+      message << "can't open " << argv[1];
+      throw runtime_error(message.str());
+    }
+
+    format = DetectFormat(inputFile);
+
+    fclose(inputFile);
+
+    DelphesEventIndex eventIndex(format);
+
+    if(!eventIndex.Load(argv[1]))
+    {
+      message << "can't index " << argv[1];
+      throw runtime_error(message.str());
+    }
+
+    cout << "** " << argv[1] << ": " << eventIndex.GetNumberOfEvents() << " events in ";
+    cout << (format == DelphesEventIndex::kLHEF ? "LHEF" : "HepMC") << " format" << endl;
+    cout << "** Index file: " << DelphesEventIndex::GetIndexName(argv[1]) << endl;
+
+    // one line per part: SkipEvents, MaxEvents and the byte range
+    cout << "** part skip_events max_events first_byte last_byte" << endl;
+    for(part = 0; part < numberOfParts; ++part)
+    {
+      eventIndex.GetRange(part, numberOfParts, first, last);
+      cout << part << " " << first << " " << last - first << " ";
+      cout << eventIndex.GetOffset(first) << " " << eventIndex.GetOffset(last) << endl;
+    }
+
+    return 0;
+  }
+  catch(runtime_error &e)
+  {
+    cerr << "** ERROR: " << e.what() << endl;
+    return 1;
+  }
+}
@@ -144,7 +144,7 @@ int main(int argc, char *argv[])
           factory->Clear();
           reader->Clear();
         }
-        progressBar.Update(ftello(inputFile), eventCounter);
+        progressBar.Update(reader->GetPosition(), eventCounter);
       }
 
       fseek(inputFile, 0L, SEEK_END);
@@ -0,0 +1,110 @@
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+#include <stdlib.h>
+#include <signal.h>
+#include <stdio.h>
+
+#include "classes/DelphesPileUpReader.h"
+#include "classes/DelphesPileUpWriter.h"
+
+#include "ExRootAnalysis/ExRootProgressBar.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+
+void ProcessEvent(DelphesPileUpReader *reader, DelphesPileUpWriter *writer)
+{
+  Int_t pid;
+  Float_t x, y, z, t;
+  Float_t px, py, pz, e;
+
+  while(reader->ReadParticle(pid, x, y, z, t, px, py, pz, e))
+  {
+    writer->WriteParticle(pid, x, y, z, t, px, py, pz, e);
+  }
+
+  writer->WriteEntry();
+}
+
+//---------------------------------------------------------------------------
+
+static bool interrupted = false;
+
+void SignalHandler(int sig)
+{
+  interrupted = true;
+}
+
+//---------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  char appName[] = "pileup2pileup";
+  stringstream message;
+  DelphesPileUpReader *reader = 0;
+  DelphesPileUpWriter *writer = 0;
+  Float_t minPT;
+  Long64_t entry, allEntries;
+
+  if(argc < 3 || argc > 4)
+  {
+    cout << " Usage: " << appName << " output_file" << " input_file" << " [min_pt]" << endl;
+    cout << " output_file - output binary pile-up file in columnar format," << endl;
+    cout << " input_file - input binary pile-up file in XDR or columnar format," << endl;
+    cout << " min_pt - particles with lower transverse momentum in GeV are not written." << endl;
+    return 1;
+  }
+
+  signal(SIGINT, SignalHandler);
+
+  try
+  {
+    minPT = (argc == 4) ? atof(argv[3]) : 0.0;
+
+    cout << "** Reading " << argv[2] << endl;
+
+    reader = new DelphesPileUpReader(argv[2]);
+    allEntries = reader->GetEntries();
+
+    cout << "** Input file contains " << allEntries << " events" << endl;
+
+    if(reader->GetMinPT() > minPT) minPT = reader->GetMinPT();
+
+    writer = new DelphesPileUpWriter(argv[1], minPT);
+
+    ExRootProgressBar progressBar(allEntries - 1);
+    // Loop over all events
+    for(entry = 0; entry < allEntries && !interrupted; ++entry)
+    {
+      if(!reader->ReadEntry(entry))
+      {
+        cerr << "** ERROR: cannot read event " << entry << endl;
+        break;
+      }
+
+      ProcessEvent(reader, writer);
+
+      progressBar.Update(entry);
+    }
+    progressBar.Finish();
+
+    writer->WriteIndex();
+
+    cout << "** Exiting..." << endl;
+
+    delete writer;
+    delete reader;
+
+    return 0;
+  }
+  catch(runtime_error &e)
+  {
+    if(writer) delete writer;
+    if(reader) delete reader;
+    cerr << "** ERROR: " << e.what() << endl;
+    return 1;
+  }
+}
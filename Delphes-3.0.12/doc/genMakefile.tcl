@@ -90,10 +90,13 @@ proc sourceDeps {srcPrefix args} {
   set srcObjFilesPythia8 {}
 
   foreach fileName $source {
+    # the ProMC reader is built only together with the ProMC library
+    if {$fileName == "classes/DelphesProMCReader.cc" && [lsearch -exact $args {external/ProMC/*.cc}] < 0} continue
+
     regsub {\.cc} $fileName {} srcName
     set srcObjName $prefix$srcName
 
-    if {$fileName == "modules/PileUpMergerPythia8.cc"} {
+    if {$fileName == "modules/PileUpMergerPythia8.cc" || $fileName == "classes/DelphesPythia8Driver.cc"} {
       lappend srcObjFilesPythia8 $srcObjName$objSuf
     } else {
       lappend srcObjFiles $srcObjName$objSuf
@@ -200,6 +203,11 @@ CXXFLAGS += $(ROOTCFLAGS) -Wno-write-strings -D_FILE_OFFSET_BITS=64 -DDROP_CGAL
 DELPHES_LIBS = $(shell $(RC) --libs) -lEG $(SYSLIBS)
 DISPLAY_LIBS = $(shell $(RC) --evelibs) $(SYSLIBS)
 
+ifeq ($(PLATFORM),linux)
+# shm_open for the pile-up pool
+DELPHES_LIBS += -lrt
+endif
+
 ifneq ($(CMSSW_FWLITE_INCLUDE_PATH),)
 HAS_CMSSW = true
 CXXFLAGS += -std=c++0x -I$(subst :, -I,$(CMSSW_FWLITE_INCLUDE_PATH))
@@ -258,7 +266,7 @@ puts {}
 
 puts {ifeq ($(HAS_PROMC),true)}
 executableDeps {readers/DelphesProMC.cpp}
-sourceDeps {DELPHES} {external/ProMC/*.cc}
+sourceDeps {DELPHES} {classes/DelphesProMCReader.cc} {external/ProMC/*.cc}
 puts {endif}
 puts {}
 
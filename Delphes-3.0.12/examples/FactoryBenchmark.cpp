@@ -0,0 +1,203 @@
+
+/*
+./FactoryBenchmark [number_of_events] [candidates_per_event]
+
+Measures the time spent in DelphesFactory allocating candidates and arrays
+and the number of page faults, the same allocation pattern is repeated with
+per-class ExRootTreeBranch pools (the previous DelphesFactory implementation)
+for comparison.
+*/
+
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+#include <map>
+
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#include "TROOT.h"
+#include "TApplication.h"
+
+#include "TClass.h"
+#include "TObjArray.h"
+#include "TStopwatch.h"
+
+#include "classes/DelphesClasses.h"
+#include "classes/DelphesFactory.h"
+
+#include "ExRootAnalysis/ExRootTreeBranch.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+class BranchFactory
+{
+public:
+
+  ~BranchFactory()
+  {
+    map< const TClass*, ExRootTreeBranch* >::iterator itBranches;
+    for(itBranches = fBranches.begin(); itBranches != fBranches.end(); ++itBranches)
+    {
+      delete (itBranches->second);
+    }
+  }
+
+  void Clear()
+  {
+    map< const TClass*, ExRootTreeBranch* >::iterator itBranches;
+    for(itBranches = fBranches.begin(); itBranches != fBranches.end(); ++itBranches)
+    {
+      itBranches->second->Clear();
+    }
+  }
+
+  TObject *New(TClass *cl)
+  {
+    ExRootTreeBranch *branch;
+    map< const TClass*, ExRootTreeBranch* >::iterator it = fBranches.find(cl);
+    if(it != fBranches.end())
+    {
+      branch = it->second;
+    }
+    else
+    {
+      branch = new ExRootTreeBranch(cl->GetName(), cl, 0);
+      fBranches.insert(make_pair(cl, branch));
+    }
+    TObject *object = branch->NewEntry();
+    object->Clear();
+    return object;
+  }
+
+private:
+
+  map< const TClass*, ExRootTreeBranch* > fBranches;
+};
+
+//------------------------------------------------------------------------------
+
+static void GetPageFaults(Long64_t &minor, Long64_t &major)
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  minor = usage.ru_minflt;
+  major = usage.ru_majflt;
+}
+
+//------------------------------------------------------------------------------
+
+template<typename Factory>
+static void Run(const char *name, Factory &factory, Int_t numberOfEvents, Int_t numberOfCandidates,
+  Candidate *(*newCandidate)(Factory &), TObjArray *(*newArray)(Factory &))
+{
+  TStopwatch firstStopWatch, stopWatch;
+  Long64_t minorBefore, majorBefore, minorFirst, majorFirst, minorAfter, majorAfter;
+  Candidate *candidate, *tower;
+  TObjArray *array;
+  Int_t event, i;
+
+  GetPageFaults(minorBefore, majorBefore);
+
+  for(event = 0; event < numberOfEvents; ++event)
+  {
+    if(event == 0) firstStopWatch.Start();
+    if(event == 1) stopWatch.Start(kTRUE);
+
+    // particles, their clones and one tower for every ten particles
+    array = newArray(factory);
+    for(i = 0; i < numberOfCandidates; ++i)
+    {
+      candidate = newCandidate(factory);
+      candidate->Momentum.SetPxPyPzE(1.0, 2.0, 3.0, 4.0);
+      array->Add(candidate);
+
+      candidate = newCandidate(factory);
+      candidate->Momentum.SetPxPyPzE(1.0, 2.0, 3.0, 4.0);
+
+      if(i % 10 == 0)
+      {
+        tower = newCandidate(factory);
+        tower->Momentum.SetPxPyPzE(1.0, 2.0, 3.0, 4.0);
+        array->Add(tower);
+      }
+    }
+
+    factory.Clear();
+
+    if(event == 0)
+    {
+      firstStopWatch.Stop();
+      GetPageFaults(minorFirst, majorFirst);
+    }
+  }
+
+  stopWatch.Stop();
+  GetPageFaults(minorAfter, majorAfter);
+
+  cout << "** " << name << endl;
+  cout << "   first event: " << firstStopWatch.RealTime()*1.0E3 << " ms, ";
+  cout << (minorFirst - minorBefore) << " minor / " << (majorFirst - majorBefore) << " major page faults" << endl;
+  if(numberOfEvents > 1)
+  {
+    cout << "   next events: " << stopWatch.RealTime()*1.0E3/(numberOfEvents - 1) << " ms/event, ";
+    cout << stopWatch.RealTime()*1.0E9/(numberOfEvents - 1)/(2.1*numberOfCandidates) << " ns/candidate, ";
+    cout << (minorAfter - minorFirst) << " minor / " << (majorAfter - majorFirst) << " major page faults" << endl;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+static Candidate *NewArenaCandidate(DelphesFactory &factory) { return factory.NewCandidate(); }
+static TObjArray *NewArenaArray(DelphesFactory &factory) { return factory.NewArray(); }
+
+static Candidate *NewBranchCandidate(BranchFactory &factory) { return static_cast<Candidate *>(factory.New(Candidate::Class())); }
+static TObjArray *NewBranchArray(BranchFactory &factory) { return static_cast<TObjArray *>(factory.New(TObjArray::Class())); }
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  char appName[] = "FactoryBenchmark";
+  Int_t numberOfEvents = 100, numberOfCandidates = 100000;
+
+  if(argc > 3)
+  {
+    cout << " Usage: " << appName << " [number_of_events]" << " [candidates_per_event]" << endl;
+    cout << " number_of_events - number of events to simulate (default 100)," << endl;
+    cout << " candidates_per_event - number of particles per event (default 100000)." << endl;
+    return 1;
+  }
+
+  if(argc > 1) numberOfEvents = atoi(argv[1]);
+  if(argc > 2) numberOfCandidates = atoi(argv[2]);
+
+  gROOT->SetBatch();
+
+  int appargc = 1;
+  char *appargv[] = {appName};
+  TApplication app(appName, &appargc, appargv);
+
+  try
+  {
+    DelphesFactory *arenaFactory = new DelphesFactory;
+    Run("DelphesFactory (arena)", *arenaFactory, numberOfEvents, numberOfCandidates,
+      &NewArenaCandidate, &NewArenaArray);
+    cout << "   objects: " << arenaFactory->GetCapacity() << endl;
+    delete arenaFactory;
+
+    BranchFactory *branchFactory = new BranchFactory;
+    Run("ExRootTreeBranch pools", *branchFactory, numberOfEvents, numberOfCandidates,
+      &NewBranchCandidate, &NewBranchArray);
+    delete branchFactory;
+
+    return 0;
+  }
+  catch(runtime_error &e)
+  {
+    cerr << "** ERROR: " << e.what() << endl;
+    return 1;
+  }
+}
@@ -0,0 +1,155 @@
+
+/*
+./HepMCBenchmark input_file [number_of_events]
+
+Measures the reading speed of DelphesHepMCReader in events/s and MB/s.
+The file is first scanned for lines only, to separate the time spent
+in the input from the time spent in parsing and creating candidates.
+*/
+
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "TROOT.h"
+#include "TApplication.h"
+
+#include "TObjArray.h"
+#include "TStopwatch.h"
+
+#include "classes/DelphesClasses.h"
+#include "classes/DelphesFactory.h"
+#include "classes/DelphesInputBuffer.h"
+#include "classes/DelphesHepMCReader.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+static void Report(const char *name, TStopwatch &stopWatch, Long64_t events, Long64_t particles, Long64_t bytes)
+{
+  Double_t time = stopWatch.RealTime();
+
+  cout << "** " << name << endl;
+  cout << "   " << events << " events, " << particles << " particles, ";
+  cout << bytes/1.0E6 << " MB in " << time << " s" << endl;
+  if(time > 0.0)
+  {
+    cout << "   " << events/time << " events/s, " << bytes/1.0E6/time << " MB/s" << endl;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  char appName[] = "HepMCBenchmark";
+  stringstream message;
+  FILE *inputFile = 0;
+  TStopwatch stopWatch;
+  DelphesFactory *factory = 0;
+  DelphesInputBuffer *buffer = 0;
+  DelphesHepMCReader *reader = 0;
+  TObjArray *allParticleOutputArray, *stableParticleOutputArray, *partonOutputArray;
+  Long64_t maxEvents = 0, eventCounter, particleCounter, bytes;
+  const char *begin, *end;
+
+  if(argc < 2 || argc > 3)
+  {
+    cout << " Usage: " << appName << " input_file" << " [number_of_events]" << endl;
+    cout << " input_file - input file in HepMC format," << endl;
+    cout << " number_of_events - number of events to read (default all)." << endl;
+    return 1;
+  }
+
+  if(argc > 2) maxEvents = atoll(argv[2]);
+
+  gROOT->SetBatch();
+
+  int appargc = 1;
+  char *appargv[] = {appName};
+  TApplication app(appName, &appargc, appargv);
+
+  try
+  {
+    inputFile = fopen(argv[1], "r");
+    if(inputFile == NULL)
+    {
+      message << "can't open " << argv[1];
+      throw runtime_error(message.str());
+    }
+
+    // lines only
+
+    buffer = new DelphesInputBuffer;
+    buffer->SetInputFile(inputFile);
+
+    eventCounter = 0;
+    stopWatch.Start();
+    while(buffer->ReadLine(begin, end))
+    {
+      if(begin < end && begin[0] == 'E')
+      {
+        if(maxEvents > 0 && eventCounter == maxEvents) break;
+        ++eventCounter;
+      }
+    }
+    stopWatch.Stop();
+
+    Report(buffer->IsMapped() ? "line scan (memory-mapped)" : "line scan (block reads)",
+      stopWatch, eventCounter, 0, buffer->GetPosition());
+
+    delete buffer;
+
+    // full reading
+
+    rewind(inputFile);
+
+    factory = new DelphesFactory;
+    allParticleOutputArray = factory->NewPermanentArray();
+    stableParticleOutputArray = factory->NewPermanentArray();
+    partonOutputArray = factory->NewPermanentArray();
+
+    reader = new DelphesHepMCReader;
+    reader->SetInputFile(inputFile);
+
+    eventCounter = 0;
+    particleCounter = 0;
+    bytes = 0;
+    factory->Clear();
+    reader->Clear();
+    stopWatch.Start();
+    while((maxEvents <= 0 || eventCounter < maxEvents) &&
+      reader->ReadBlock(factory, allParticleOutputArray,
+      stableParticleOutputArray, partonOutputArray))
+    {
+      if(reader->EventReady())
+      {
+        ++eventCounter;
+        particleCounter += allParticleOutputArray->GetEntriesFast();
+        bytes = reader->GetPosition();
+
+        factory->Clear();
+        reader->Clear();
+      }
+    }
+    stopWatch.Stop();
+
+    Report("DelphesHepMCReader", stopWatch, eventCounter, particleCounter, bytes);
+
+    delete reader;
+    delete factory;
+
+    fclose(inputFile);
+
+    return 0;
+  }
+  catch(runtime_error &e)
+  {
+    cerr << "** ERROR: " << e.what() << endl;
+    return 1;
+  }
+}
@@ -36,6 +36,21 @@ module PileUpMerger PileUpMerger {
   # pre-generated minbias input file
   set PileUpFile MinBias.pileup
 
+  # minbias events decoded once per node into this shared-memory segment
+  # set PileUpPool /DelphesMinBias
+  # number of minbias events in the segment, 0 for all events of the file
+  # set PileUpPoolSize 0
+
+  # for fast studies, minbias events kept in memory and reused with new
+  # rotations, eta reflections and vertices, and number of times each of
+  # them is merged before it is replaced (0 for no limit)
+  # with NumThreads > 1 or RandomSeedPerEvent, the reuse budget is an average:
+  # each event is replaced every PileUpReuseBudget*PileUpHotSetSize/MeanPileUp
+  # events and is drawn from the event number, so that the output does not
+  # depend on the number of threads
+  # set PileUpHotSetSize 1000
+  # set PileUpReuseBudget 20
+
   # average expected pile up
   set MeanPileUp 20
   
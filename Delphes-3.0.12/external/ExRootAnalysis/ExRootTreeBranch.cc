@@ -93,3 +93,23 @@ void ExRootTreeBranch::Clear()
 
 //------------------------------------------------------------------------------
 
+const char *ExRootTreeBranch::GetName() const
+{
+  return fData ? fData->GetName() : "";
+}
+
+//------------------------------------------------------------------------------
+
+TClass *ExRootTreeBranch::GetClass() const
+{
+  return fData ? fData->GetClass() : 0;
+}
+
+//------------------------------------------------------------------------------
+
+TObject *ExRootTreeBranch::At(Int_t index) const
+{
+  return (fData && index >= 0 && index < fSize) ? fData->AddrAt(index) : 0;
+}
+
+//------------------------------------------------------------------------------
@@ -17,6 +17,8 @@
 #include "Rtypes.h"
 
 class TTree;
+class TClass;
+class TObject;
 class TClonesArray;
 
 class ExRootTreeBranch
@@ -29,6 +31,12 @@ public:
   TObject *NewEntry();
   void Clear();
 
+  const char *GetName() const;
+  TClass *GetClass() const;
+
+  Int_t GetEntries() const { return fSize; }
+  TObject *At(Int_t index) const;
+
 private:
 
   Int_t fSize, fCapacity; //!
@@ -17,12 +17,15 @@
 #include "TROOT.h"
 #include "TFile.h"
 #include "TTree.h"
+#include "TList.h"
 #include "TClonesArray.h"
 
 #include <iostream>
 #include <stdexcept>
 #include <sstream>
 
+#include <string.h>
+
 using namespace std;
 
 ExRootTreeWriter::ExRootTreeWriter(TFile *file, const char *treeName) :
@@ -47,14 +50,60 @@ ExRootTreeWriter::~ExRootTreeWriter()
 
 ExRootTreeBranch *ExRootTreeWriter::NewBranch(const char *name, TClass *cl)
 {
+  stringstream message;
+  ExRootTreeBranch *branch;
+
+  if(GetBranch(name))
+  {
+    message << "branch '" << name << "' is created more than once";
+    throw runtime_error(message.str());
+  }
+
   if(!fTree) fTree = NewTree();
-  ExRootTreeBranch *branch = new ExRootTreeBranch(name, cl, fTree);
+  branch = new ExRootTreeBranch(name, cl, fTree);
   fBranches.insert(branch);
   return branch;
 }
 
 //------------------------------------------------------------------------------
 
+ExRootTreeBranch *ExRootTreeWriter::GetBranch(const char *name) const
+{
+  set<ExRootTreeBranch*>::const_iterator itBranches;
+
+  for(itBranches = fBranches.begin(); itBranches != fBranches.end(); ++itBranches)
+  {
+    if(strcmp((*itBranches)->GetName(), name) == 0) return *itBranches;
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootTreeWriter::AddInfo(TObject *object)
+{
+  TList *info;
+  TObject *previous;
+
+  if(!fTree) fTree = NewTree();
+  if(!fTree)
+  {
+    delete object;
+    return;
+  }
+
+  info = fTree->GetUserInfo();
+  if((previous = info->FindObject(object->GetName())))
+  {
+    info->Remove(previous);
+    delete previous;
+  }
+  info->Add(object);
+}
+
+//------------------------------------------------------------------------------
+
 void ExRootTreeWriter::Fill()
 {
   if(fTree) fTree->Fill();
@@ -32,8 +32,16 @@ public:
   void SetTreeFile(TFile *file) { fFile = file; }
   void SetTreeName(const char *name) { fTreeName = name; }
 
+  // throws when a branch with the same name already exists
   ExRootTreeBranch *NewBranch(const char *name, TClass *cl);
 
+  // existing branch with the given name, 0 if there is none
+  ExRootTreeBranch *GetBranch(const char *name) const;
+
+  // stores the object in the user info of the tree,
+  // replaces and deletes an earlier object with the same name
+  void AddInfo(TObject *object);
+
   void Clear();
   void Fill();
   void Write();
@@ -250,6 +250,37 @@ int  ProMCBook::next(){
 }
 
 
+/**
+ Get the next record without decoding it.
+ The record is copied into the buffer, the memory of
+ the buffer is reused from one record to the next.
+ @return 0 if the record was extracted OK, see next() otherwise
+**/
+
+int  ProMCBook::next(string &record){
+
+	char block[65536];
+	streamsize size;
+	int status;
+
+	status = next();
+	if (status != 0) return status;
+
+	record.clear();
+	try {
+		streambuf *buffer = inpzip->rdbuf();
+		while ((size = buffer->sgetn(block, sizeof(block))) > 0) record.append(block, size);
+	} catch( IOException &e ) {
+		return 6;
+	}
+	catch( ... ) {
+		return 7;
+	}
+
+	return 0;
+}
+
+
 
 /**
  Get the record with the header file.
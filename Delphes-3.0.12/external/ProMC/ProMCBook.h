@@ -59,6 +59,7 @@ public:
      ProMCEvent get();
      ProMCEvent event(long idx);
      int  next();
+     int  next(string &record); // next record, not decoded
      int  getTimestamp() { return timestamp; };
      int  getVersion() { return version; }; 
      string getDescription() { return description; };
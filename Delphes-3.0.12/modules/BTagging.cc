@@ -16,8 +16,10 @@
 #include "modules/BTagging.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesEtaPhiGrid.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -70,8 +72,7 @@ Int_t BTaggingPartonClassifier::GetCategory(TObject *object)
 //------------------------------------------------------------------------------
 
 BTagging::BTagging() :
-  fClassifier(0), fFilter(0),
-  fItPartonInputArray(0), fItJetInputArray(0)
+  fClassifier(0), fFilter(0), fGrid(0)
 {
   fClassifier = new BTaggingPartonClassifier;
 }
@@ -125,12 +126,12 @@ void BTagging::Init()
   // import input array(s)
 
   fPartonInputArray = ImportArray(GetString("PartonInputArray", "Delphes/partons"));
-  fItPartonInputArray = fPartonInputArray->MakeIterator();
 
   fFilter = new ExRootFilter(fPartonInputArray);
+
+  fGrid = new DelphesEtaPhiGrid(fDeltaR);
   
-  fJetInputArray = ImportArray(GetString("JetInputArray", "FastJetFinder/jets"));
-  fItJetInputArray = fJetInputArray->MakeIterator();
+  fJetInputArray = UpdateArray(GetString("JetInputArray", "FastJetFinder/jets"));
 }
 
 //------------------------------------------------------------------------------
@@ -141,8 +142,7 @@ void BTagging::Finish()
   DelphesFormula *formula;
 
   if(fFilter) delete fFilter;
-  if(fItJetInputArray) delete fItJetInputArray;
-  if(fItPartonInputArray) delete fItPartonInputArray;
+  if(fGrid) delete fGrid;
 
   for(itEfficiencyMap = fEfficiencyMap.begin(); itEfficiencyMap != fEfficiencyMap.end(); ++itEfficiencyMap)
   {
@@ -161,6 +161,7 @@ void BTagging::Process()
   map< Int_t, DelphesFormula * >::iterator itEfficiencyMap;
   DelphesFormula *formula;
   Int_t pdgCode, pdgCodeMax;
+  vector< Int_t >::iterator itNeighbours;
 
   // select quark and gluons
   fFilter->Reset();
@@ -168,22 +169,25 @@ void BTagging::Process()
   
   if(partonArray == 0) return;
 
-  TIter itPartonArray(partonArray);
+  fGrid->Fill(partonArray);
   
   // loop over all input jets
-  fItJetInputArray->Reset();
-  while((jet = static_cast<Candidate*>(fItJetInputArray->Next())))
+  DelphesCandidateSpan jetInputArray(fJetInputArray);
+  DelphesCandidateSpan::iterator itJetInputArray;
+  for(itJetInputArray = jetInputArray.begin(); itJetInputArray != jetInputArray.end(); ++itJetInputArray)
   {
+    jet = *itJetInputArray;
     const TLorentzVector &jetMomentum = jet->Momentum;
     pdgCodeMax = -1;
     eta = jetMomentum.Eta();
     phi = jetMomentum.Phi();
     pt = jetMomentum.Pt();
 
-    // loop over all input partons
-    itPartonArray.Reset();
-    while((parton = static_cast<Candidate*>(itPartonArray.Next())))
+    // loop over the input partons close to the jet
+    fGrid->Find(eta, phi, fDeltaR, fNeighbours);
+    for(itNeighbours = fNeighbours.begin(); itNeighbours != fNeighbours.end(); ++itNeighbours)
     {
+      parton = static_cast<Candidate*>(partonArray->UncheckedAt(*itNeighbours));
       pdgCode = TMath::Abs(parton->PID);
       if(pdgCode == 21) pdgCode = 0;
       if(jetMomentum.DeltaR(parton->Momentum) <= fDeltaR)
@@ -203,7 +207,7 @@ void BTagging::Process()
     formula = itEfficiencyMap->second;
 
     // apply an efficency formula
-    jet->BTag |= (gRandom->Uniform() <= formula->Eval(pt, eta)) << fBitNumber;
+    jet->BTag |= (GetRandom()->Uniform() <= formula->Eval(pt, eta)) << fBitNumber;
   }
 }
 
@@ -18,12 +18,14 @@
 #include "classes/DelphesModule.h"
 
 #include <map>
+#include <vector>
 
 class TObjArray;
 class DelphesFormula;
 
 class ExRootFilter;
 class BTaggingPartonClassifier;
+class DelphesEtaPhiGrid;
 
 class BTagging: public DelphesModule
 {
@@ -48,9 +50,11 @@ private:
   
   ExRootFilter *fFilter;
 
-  TIterator *fItPartonInputArray; //!
+  DelphesEtaPhiGrid *fGrid; //!
+
+  std::vector< Int_t > fNeighbours; //!
+
   
-  TIterator *fItJetInputArray; //!
 
   const TObjArray *fPartonInputArray; //!
   
@@ -15,8 +15,10 @@
 #include "modules/Calorimeter.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesParticleStore.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -41,14 +43,16 @@ using namespace std;
 
 Calorimeter::Calorimeter() :
   fECalResolutionFormula(0), fHCalResolutionFormula(0),
-  fItParticleInputArray(0), fItTrackInputArray(0),
-  fTowerTrackArray(0), fItTowerTrackArray(0)
+  fParticleStore(0), fTrackStore(0),
+  fTowerTrackArray(0)
 {
   fECalResolutionFormula = new DelphesFormula;
   fHCalResolutionFormula = new DelphesFormula;
 
+  fParticleStore = new DelphesParticleStore;
+  fTrackStore = new DelphesParticleStore;
+
   fTowerTrackArray = new TObjArray;
-  fItTowerTrackArray = fTowerTrackArray->MakeIterator();
 }
 
 //------------------------------------------------------------------------------
@@ -58,8 +62,10 @@ Calorimeter::~Calorimeter()
   if(fECalResolutionFormula) delete fECalResolutionFormula;
   if(fHCalResolutionFormula) delete fHCalResolutionFormula;
 
+  if(fParticleStore) delete fParticleStore;
+  if(fTrackStore) delete fTrackStore;
+
   if(fTowerTrackArray) delete fTowerTrackArray;
-  if(fItTowerTrackArray) delete fItTowerTrackArray;
 }
 
 //------------------------------------------------------------------------------
@@ -140,10 +146,8 @@ void Calorimeter::Init()
 
   // import array with output from other modules
   fParticleInputArray = ImportArray(GetString("ParticleInputArray", "ParticlePropagator/particles"));
-  fItParticleInputArray = fParticleInputArray->MakeIterator();
 
   fTrackInputArray = ImportArray(GetString("TrackInputArray", "ParticlePropagator/tracks"));
-  fItTrackInputArray = fTrackInputArray->MakeIterator();
 
   // create output arrays
   fTowerOutputArray = ExportArray(GetString("TowerOutputArray", "towers"));
@@ -158,8 +162,6 @@ void Calorimeter::Init()
 void Calorimeter::Finish()
 {
   vector< vector< Double_t >* >::iterator itPhiBin;
-  if(fItParticleInputArray) delete fItParticleInputArray;
-  if(fItTrackInputArray) delete fItTrackInputArray;
   for(itPhiBin = fPhiBins.begin(); itPhiBin != fPhiBins.end(); ++itPhiBin)
   {
     delete *itPhiBin;
@@ -171,9 +173,8 @@ void Calorimeter::Finish()
 void Calorimeter::Process()
 {
   Candidate *particle, *track;
-  TLorentzVector position, momentum;
   Short_t etaBin, phiBin, flags;
-  Int_t number;
+  Int_t number, size;
   Long64_t towerHit, towerEtaPhi, hitEtaPhi;
   Double_t ecalFraction, hcalFraction;
   Double_t ecalEnergy, hcalEnergy;
@@ -194,15 +195,19 @@ void Calorimeter::Process()
   fTrackECalFractions.clear();
   fTrackHCalFractions.clear();
 
+  // particles and tracks are accessed through their columnar copies,
+  // hits refer to positions in these copies
+  fParticleStore->Fill(fParticleInputArray);
+  fTrackStore->Fill(fTrackInputArray);
+
+  const Int_t *particlePID = fParticleStore->PID();
+  const Int_t *trackPID = fTrackStore->PID();
+
   // loop over all particles
-  fItParticleInputArray->Reset();
-  number = -1;
-  while((particle = static_cast<Candidate*>(fItParticleInputArray->Next())))
+  size = fParticleStore->GetSize();
+  for(number = 0; number < size; ++number)
   {
-    const TLorentzVector &particlePosition = particle->Position;
-    ++number;
-
-    pdgCode = TMath::Abs(particle->PID);
+    pdgCode = TMath::Abs(particlePID[number]);
 
     itFractionMap = fFractionMap.find(pdgCode);
     if(itFractionMap == fFractionMap.end())
@@ -219,7 +224,7 @@ void Calorimeter::Process()
     if(ecalFraction < 1.0E-9 && hcalFraction < 1.0E-9) continue;
 
     // find eta bin [1, fEtaBins.size - 1]
-    itEtaBin = lower_bound(fEtaBins.begin(), fEtaBins.end(), particlePosition.Eta());
+    itEtaBin = lower_bound(fEtaBins.begin(), fEtaBins.end(), fParticleStore->PositionEta(number));
     if(itEtaBin == fEtaBins.begin() || itEtaBin == fEtaBins.end()) continue;
     etaBin = distance(fEtaBins.begin(), itEtaBin);
 
@@ -227,7 +232,7 @@ void Calorimeter::Process()
     phiBins = fPhiBins[etaBin];
 
     // find phi bin [1, phiBins.size - 1]
-    itPhiBin = lower_bound(phiBins->begin(), phiBins->end(), particlePosition.Phi());
+    itPhiBin = lower_bound(phiBins->begin(), phiBins->end(), fParticleStore->PositionPhi(number));
     if(itPhiBin == phiBins->begin() || itPhiBin == phiBins->end()) continue;
     phiBin = distance(phiBins->begin(), itPhiBin);
 
@@ -241,14 +246,10 @@ void Calorimeter::Process()
   }
 
   // loop over all tracks
-  fItTrackInputArray->Reset();
-  number = -1;
-  while((track = static_cast<Candidate*>(fItTrackInputArray->Next())))
+  size = fTrackStore->GetSize();
+  for(number = 0; number < size; ++number)
   {
-    const TLorentzVector &trackPosition = track->Position;
-    ++number;
-
-    pdgCode = TMath::Abs(track->PID);
+    pdgCode = TMath::Abs(trackPID[number]);
 
     itFractionMap = fFractionMap.find(pdgCode);
     if(itFractionMap == fFractionMap.end())
@@ -263,7 +264,7 @@ void Calorimeter::Process()
     fTrackHCalFractions.push_back(hcalFraction);
 
     // find eta bin [1, fEtaBins.size - 1]
-    itEtaBin = lower_bound(fEtaBins.begin(), fEtaBins.end(), trackPosition.Eta());
+    itEtaBin = lower_bound(fEtaBins.begin(), fEtaBins.end(), fTrackStore->PositionEta(number));
     if(itEtaBin == fEtaBins.begin() || itEtaBin == fEtaBins.end()) continue;
     etaBin = distance(fEtaBins.begin(), itEtaBin);
 
@@ -271,7 +272,7 @@ void Calorimeter::Process()
     phiBins = fPhiBins[etaBin];
 
     // find phi bin [1, phiBins.size - 1]
-    itPhiBin = lower_bound(phiBins->begin(), phiBins->end(), trackPosition.Phi());
+    itPhiBin = lower_bound(phiBins->begin(), phiBins->end(), fTrackStore->PositionPhi(number));
     if(itPhiBin == phiBins->begin() || itPhiBin == phiBins->end()) continue;
     phiBin = distance(phiBins->begin(), itPhiBin);
 
@@ -349,19 +350,16 @@ void Calorimeter::Process()
     {
       ++fTowerTrackHits;
 
-      track = static_cast<Candidate*>(fTrackInputArray->At(number));
-      momentum = track->Momentum;
-      position = track->Position;
+      track = fTrackStore->GetCandidate(number);
 
-      
-      ecalEnergy = momentum.E() * fTrackECalFractions[number];
-      hcalEnergy = momentum.E() * fTrackHCalFractions[number];
+      ecalEnergy = fTrackStore->E()[number] * fTrackECalFractions[number];
+      hcalEnergy = fTrackStore->E()[number] * fTrackHCalFractions[number];
 
       fTrackECalEnergy += ecalEnergy;
       fTrackHCalEnergy += hcalEnergy;
       
-      fTrackECalTime += TMath::Sqrt(ecalEnergy)*position.T();
-      fTrackHCalTime += TMath::Sqrt(hcalEnergy)*position.T();
+      fTrackECalTime += TMath::Sqrt(ecalEnergy)*fTrackStore->T()[number];
+      fTrackHCalTime += TMath::Sqrt(hcalEnergy)*fTrackStore->T()[number];
        
       fTrackECalWeightTime += TMath::Sqrt(ecalEnergy);
       fTrackHCalWeightTime += TMath::Sqrt(hcalEnergy);
@@ -374,19 +372,17 @@ void Calorimeter::Process()
     // check for photon and electron hits in current tower
     if(flags & 2) ++fTowerPhotonHits;
 
-    particle = static_cast<Candidate*>(fParticleInputArray->At(number));
-    momentum = particle->Momentum;
-    position = particle->Position;
+    particle = fParticleStore->GetCandidate(number);
 
     // fill current tower
-    ecalEnergy = momentum.E() * fTowerECalFractions[number];
-    hcalEnergy = momentum.E() * fTowerHCalFractions[number];
+    ecalEnergy = fParticleStore->E()[number] * fTowerECalFractions[number];
+    hcalEnergy = fParticleStore->E()[number] * fTowerHCalFractions[number];
 
     fTowerECalEnergy += ecalEnergy;
     fTowerHCalEnergy += hcalEnergy;
 
-    fTowerECalTime += TMath::Sqrt(ecalEnergy)*position.T();
-    fTowerHCalTime += TMath::Sqrt(hcalEnergy)*position.T();
+    fTowerECalTime += TMath::Sqrt(ecalEnergy)*fParticleStore->T()[number];
+    fTowerHCalTime += TMath::Sqrt(hcalEnergy)*fParticleStore->T()[number];
 
     fTowerECalWeightTime += TMath::Sqrt(ecalEnergy);
     fTowerHCalWeightTime += TMath::Sqrt(hcalEnergy);
@@ -433,21 +429,21 @@ void Calorimeter::FinalizeTower()
 //  eta = fTowerEta;
 //  phi = fTowerPhi;
 
-  eta = gRandom->Uniform(fTowerEdges[0], fTowerEdges[1]);
-  phi = gRandom->Uniform(fTowerEdges[2], fTowerEdges[3]);
+  eta = GetRandom()->Uniform(fTowerEdges[0], fTowerEdges[1]);
+  phi = GetRandom()->Uniform(fTowerEdges[2], fTowerEdges[3]);
 
   pt = energy / TMath::CosH(eta);
 
  // fTower->Position.SetXYZT(-time, 0.0, 0.0, time);
   fTower->Position.SetPtEtaPhiE(1.0, eta, phi, time);
   fTower->Momentum.SetPtEtaPhiE(pt, eta, phi, energy);
-  fTower->Eem = ecalEnergy;
-  fTower->Ehad = hcalEnergy;
+  fTower->Tower().Eem = ecalEnergy;
+  fTower->Tower().Ehad = hcalEnergy;
 
-  fTower->Edges[0] = fTowerEdges[0];
-  fTower->Edges[1] = fTowerEdges[1];
-  fTower->Edges[2] = fTowerEdges[2];
-  fTower->Edges[3] = fTowerEdges[3];
+  fTower->Tower().Edges[0] = fTowerEdges[0];
+  fTower->Tower().Edges[1] = fTowerEdges[1];
+  fTower->Tower().Edges[2] = fTowerEdges[2];
+  fTower->Tower().Edges[3] = fTowerEdges[3];
 
 
   // fill calorimeter towers and photon candidates
@@ -464,9 +460,11 @@ void Calorimeter::FinalizeTower()
   // fill energy flow candidates
 
   // save all the tracks as energy flow tracks
-  fItTowerTrackArray->Reset();
-  while((track = static_cast<Candidate*>(fItTowerTrackArray->Next())))
+  DelphesCandidateSpan towerTrackArray(fTowerTrackArray);
+  DelphesCandidateSpan::iterator itTowerTrackArray;
+  for(itTowerTrackArray = towerTrackArray.begin(); itTowerTrackArray != towerTrackArray.end(); ++itTowerTrackArray)
   {
+    track = *itTowerTrackArray;
     fEFlowTrackOutputArray->Add(track);
   }
 
@@ -487,8 +485,8 @@ void Calorimeter::FinalizeTower()
     pt = energy / TMath::CosH(eta);
 
     tower->Momentum.SetPtEtaPhiE(pt, eta, phi, energy);
-    tower->Eem = ecalEnergy;
-    tower->Ehad = hcalEnergy;
+    tower->Tower().Eem = ecalEnergy;
+    tower->Tower().Ehad = hcalEnergy;
 
     fEFlowTowerOutputArray->Add(tower);
   }
@@ -505,7 +503,7 @@ Double_t Calorimeter::LogNormal(Double_t mean, Double_t sigma)
     b = TMath::Sqrt(TMath::Log((1.0 + (sigma*sigma)/(mean*mean))));
     a = TMath::Log(mean) - 0.5*b*b;
 
-    return TMath::Exp(a + b*gRandom->Gaus(0, 1));
+    return TMath::Exp(a + b*GetRandom()->Gaus(0, 1));
   }
   else
   {
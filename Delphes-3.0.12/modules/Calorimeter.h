@@ -23,6 +23,7 @@
 class TObjArray;
 class DelphesFormula;
 class Candidate;
+class DelphesParticleStore;
 
 class Calorimeter: public DelphesModule
 {
@@ -70,8 +71,8 @@ private:
   DelphesFormula *fECalResolutionFormula; //!
   DelphesFormula *fHCalResolutionFormula; //!
 
-  TIterator *fItParticleInputArray; //!
-  TIterator *fItTrackInputArray; //!
+  DelphesParticleStore *fParticleStore; //!
+  DelphesParticleStore *fTrackStore; //!
 
   const TObjArray *fParticleInputArray; //!
   const TObjArray *fTrackInputArray; //!
@@ -83,7 +84,6 @@ private:
   TObjArray *fEFlowTowerOutputArray; //!
 
   TObjArray *fTowerTrackArray; //!
-  TIterator *fItTowerTrackArray; //!
 
   void FinalizeTower();
   Double_t LogNormal(Double_t mean, Double_t sigma);
@@ -13,6 +13,7 @@
 #include "modules/Cloner.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -29,8 +30,7 @@ using namespace std;
 
 //------------------------------------------------------------------------------
 
-Cloner::Cloner() :
-  fItInputArray(0)
+Cloner::Cloner()
 {
 
 }
@@ -49,7 +49,6 @@ void Cloner::Init()
   // import input array(s)
 
   fInputArray = ImportArray(GetString("InputArray", "FastJetFinder/jets"));
-  fItInputArray = fInputArray->MakeIterator();
 
   // create output array(s)
 
@@ -61,7 +60,6 @@ void Cloner::Init()
 
 void Cloner::Finish()
 {
-  if(fItInputArray) delete fItInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -71,9 +69,11 @@ void Cloner::Process()
   Candidate *candidate;
  
  // loop over all input candidates
-  fItInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItInputArray->Next())))
+  DelphesCandidateSpan inputArray(fInputArray);
+  DelphesCandidateSpan::iterator itInputArray;
+  for(itInputArray = inputArray.begin(); itInputArray != inputArray.end(); ++itInputArray)
   {
+    candidate = *itInputArray;
     candidate = static_cast<Candidate*>(candidate->Clone());
     fOutputArray->Add(candidate);
   }
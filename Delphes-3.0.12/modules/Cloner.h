@@ -32,8 +32,6 @@ public:
 
 private:
 
-  TIterator *fItInputArray; //!
-
   const TObjArray *fInputArray; //!
   TObjArray *fOutputArray; //!
 
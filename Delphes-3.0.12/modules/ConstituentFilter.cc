@@ -14,6 +14,7 @@
 #include "modules/ConstituentFilter.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -55,7 +56,6 @@ void ConstituentFilter::Init()
   ExRootConfParam param;
   Long_t i, size;
   const TObjArray *array;
-  TIterator *iterator;
 
   fJetPTMin = GetDouble("JetPTMin", 0.0);
 
@@ -66,19 +66,18 @@ void ConstituentFilter::Init()
   for(i = 0; i < size; ++i)
   {
     array = ImportArray(param[i].GetString());
-    iterator = array->MakeIterator();
 
-    fInputList.push_back(iterator);
+    fInputList.push_back(array);
   }
 
   param = GetParam("ConstituentInputArray");
   size = param.GetSize();
   for(i = 0; i < size/2; ++i)
   {
-    array = ImportArray(param[i*2].GetString());
-    iterator = array->MakeIterator();
+    // the IsConstituent flag is set on the candidates of these arrays
+    array = UpdateArray(param[i*2].GetString());
 
-    fInputMap[iterator] = ExportArray(param[i*2 + 1].GetString());
+    fInputMap.push_back(make_pair(array, ExportArray(param[i*2 + 1].GetString())));
   }
 }
 
@@ -86,21 +85,6 @@ void ConstituentFilter::Init()
 
 void ConstituentFilter::Finish()
 {
-  map< TIterator *, TObjArray * >::iterator itInputMap;
-  vector< TIterator * >::iterator itInputList;
-  TIterator *iterator;
-
-  for(itInputList = fInputList.begin(); itInputList != fInputList.end(); ++itInputList)
-  {
-    iterator = *itInputList;
-    if(iterator) delete iterator;
-  }
-
-  for(itInputMap = fInputMap.begin(); itInputMap != fInputMap.end(); ++itInputMap)
-  {
-    iterator = itInputMap->first;
-    if(iterator) delete iterator;
-  }
 }
 
 //------------------------------------------------------------------------------
@@ -108,27 +92,29 @@ void ConstituentFilter::Finish()
 void ConstituentFilter::Process()
 {
   Candidate *jet, *constituent;
-  map< TIterator *, TObjArray * >::iterator itInputMap;
-  vector< TIterator * >::iterator itInputList;
-  TIterator *iterator;
+  vector< pair< const TObjArray *, TObjArray * > >::iterator itInputMap;
+  vector< const TObjArray * >::iterator itInputList;
+  DelphesCandidateSpan::iterator itJets, itConstituents;
   TObjArray *array;
 
   // loop over all jet input arrays
   for(itInputList = fInputList.begin(); itInputList != fInputList.end(); ++itInputList)
   {
-    iterator = *itInputList;
+    DelphesCandidateSpan jets(*itInputList);
 
     // loop over all jets
-    iterator->Reset();
-    while((jet = static_cast<Candidate*>(iterator->Next())))
+    for(itJets = jets.begin(); itJets != jets.end(); ++itJets)
     {
-      TIter itConstituents(jet->GetCandidates());
+      jet = *itJets;
 
       if(jet->Momentum.Pt() <= fJetPTMin) continue;
 
+      DelphesCandidateSpan constituents(jet->GetCandidates());
+
       // loop over all constituents
-      while((constituent = static_cast<Candidate*>(itConstituents.Next())))
+      for(itConstituents = constituents.begin(); itConstituents != constituents.end(); ++itConstituents)
       {
+        constituent = *itConstituents;
         // set the IsConstituent flag
         constituent->IsConstituent = 1;
       }
@@ -138,13 +124,13 @@ void ConstituentFilter::Process()
   // loop over all constituent input arrays
   for(itInputMap = fInputMap.begin(); itInputMap != fInputMap.end(); ++itInputMap)
   {
-    iterator = itInputMap->first;
+    DelphesCandidateSpan constituents(itInputMap->first);
     array = itInputMap->second;
 
     // loop over all constituents
-    iterator->Reset();
-    while((constituent = static_cast<Candidate*>(iterator->Next())))
+    for(itConstituents = constituents.begin(); itConstituents != constituents.end(); ++itConstituents)
     {
+      constituent = *itConstituents;
       // check the IsConstituent flag
       if(constituent->IsConstituent)
       {
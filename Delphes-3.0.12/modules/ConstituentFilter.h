@@ -16,9 +16,8 @@
 #include "classes/DelphesModule.h"
 
 #include <vector>
-#include <map>
+#include <utility>
 
-class TIterator;
 class TObjArray;
 
 class ConstituentFilter: public DelphesModule
@@ -36,9 +35,9 @@ private:
 
   Double_t fJetPTMin;
 
-  std::vector< TIterator * > fInputList; //!
+  std::vector< const TObjArray * > fInputList; //!
 
-  std::map< TIterator *, TObjArray * > fInputMap; //!
+  std::vector< std::pair< const TObjArray *, TObjArray * > > fInputMap; //!
 
   TObjArray *fOutputArray; //!
 
@@ -17,6 +17,7 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesScheduler.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -44,8 +45,11 @@
 
 using namespace std;
 
+//------------------------------------------------------------------------------
+
 Delphes::Delphes(const char *name) :
-  fFactory(0)
+  fFactory(0), fScheduler(0), fNumberOfModuleThreads(1),
+  fRandomPerEvent(kFALSE), fEventNumber(0), fRandomSeed(0)
 {
   TFolder *folder = new TFolder(name, "");
   fFactory = new DelphesFactory("ObjectFactory");
@@ -63,6 +67,7 @@ Delphes::Delphes(const char *name) :
 
 Delphes::~Delphes()
 {
+  if(fScheduler) delete fScheduler;
   if(fFactory) delete fFactory;
   TFolder *folder = GetFolder();
   if(folder)
@@ -89,6 +94,55 @@ void Delphes::SetTreeWriter(ExRootTreeWriter *treeWriter)
 
 //------------------------------------------------------------------------------
 
+Delphes *Delphes::NewChain()
+{
+  TObject *object;
+  TFolder *folder;
+  ExRootTreeWriter *treeWriter;
+  Delphes *chain = new Delphes(GetName());
+
+  chain->SetConfReader(GetConfReader());
+
+  treeWriter = static_cast<ExRootTreeWriter *>(GetObject("TreeWriter", ExRootTreeWriter::Class()));
+  if(treeWriter) chain->SetTreeWriter(treeWriter);
+
+  // all chains fill the branches created by this chain
+  chain->SetSharedBranches(kTRUE);
+
+  // export the same input arrays as this chain
+  folder = static_cast<TFolder *>(GetObject(Form("Export/%s", GetName()), TFolder::Class()));
+  if(folder)
+  {
+    TIter itArrays(folder->GetListOfFolders());
+    while((object = itArrays.Next()))
+    {
+      chain->ExportArray(object->GetName());
+    }
+  }
+
+  chain->InitTask();
+
+  return chain;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t Delphes::IsArrayImported(TObjArray *array)
+{
+  TIter itTasks(GetListOfTasks());
+  TObject *task;
+
+  while((task = itTasks.Next()))
+  {
+    if(!task->InheritsFrom(DelphesModule::Class())) continue;
+    if(static_cast<DelphesModule *>(task)->GetImportedArrays().count(array) > 0) return kTRUE;
+  }
+
+  return kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
 void Delphes::Init()
 {
   stringstream message;
@@ -104,7 +158,17 @@ void Delphes::Init()
   ExRootConfParam param = confReader->GetParam("::ExecutionPath");
   Long_t i, size = param.GetSize();
 
-  gRandom->SetSeed(confReader->GetInt("::RandomSeed", 0));
+  fRandomSeed = confReader->GetInt("::RandomSeed", 0);
+  gRandom->SetSeed(fRandomSeed);
+
+  fNumberOfModuleThreads = confReader->GetInt("::NumModuleThreads", 1);
+
+  // with per-event seeds, every module gets its own random sequence
+  // for every event so that results do not depend on the order of processing
+  fRandomPerEvent = confReader->GetBool("::RandomSeedPerEvent", false) ||
+    confReader->GetInt("::NumThreads", 1) > 1 || fNumberOfModuleThreads > 1;
+
+  fEventNumber = confReader->GetInt("::SkipEvents", 0);
 
   for(i = 0; i < size; ++i)
   {
@@ -116,6 +180,10 @@ void Delphes::Init()
       if(task)
       {
         task->SetFolder(GetFolder());
+        if(fSharedBranches && task->InheritsFrom(DelphesModule::Class()))
+        {
+          static_cast<DelphesModule *>(task)->SetSharedBranches(kTRUE);
+        }
         Add(task);
       }
     }
@@ -130,8 +198,90 @@ void Delphes::Init()
 
 //------------------------------------------------------------------------------
 
+void Delphes::SplitModules()
+{
+  TIter itTasks(GetListOfTasks());
+  ExRootTask *task;
+  bool output = false;
+
+  fProcessModules.clear();
+  fOutputModules.clear();
+
+  // modules starting from the first one that writes to the output tree
+  // are executed in the output stage
+  while((task = static_cast<ExRootTask *>(itTasks.Next())))
+  {
+    if(!output && task->InheritsFrom(DelphesModule::Class()))
+    {
+      output = static_cast<DelphesModule *>(task)->GetTreeWriter() != 0;
+    }
+
+    if(output) fOutputModules.push_back(task);
+    else fProcessModules.push_back(task);
+  }
+
+  if(fNumberOfModuleThreads > 1 && !fScheduler)
+  {
+    fFactory->EnableLocking();
+
+    fScheduler = new DelphesScheduler(fNumberOfModuleThreads);
+    fScheduler->Build(fProcessModules);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Delphes::ProcessModules()
+{
+  vector< ExRootTask * >::iterator itModules;
+
+  if(fProcessModules.empty() && fOutputModules.empty()) SplitModules();
+
+  Process();
+
+  if(fScheduler)
+  {
+    fScheduler->Process();
+    return;
+  }
+
+  for(itModules = fProcessModules.begin(); itModules != fProcessModules.end(); ++itModules)
+  {
+    if((*itModules)->IsActive()) (*itModules)->Process();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Delphes::ProcessOutput()
+{
+  vector< ExRootTask * >::iterator itModules;
+
+  if(fProcessModules.empty() && fOutputModules.empty()) SplitModules();
+
+  for(itModules = fOutputModules.begin(); itModules != fOutputModules.end(); ++itModules)
+  {
+    if((*itModules)->IsActive()) (*itModules)->Process();
+  }
+}
+
+//------------------------------------------------------------------------------
+
 void Delphes::Process()
 {
+  TIter itTasks(GetListOfTasks());
+  TObject *task;
+
+  if(fRandomPerEvent)
+  {
+    while((task = itTasks.Next()))
+    {
+      if(!task->InheritsFrom(DelphesModule::Class())) continue;
+      static_cast<DelphesModule *>(task)->SetRandomEvent(fRandomSeed, fEventNumber);
+    }
+  }
+
+  ++fEventNumber;
 }
 
 //------------------------------------------------------------------------------
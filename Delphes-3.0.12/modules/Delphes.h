@@ -16,12 +16,15 @@
 
 #include "classes/DelphesModule.h"
 
+#include <vector>
+
 class TFolder;
 class TObjArray;
 
 class ExRootTreeWriter;
 
 class DelphesFactory;
+class DelphesScheduler;
 
 class Delphes: public DelphesModule
 {
@@ -34,6 +37,21 @@ public:
   
   DelphesFactory *GetFactory() const { return fFactory; }
 
+  // creates an independent module chain with the same configuration,
+  // the same exported arrays and its own object factory
+  Delphes *NewChain();
+
+  // true when a module of this chain imports the array in its Init,
+  // readers do not fill the arrays that nobody reads
+  Bool_t IsArrayImported(TObjArray *array);
+
+  void SetEventNumber(Long64_t eventNumber) { fEventNumber = eventNumber; }
+  Long64_t GetEventNumber() const { return fEventNumber; }
+
+  // ProcessTask() is equivalent to ProcessModules() followed by ProcessOutput()
+  void ProcessModules();
+  void ProcessOutput();
+
   void Clear();
 
   virtual void Init();
@@ -42,8 +60,23 @@ public:
 
 private:
 
+  void SplitModules();
+
   DelphesFactory *fFactory;
 
+  DelphesScheduler *fScheduler; //!
+
+  Int_t fNumberOfModuleThreads; //!
+
+  Bool_t fRandomPerEvent; //!
+
+  Long64_t fEventNumber; //!
+
+  UInt_t fRandomSeed; //!
+
+  std::vector< ExRootTask * > fProcessModules; //!
+  std::vector< ExRootTask * > fOutputModules; //!
+
   ClassDef(Delphes, 1)
 };
 
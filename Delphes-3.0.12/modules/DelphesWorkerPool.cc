@@ -0,0 +1,371 @@
+
+/** \class DelphesWorkerPool
+ *
+ *  Runs independent Delphes module chains in worker threads.
+ *  Events are dispatched to the chains in round-robin order and
+ *  the output stage (modules starting from TreeWriter) is executed
+ *  in a writer thread in the original event order.
+ *  With read-ahead, there are more chains than processing threads,
+ *  so that the calling thread can read the next events while
+ *  the current ones are processed and written out.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "modules/DelphesWorkerPool.h"
+
+#include "modules/Delphes.h"
+#include "classes/DelphesClasses.h"
+
+#include "ExRootAnalysis/ExRootTreeWriter.h"
+#include "ExRootAnalysis/ExRootTreeBranch.h"
+
+#include "TClass.h"
+#include "TString.h"
+#include "TMutex.h"
+#include "TThread.h"
+#include "TCondition.h"
+#include "TStopwatch.h"
+#include "TObjArray.h"
+#include "TBufferFile.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+DelphesWorkerPool::DelphesWorkerPool(Delphes *delphes, ExRootTreeWriter *treeWriter, Int_t numberOfWorkers, Int_t readAhead) :
+  fTreeWriter(treeWriter), fCurrent(0), fEventNumber(0),
+  fSubmitted(0), fStarted(0), fWritten(0), fMaxRunning(0), fRunning(0),
+  fStop(kFALSE), fWriter(0), fMutex(0), fCondition(0)
+{
+  Int_t i, numberOfChains;
+  Worker *worker;
+
+  if(numberOfWorkers < 1) numberOfWorkers = 1;
+  if(readAhead < 0) readAhead = 0;
+
+  fMaxRunning = numberOfWorkers;
+  numberOfChains = numberOfWorkers + readAhead;
+
+  TThread::Initialize();
+
+  fMutex = new TMutex;
+  fCondition = new TCondition(fMutex);
+
+  fEventNumber = delphes->GetEventNumber();
+
+  for(i = 0; i < numberOfChains; ++i)
+  {
+    worker = new Worker;
+    worker->pool = this;
+    worker->delphes = (i == 0) ? delphes : delphes->NewChain();
+    worker->state = kIdle;
+    worker->sequence = -1;
+    worker->procTime = 0.0;
+    worker->thread = new TThread(Form("DelphesWorker%d", i), &DelphesWorkerPool::Run, worker);
+    fWorkers.push_back(worker);
+  }
+
+  fWriter = new TThread("DelphesWriter", &DelphesWorkerPool::Write, this);
+
+  for(i = 0; i < numberOfChains; ++i)
+  {
+    fWorkers[i]->thread->Run();
+  }
+
+  fWriter->Run();
+}
+
+//------------------------------------------------------------------------------
+
+DelphesWorkerPool::~DelphesWorkerPool()
+{
+  vector< Worker * >::iterator itWorkers;
+  map< ExRootTreeBranch *, ExRootTreeBranch * >::iterator itBranches;
+  Worker *worker;
+
+  fMutex->Lock();
+  fStop = kTRUE;
+  fCondition->Broadcast();
+  fMutex->UnLock();
+
+  fWriter->Join();
+  delete fWriter;
+
+  for(itWorkers = fWorkers.begin(); itWorkers != fWorkers.end(); ++itWorkers)
+  {
+    worker = *itWorkers;
+    worker->thread->Join();
+    delete worker->thread;
+
+    for(itBranches = worker->branches.begin(); itBranches != worker->branches.end(); ++itBranches)
+    {
+      delete itBranches->second;
+    }
+
+    if(itWorkers != fWorkers.begin()) delete worker->delphes;
+
+    delete worker;
+  }
+
+  delete fCondition;
+  delete fMutex;
+}
+
+//------------------------------------------------------------------------------
+
+void *DelphesWorkerPool::Run(void *arg)
+{
+  Worker *worker = static_cast<Worker *>(arg);
+  DelphesWorkerPool *pool = worker->pool;
+  TStopwatch stopWatch;
+
+  while(true)
+  {
+    pool->fMutex->Lock();
+    // chains start in submission order, at most fMaxRunning at a time
+    while(!pool->fStop && (worker->state != kQueued ||
+      worker->sequence != pool->fStarted || pool->fRunning >= pool->fMaxRunning))
+    {
+      pool->fCondition->Wait();
+    }
+    if(pool->fStop)
+    {
+      pool->fMutex->UnLock();
+      break;
+    }
+    ++pool->fStarted;
+    ++pool->fRunning;
+    pool->fCondition->Broadcast();
+    pool->fMutex->UnLock();
+
+    worker->error.clear();
+
+    stopWatch.Start();
+    try
+    {
+      worker->delphes->ProcessModules();
+    }
+    catch(runtime_error &e)
+    {
+      worker->error = e.what();
+    }
+    stopWatch.Stop();
+
+    worker->procTime = stopWatch.RealTime();
+
+    pool->fMutex->Lock();
+    worker->state = kDone;
+    --pool->fRunning;
+    pool->fCondition->Broadcast();
+    pool->fMutex->UnLock();
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
+void *DelphesWorkerPool::Write(void *arg)
+{
+  DelphesWorkerPool *pool = static_cast<DelphesWorkerPool *>(arg);
+  Worker *worker;
+
+  while(true)
+  {
+    pool->fMutex->Lock();
+    // events are written out in submission order
+    while(!pool->fStop && (pool->fWritten == pool->fSubmitted ||
+      pool->fWorkers[pool->fWritten % pool->fWorkers.size()]->state != kDone))
+    {
+      pool->fCondition->Wait();
+    }
+    if(pool->fStop)
+    {
+      pool->fMutex->UnLock();
+      break;
+    }
+    worker = pool->fWorkers[pool->fWritten % pool->fWorkers.size()];
+    pool->fMutex->UnLock();
+
+    pool->Output(worker);
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
+Delphes *DelphesWorkerPool::GetDelphes() const
+{
+  return fWorkers[fCurrent]->delphes;
+}
+
+//------------------------------------------------------------------------------
+
+Int_t DelphesWorkerPool::ImportArray(const char *name)
+{
+  vector< Worker * >::iterator itWorkers;
+
+  for(itWorkers = fWorkers.begin(); itWorkers != fWorkers.end(); ++itWorkers)
+  {
+    (*itWorkers)->arrays.push_back((*itWorkers)->delphes->ImportArray(name));
+  }
+
+  return fWorkers.front()->arrays.size() - 1;
+}
+
+//------------------------------------------------------------------------------
+
+TObjArray *DelphesWorkerPool::GetArray(Int_t index) const
+{
+  return fWorkers[fCurrent]->arrays[index];
+}
+
+//------------------------------------------------------------------------------
+
+ExRootTreeBranch *DelphesWorkerPool::GetBranch(ExRootTreeBranch *branch)
+{
+  Worker *worker = fWorkers[fCurrent];
+  map< ExRootTreeBranch *, ExRootTreeBranch * >::iterator itBranches;
+
+  itBranches = worker->branches.find(branch);
+  if(itBranches == worker->branches.end())
+  {
+    itBranches = worker->branches.insert(make_pair(branch,
+      new ExRootTreeBranch(branch->GetName(), branch->GetClass(), 0))).first;
+  }
+
+  return itBranches->second;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesWorkerPool::Submit()
+{
+  Worker *worker = fWorkers[fCurrent];
+
+  worker->delphes->SetEventNumber(fEventNumber++);
+
+  fMutex->Lock();
+  worker->sequence = fSubmitted++;
+  worker->state = kQueued;
+  fCondition->Broadcast();
+
+  fCurrent = (fCurrent + 1) % fWorkers.size();
+
+  // the next chain still holds the oldest event until it is written out
+  worker = fWorkers[fCurrent];
+  while(worker->state != kIdle && fError.empty()) fCondition->Wait();
+
+  CheckError();
+  fMutex->UnLock();
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesWorkerPool::Finish()
+{
+  fMutex->Lock();
+  while(fWritten < fSubmitted && fError.empty()) fCondition->Wait();
+
+  CheckError();
+  fMutex->UnLock();
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesWorkerPool::CheckError()
+{
+  string error;
+
+  if(fError.empty()) return;
+
+  error = fError;
+  fMutex->UnLock();
+
+  throw runtime_error(error);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesWorkerPool::FinishTask()
+{
+  vector< Worker * >::iterator itWorkers;
+
+  for(itWorkers = fWorkers.begin() + 1; itWorkers < fWorkers.end(); ++itWorkers)
+  {
+    (*itWorkers)->delphes->FinishTask();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesWorkerPool::Output(Worker *worker)
+{
+  map< ExRootTreeBranch *, ExRootTreeBranch * >::iterator itBranches;
+  ExRootTreeBranch *branch, *staging;
+  TObject *object, *entry;
+  Int_t i;
+
+  if(worker->error.empty())
+  {
+    try
+    {
+      worker->delphes->ProcessOutput();
+
+      // copy the records filled by the reader into the output branches
+      for(itBranches = worker->branches.begin(); itBranches != worker->branches.end(); ++itBranches)
+      {
+        branch = itBranches->first;
+        staging = itBranches->second;
+        for(i = 0; i < staging->GetEntries(); ++i)
+        {
+          object = staging->At(i);
+          entry = branch->NewEntry();
+
+          TBufferFile buffer(TBuffer::kWrite);
+          object->Streamer(buffer);
+          buffer.SetReadMode();
+          buffer.SetBufferOffset(0);
+          entry->Streamer(buffer);
+
+          if(entry->InheritsFrom(Event::Class()))
+          {
+            static_cast<Event *>(entry)->ProcTime = worker->procTime;
+          }
+        }
+      }
+
+      fTreeWriter->Fill();
+    }
+    catch(runtime_error &e)
+    {
+      worker->error = e.what();
+    }
+  }
+
+  for(itBranches = worker->branches.begin(); itBranches != worker->branches.end(); ++itBranches)
+  {
+    itBranches->second->Clear();
+  }
+
+  fTreeWriter->Clear();
+
+  worker->delphes->Clear();
+
+  fMutex->Lock();
+  if(fError.empty()) fError = worker->error;
+  worker->state = kIdle;
+  ++fWritten;
+  fCondition->Broadcast();
+  fMutex->UnLock();
+}
+
+//------------------------------------------------------------------------------
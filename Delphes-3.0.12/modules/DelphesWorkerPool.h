@@ -0,0 +1,115 @@
+#ifndef DelphesWorkerPool_h
+#define DelphesWorkerPool_h
+
+/** \class DelphesWorkerPool
+ *
+ *  Runs independent Delphes module chains in worker threads.
+ *  Events are dispatched to the chains in round-robin order and
+ *  the output stage (modules starting from TreeWriter) is executed
+ *  in a writer thread in the original event order.
+ *  With read-ahead, there are more chains than processing threads,
+ *  so that the calling thread can read the next events while
+ *  the current ones are processed and written out.
+ *
+ *  $Date$
+ *  $Revision$
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+class TThread;
+class TMutex;
+class TCondition;
+class TObjArray;
+
+class Delphes;
+class ExRootTreeWriter;
+class ExRootTreeBranch;
+
+class DelphesWorkerPool
+{
+public:
+
+  // numberOfWorkers chains are processed at the same time,
+  // readAhead more chains can be filled by the calling thread in the meantime
+  DelphesWorkerPool(Delphes *delphes, ExRootTreeWriter *treeWriter, Int_t numberOfWorkers, Int_t readAhead = 0);
+  ~DelphesWorkerPool();
+
+  // chain that receives the next event
+  Delphes *GetDelphes() const;
+
+  // imports an array in all chains once, returns its index for GetArray
+  Int_t ImportArray(const char *name);
+
+  // array of the chain that receives the next event
+  TObjArray *GetArray(Int_t index) const;
+
+  // staging branch of the next event for records filled by the reader
+  ExRootTreeBranch *GetBranch(ExRootTreeBranch *branch);
+
+  // queues the next event and waits until the next chain has been written out
+  void Submit();
+
+  // waits until all queued events have been written out
+  void Finish();
+
+  // finishes all chains except the first one
+  void FinishTask();
+
+private:
+
+  enum EState { kIdle, kQueued, kDone };
+
+  struct Worker
+  {
+    DelphesWorkerPool *pool;
+    Delphes *delphes;
+    TThread *thread;
+
+    EState state;
+    Long64_t sequence;
+    Double_t procTime;
+    std::string error;
+
+    std::map< ExRootTreeBranch *, ExRootTreeBranch * > branches;
+
+    // input arrays filled by the reader
+    std::vector< TObjArray * > arrays;
+  };
+
+  static void *Run(void *arg);
+  static void *Write(void *arg);
+
+  void Output(Worker *worker);
+
+  // throws the first error reported by the chains, called with fMutex locked
+  void CheckError();
+
+  ExRootTreeWriter *fTreeWriter;
+
+  std::vector< Worker * > fWorkers;
+  std::vector< Worker * >::size_type fCurrent;
+
+  Long64_t fEventNumber;
+
+  // events submitted, started and written out, in submission order
+  Long64_t fSubmitted, fStarted, fWritten;
+
+  Int_t fMaxRunning, fRunning;
+
+  Bool_t fStop;
+
+  std::string fError;
+
+  TThread *fWriter;
+
+  TMutex *fMutex;
+  TCondition *fCondition;
+};
+
+#endif /* DelphesWorkerPool_h */
@@ -15,7 +15,6 @@
 
 #include "classes/DelphesModule.h"
 
-class TIterator;
 class TObjArray;
 class DelphesFormula;
 
@@ -34,8 +33,6 @@ private:
 
   DelphesFormula *fFormula; //!
 
-  TIterator *fItInputArray; //!
-
   const TObjArray *fInputArray; //!
 
   TObjArray *fOutputArray; //!
@@ -14,6 +14,7 @@
 #include "modules/EnergyScale.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -39,7 +40,7 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 EnergyScale::EnergyScale() :
-  fFormula(0), fItInputArray(0)
+  fFormula(0)
 {
   fFormula = new DelphesFormula;
 }
@@ -62,7 +63,6 @@ void EnergyScale::Init()
   // import input array
 
   fInputArray = ImportArray(GetString("InputArray", "FastJetFinder/jets"));
-  fItInputArray = fInputArray->MakeIterator();
 
   // create output array
 
@@ -73,7 +73,6 @@ void EnergyScale::Init()
 
 void EnergyScale::Finish()
 {
-  if(fItInputArray) delete fItInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -84,9 +83,11 @@ void EnergyScale::Process()
   TLorentzVector momentum;
   Double_t scale;
   
-  fItInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItInputArray->Next())))
+  DelphesCandidateSpan inputArray(fInputArray);
+  DelphesCandidateSpan::iterator itInputArray;
+  for(itInputArray = inputArray.begin(); itInputArray != inputArray.end(); ++itInputArray)
   {
+    candidate = *itInputArray;
     momentum = candidate->Momentum;
 
     scale = fFormula->Eval(momentum.Pt(), momentum.Eta());
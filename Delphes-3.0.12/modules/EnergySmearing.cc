@@ -14,6 +14,7 @@
 #include "modules/EnergySmearing.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -39,7 +40,7 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 EnergySmearing::EnergySmearing() :
-  fFormula(0), fItInputArray(0)
+  fFormula(0)
 {
   fFormula = new DelphesFormula;
 }
@@ -62,7 +63,6 @@ void EnergySmearing::Init()
   // import input array
 
   fInputArray = ImportArray(GetString("InputArray", "ParticlePropagator/stableParticles"));
-  fItInputArray = fInputArray->MakeIterator();
 
   // create output array
 
@@ -73,7 +73,6 @@ void EnergySmearing::Init()
 
 void EnergySmearing::Finish()
 {  
-  if(fItInputArray) delete fItInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -83,9 +82,11 @@ void EnergySmearing::Process()
   Candidate *candidate, *mother;
   Double_t energy, eta, phi;
 
-  fItInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItInputArray->Next())))
+  DelphesCandidateSpan inputArray(fInputArray);
+  DelphesCandidateSpan::iterator itInputArray;
+  for(itInputArray = inputArray.begin(); itInputArray != inputArray.end(); ++itInputArray)
   {
+    candidate = *itInputArray;
     const TLorentzVector &candidatePosition = candidate->Position;
     const TLorentzVector &candidateMomentum = candidate->Momentum;
     eta = candidatePosition.Eta();
@@ -93,7 +94,7 @@ void EnergySmearing::Process()
     energy = candidateMomentum.E();
  
     // apply smearing formula
-    energy = gRandom->Gaus(energy, fFormula->Eval(0.0, eta, 0.0, energy));
+    energy = GetRandom()->Gaus(energy, fFormula->Eval(0.0, eta, 0.0, energy));
      
     if(energy <= 0.0) continue;
  
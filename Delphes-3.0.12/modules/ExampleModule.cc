@@ -14,6 +14,7 @@
 #include "modules/ExampleModule.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -39,7 +40,7 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 ExampleModule::ExampleModule() :
-  fFormula(0), fItInputArray(0)
+  fFormula(0)
 {
   fFormula = new DelphesFormula;
 }
@@ -76,7 +77,6 @@ void ExampleModule::Init()
   // import input array(s)
 
   fInputArray = ImportArray(GetString("InputArray", "FastJetFinder/jets"));
-  fItInputArray = fInputArray->MakeIterator();
 
   // create output array(s)
 
@@ -88,7 +88,6 @@ void ExampleModule::Init()
 
 void ExampleModule::Finish()
 {
-  if(fItInputArray) delete fItInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -99,14 +98,16 @@ void ExampleModule::Process()
   TLorentzVector candidatePosition, candidateMomentum;
 
   // loop over all input candidates
-  fItInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItInputArray->Next())))
+  DelphesCandidateSpan inputArray(fInputArray);
+  DelphesCandidateSpan::iterator itInputArray;
+  for(itInputArray = inputArray.begin(); itInputArray != inputArray.end(); ++itInputArray)
   {
+    candidate = *itInputArray;
     candidatePosition = candidate->Position;
     candidateMomentum = candidate->Momentum;
 
     // apply an efficency formula
-    if(gRandom->Uniform() <= fFormula->Eval(candidateMomentum.Pt(), candidatePosition.Eta()))
+    if(GetRandom()->Uniform() <= fFormula->Eval(candidateMomentum.Pt(), candidatePosition.Eta()))
     {
       fOutputArray->Add(candidate);
     }
@@ -40,8 +40,6 @@ private:
   
   DelphesFormula *fFormula; //!
 
-  TIterator *fItInputArray; //!
-
   const TObjArray *fInputArray; //!
 
   TObjArray *fOutputArray; //!
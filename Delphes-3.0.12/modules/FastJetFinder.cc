@@ -14,6 +14,7 @@
 #include "modules/FastJetFinder.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -52,7 +53,7 @@ using namespace fastjet;
 //------------------------------------------------------------------------------
 
 FastJetFinder::FastJetFinder() :
-  fPlugin(0), fDefinition(0), fAreaDefinition(0), fItInputArray(0)
+  fPlugin(0), fDefinition(0), fAreaDefinition(0)
 {
 
 }
@@ -167,7 +168,6 @@ void FastJetFinder::Init()
   // import input array
 
   fInputArray = ImportArray(GetString("InputArray", "Calorimeter/towers"));
-  fItInputArray = fInputArray->MakeIterator();
 
   // create output arrays
 
@@ -179,7 +179,6 @@ void FastJetFinder::Init()
 
 void FastJetFinder::Finish()
 {
-  if(fItInputArray) delete fItInputArray;
   if(fDefinition) delete fDefinition;
   if(fAreaDefinition) delete fAreaDefinition;
   if(fPlugin) delete static_cast<JetDefinition::Plugin*>(fPlugin);
@@ -205,10 +204,12 @@ void FastJetFinder::Process()
   inputList.clear();
 
   // loop over input objects
-  fItInputArray->Reset();
+  DelphesCandidateSpan inputArray(fInputArray);
+  DelphesCandidateSpan::iterator itInputArray;
   number = 0;
-  while((candidate = static_cast<Candidate*>(fItInputArray->Next())))
+  for(itInputArray = inputArray.begin(); itInputArray != inputArray.end(); ++itInputArray)
   {
+    candidate = *itInputArray;
     momentum = candidate->Momentum;
     jet = PseudoJet(momentum.Px(), momentum.Py(), momentum.Pz(), momentum.E());
     jet.set_user_index(number);
@@ -238,8 +239,8 @@ void FastJetFinder::Process()
 
       candidate = factory->NewCandidate();
       candidate->Momentum.SetPtEtaPhiE(rho, 0.0, 0.0, rho);
-      candidate->Edges[0] = itEtaRangeMap->first;
-      candidate->Edges[1] = itEtaRangeMap->second;
+      candidate->Tower().Edges[0] = itEtaRangeMap->first;
+      candidate->Tower().Edges[1] = itEtaRangeMap->second;
       fRhoOutputArray->Add(candidate);
     }
   }
@@ -283,10 +284,10 @@ void FastJetFinder::Process()
 
     candidate->Momentum = momentum;
     candidate->Position.SetT(avTime);
-    candidate->Area.SetPxPyPzE(area.px(), area.py(), area.pz(), area.E());
+    candidate->Jet().Area.SetPxPyPzE(area.px(), area.py(), area.pz(), area.E());
 
-    candidate->DeltaEta = detaMax;
-    candidate->DeltaPhi = dphiMax;
+    candidate->Jet().DeltaEta = detaMax;
+    candidate->Jet().DeltaPhi = dphiMax;
 
     fOutputArray->Add(candidate);
   }
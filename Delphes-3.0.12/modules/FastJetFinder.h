@@ -18,7 +18,6 @@
 #include <map>
 
 class TObjArray;
-class TIterator;
 
 namespace fastjet {
   class JetDefinition;
@@ -73,8 +72,6 @@ private:
 
   std::map< Double_t, Double_t > fEtaRangeMap; //!
 
-  TIterator *fItInputArray; //!
-
   const TObjArray *fInputArray; //!
 
   TObjArray *fOutputArray; //!
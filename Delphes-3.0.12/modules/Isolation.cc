@@ -17,8 +17,10 @@
 #include "modules/Isolation.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesEtaPhiGrid.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -67,9 +69,7 @@ Int_t IsolationClassifier::GetCategory(TObject *object)
 //------------------------------------------------------------------------------
 
 Isolation::Isolation() :
-  fClassifier(0), fFilter(0),
-  fItIsolationInputArray(0), fItCandidateInputArray(0),
-  fItRhoInputArray(0)
+  fClassifier(0), fFilter(0), fGrid(0)
 {
   fClassifier = new IsolationClassifier;
 }
@@ -99,18 +99,17 @@ void Isolation::Init()
   // import input array(s)
 
   fIsolationInputArray = ImportArray(GetString("IsolationInputArray", "Delphes/partons"));
-  fItIsolationInputArray = fIsolationInputArray->MakeIterator();
 
   fFilter = new ExRootFilter(fIsolationInputArray);
 
+  fGrid = new DelphesEtaPhiGrid(fDeltaRMax);
+
   fCandidateInputArray = ImportArray(GetString("CandidateInputArray", "Calorimeter/electrons"));
-  fItCandidateInputArray = fCandidateInputArray->MakeIterator();
 
   rhoInputArrayName = GetString("RhoInputArray", "");
   if(rhoInputArrayName[0] != '\0')
   {
     fRhoInputArray = ImportArray(rhoInputArrayName);
-    fItRhoInputArray = fRhoInputArray->MakeIterator();
   }
   else
   {
@@ -126,10 +125,8 @@ void Isolation::Init()
 
 void Isolation::Finish()
 {
-  if(fItRhoInputArray) delete fItRhoInputArray;
   if(fFilter) delete fFilter;
-  if(fItCandidateInputArray) delete fItCandidateInputArray;
-  if(fItIsolationInputArray) delete fItIsolationInputArray;
+  if(fGrid) delete fGrid;
 }
 
 //------------------------------------------------------------------------------
@@ -140,6 +137,7 @@ void Isolation::Process()
   TObjArray *isolationArray;
   Double_t sum, ratio;
   Int_t counter;
+  vector< Int_t >::iterator itNeighbours;
   Double_t eta = 0.0;
   Double_t rho = 0.0;
 
@@ -155,21 +153,24 @@ void Isolation::Process()
 
   if(isolationArray == 0) return;
 
-  TIter itIsolationArray(isolationArray);
+  fGrid->Fill(isolationArray);
 
   // loop over all input jets
-  fItCandidateInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItCandidateInputArray->Next())))
+  DelphesCandidateSpan candidateInputArray(fCandidateInputArray);
+  DelphesCandidateSpan::iterator itCandidateInputArray;
+  for(itCandidateInputArray = candidateInputArray.begin(); itCandidateInputArray != candidateInputArray.end(); ++itCandidateInputArray)
   {
+    candidate = *itCandidateInputArray;
     const TLorentzVector &candidateMomentum = candidate->Momentum;
-    eta = TMath::Abs(candidateMomentum.Eta());
+    eta = candidateMomentum.Eta();
 
-    // loop over all input tracks
+    // loop over the input tracks close to the candidate
     sum = 0.0;
     counter = 0;
-    itIsolationArray.Reset();
-    while((isolation = static_cast<Candidate*>(itIsolationArray.Next())))
+    fGrid->Find(eta, candidateMomentum.Phi(), fDeltaRMax, fNeighbours);
+    for(itNeighbours = fNeighbours.begin(); itNeighbours != fNeighbours.end(); ++itNeighbours)
     {
+      isolation = static_cast<Candidate*>(isolationArray->UncheckedAt(*itNeighbours));
       const TLorentzVector &isolationMomentum = isolation->Momentum;
 
       if(candidateMomentum.DeltaR(isolationMomentum) <= fDeltaRMax &&
@@ -181,13 +182,16 @@ void Isolation::Process()
     }
 
     // find rho
+    eta = TMath::Abs(eta);
     rho = 0.0;
     if(fRhoInputArray)
     {
-      fItRhoInputArray->Reset();
-      while((object = static_cast<Candidate*>(fItRhoInputArray->Next())))
+      DelphesCandidateSpan rhoInputArray(fRhoInputArray);
+      DelphesCandidateSpan::iterator itRhoInputArray;
+      for(itRhoInputArray = rhoInputArray.begin(); itRhoInputArray != rhoInputArray.end(); ++itRhoInputArray)
       {
-        if(eta >= object->Edges[0] && eta < object->Edges[1])
+        object = *itRhoInputArray;
+        if(eta >= object->GetTower().Edges[0] && eta < object->GetTower().Edges[1])
         {
           rho = object->Momentum.Pt();
         }
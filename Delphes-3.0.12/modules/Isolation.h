@@ -18,10 +18,13 @@
 
 #include "classes/DelphesModule.h"
 
+#include <vector>
+
 class TObjArray;
 
 class ExRootFilter;
 class IsolationClassifier;
+class DelphesEtaPhiGrid;
 
 class Isolation: public DelphesModule
 {
@@ -48,11 +51,9 @@ private:
 
   ExRootFilter *fFilter;
 
-  TIterator *fItIsolationInputArray; //!
-
-  TIterator *fItCandidateInputArray; //!
+  DelphesEtaPhiGrid *fGrid; //!
 
-  TIterator *fItRhoInputArray; //!
+  std::vector< Int_t > fNeighbours; //!
 
   const TObjArray *fIsolationInputArray; //!
 
@@ -13,6 +13,7 @@
 #include "modules/JetPileUpSubtractor.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -37,8 +38,7 @@ using namespace std;
 
 //------------------------------------------------------------------------------
 
-JetPileUpSubtractor::JetPileUpSubtractor() :
-  fItJetInputArray(0), fItRhoInputArray(0)
+JetPileUpSubtractor::JetPileUpSubtractor()
 {
 
 }
@@ -59,10 +59,8 @@ void JetPileUpSubtractor::Init()
   // import input array(s)
 
   fJetInputArray = ImportArray(GetString("JetInputArray", "FastJetFinder/jets"));
-  fItJetInputArray = fJetInputArray->MakeIterator();
 
   fRhoInputArray = ImportArray(GetString("RhoInputArray", "Rho/rho"));
-  fItRhoInputArray = fRhoInputArray->MakeIterator();
 
   // create output array(s)
 
@@ -74,8 +72,6 @@ void JetPileUpSubtractor::Init()
 
 void JetPileUpSubtractor::Finish()
 {
-  if(fItRhoInputArray) delete fItRhoInputArray;
-  if(fItJetInputArray) delete fItJetInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -88,21 +84,25 @@ void JetPileUpSubtractor::Process()
   Double_t rho = 0.0;
 
   // loop over all input candidates
-  fItJetInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItJetInputArray->Next())))
+  DelphesCandidateSpan jetInputArray(fJetInputArray);
+  DelphesCandidateSpan::iterator itJetInputArray;
+  for(itJetInputArray = jetInputArray.begin(); itJetInputArray != jetInputArray.end(); ++itJetInputArray)
   {
+    candidate = *itJetInputArray;
     momentum = candidate->Momentum;
-    area = candidate->Area;
+    area = candidate->GetJet().Area;
     eta = TMath::Abs(momentum.Eta());
 
     // find rho
     rho = 0.0;
     if(fRhoInputArray)
     {
-      fItRhoInputArray->Reset();
-      while((object = static_cast<Candidate*>(fItRhoInputArray->Next())))
+      DelphesCandidateSpan rhoInputArray(fRhoInputArray);
+      DelphesCandidateSpan::iterator itRhoInputArray;
+      for(itRhoInputArray = rhoInputArray.begin(); itRhoInputArray != rhoInputArray.end(); ++itRhoInputArray)
       {
-        if(eta >= object->Edges[0] && eta < object->Edges[1])
+        object = *itRhoInputArray;
+        if(eta >= object->GetTower().Edges[0] && eta < object->GetTower().Edges[1])
         {
           rho = object->Momentum.Pt();
         }
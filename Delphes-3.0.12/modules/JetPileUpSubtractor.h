@@ -34,9 +34,6 @@ private:
 
   Double_t fJetPTMin;
 
-  TIterator *fItJetInputArray; //!
-  TIterator *fItRhoInputArray; //!
-
   const TObjArray *fJetInputArray; //!
   const TObjArray *fRhoInputArray; //!
 
@@ -12,8 +12,10 @@
 #include "modules/LeptonDressing.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesEtaPhiGrid.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -37,7 +39,7 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 LeptonDressing::LeptonDressing() :
- fItDressingInputArray(0), fItCandidateInputArray(0)
+ fGrid(0)
 {
 }
 
@@ -56,10 +58,10 @@ void LeptonDressing::Init()
   // import input array(s)
 
   fDressingInputArray = ImportArray(GetString("DressingInputArray", "Calorimeter/photons"));
-  fItDressingInputArray = fDressingInputArray->MakeIterator();
+
+  fGrid = new DelphesEtaPhiGrid(fDeltaR);
   
   fCandidateInputArray = ImportArray(GetString("CandidateInputArray", "UniqueObjectFinder/electrons"));
-  fItCandidateInputArray = fCandidateInputArray->MakeIterator();
   
   // create output array
 
@@ -70,8 +72,7 @@ void LeptonDressing::Init()
 
 void LeptonDressing::Finish()
 {
-  if(fItCandidateInputArray) delete fItCandidateInputArray;
-  if(fItDressingInputArray) delete fItDressingInputArray;
+  if(fGrid) delete fGrid;
 }
 
 //------------------------------------------------------------------------------
@@ -80,18 +81,24 @@ void LeptonDressing::Process()
 {
   Candidate *candidate, *dressing, *mother;
   TLorentzVector momentum;
-  
+  vector< Int_t >::iterator itNeighbours;
+
+  fGrid->Fill(fDressingInputArray);
+
   // loop over all input candidate
-  fItCandidateInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItCandidateInputArray->Next())))
+  DelphesCandidateSpan candidateInputArray(fCandidateInputArray);
+  DelphesCandidateSpan::iterator itCandidateInputArray;
+  for(itCandidateInputArray = candidateInputArray.begin(); itCandidateInputArray != candidateInputArray.end(); ++itCandidateInputArray)
   {
+    candidate = *itCandidateInputArray;
     const TLorentzVector &candidateMomentum = candidate->Momentum;
 
-    // loop over all input tracks
-    fItDressingInputArray->Reset();
+    // loop over the input tracks close to the candidate
+    fGrid->Find(candidateMomentum.Eta(), candidateMomentum.Phi(), fDeltaR, fNeighbours);
     momentum.SetPxPyPzE(0.0, 0.0, 0.0, 0.0);
-    while((dressing = static_cast<Candidate*>(fItDressingInputArray->Next())))
+    for(itNeighbours = fNeighbours.begin(); itNeighbours != fNeighbours.end(); ++itNeighbours)
     {
+      dressing = static_cast<Candidate*>(fDressingInputArray->UncheckedAt(*itNeighbours));
       const TLorentzVector &dressingMomentum = dressing->Momentum;
       if (dressingMomentum.Pt() > 0.1)
       {
@@ -10,8 +10,10 @@
 
 #include "classes/DelphesModule.h"
 
-class TIterator;
+#include <vector>
+
 class TObjArray;
+class DelphesEtaPhiGrid;
 
 class LeptonDressing: public DelphesModule
 {
@@ -27,10 +29,11 @@ public:
 private:
 
   Double_t fDeltaR;
+
+  DelphesEtaPhiGrid *fGrid; //!
+
+  std::vector< Int_t > fNeighbours; //!
   
-  TIterator *fItDressingInputArray; //!
-  
-  TIterator *fItCandidateInputArray; //!
 
   const TObjArray *fDressingInputArray; //!
   
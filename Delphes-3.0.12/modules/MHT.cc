@@ -9,6 +9,7 @@
 #include "modules/MHT.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -34,8 +35,8 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 MHT::MHT() :
-  fJetInputArray(0),fItJetInputArray(0),fElectronInputArray(0),fItElectronInputArray(0),
-  fMuonInputArray(0),fItMuonInputArray(0),fPhotonInputArray(0),fItPhotonInputArray(0),
+  fJetInputArray(0),fElectronInputArray(0),
+  fMuonInputArray(0),fPhotonInputArray(0),
   fMomentumOutputArray(0),
   fJetSelectionFormula(0),fElectronSelectionFormula(0),fMuonSelectionFormula(0),fPhotonSelectionFormula(0)
 {
@@ -58,13 +59,10 @@ void MHT::Init()
   //Get input array names from the config file
   //The arguments to GetString are the name of the parameter whose value we want, and a default value in case the parameter is not present in the config file
   fElectronInputArray = ImportArray(GetString("ElectronInputArray", "UniqueObjectFinder/electrons"));
-  fItElectronInputArray = fElectronInputArray->MakeIterator();
 
   fMuonInputArray = ImportArray(GetString("MuonInputArray", "UniqueObjectFinder/muons"));
-  fItMuonInputArray = fMuonInputArray->MakeIterator();
 
   fPhotonInputArray = ImportArray(GetString("PhotonInputArray", "UniqueObjectFinder/photons"));
-  fItPhotonInputArray = fPhotonInputArray->MakeIterator();
 
   //JETS
 
@@ -97,48 +95,51 @@ void MHT::Process()
   TLorentzVector candidateMomentum;   //Used in loops over electron, muons, photons, and jets to store 4-momenta of candidate
   TLorentzVector momentum;   //This will be used as running sum of all candidate's 4-momenta, from which the output will be derived
 
-  vector< TIterator * >::iterator itInputList;
-  TIterator *iterator;
-
   DelphesFactory *factory = GetFactory();
 
   //Initialize the total 4-momentum to 0
   momentum.SetPxPyPzE(0.0, 0.0, 0.0, 0.0);
 
   // loop over all input electrons
-  fItElectronInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItElectronInputArray->Next())))
+  DelphesCandidateSpan electronInputArray(fElectronInputArray);
+  DelphesCandidateSpan::iterator itElectronInputArray;
+  for(itElectronInputArray = electronInputArray.begin(); itElectronInputArray != electronInputArray.end(); ++itElectronInputArray)
     {
+      candidate = *itElectronInputArray;
       candidateMomentum = candidate->Momentum;   //Get electron 4-momentum
 
       // apply an efficency formula
-      if(gRandom->Uniform() <= fElectronSelectionFormula->Eval(candidateMomentum.Pt(), candidateMomentum.Eta()))
+      if(GetRandom()->Uniform() <= fElectronSelectionFormula->Eval(candidateMomentum.Pt(), candidateMomentum.Eta()))
         {
           momentum+=candidateMomentum;   //Add electron 4-momentum to running total
 	}
     }
 
   // loop over all input muons
-  fItMuonInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItMuonInputArray->Next())))
+  DelphesCandidateSpan muonInputArray(fMuonInputArray);
+  DelphesCandidateSpan::iterator itMuonInputArray;
+  for(itMuonInputArray = muonInputArray.begin(); itMuonInputArray != muonInputArray.end(); ++itMuonInputArray)
     {
+      candidate = *itMuonInputArray;
       candidateMomentum = candidate->Momentum;   //Get muon 4-momentum
 
       // apply an efficency formula      
-      if(gRandom->Uniform() <= fMuonSelectionFormula->Eval(candidateMomentum.Pt(), candidateMomentum.Eta()))
+      if(GetRandom()->Uniform() <= fMuonSelectionFormula->Eval(candidateMomentum.Pt(), candidateMomentum.Eta()))
         {
           momentum+=candidateMomentum;//Add muon 4-momentum to running total
 	}
     }
 
   // loop over all input photons
-  fItPhotonInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItPhotonInputArray->Next())))
+  DelphesCandidateSpan photonInputArray(fPhotonInputArray);
+  DelphesCandidateSpan::iterator itPhotonInputArray;
+  for(itPhotonInputArray = photonInputArray.begin(); itPhotonInputArray != photonInputArray.end(); ++itPhotonInputArray)
     {
+      candidate = *itPhotonInputArray;
       candidateMomentum = candidate->Momentum;   //Get photon 4-momentum
 
       // apply an efficency formula
-      if(gRandom->Uniform() <= fPhotonSelectionFormula->Eval(candidateMomentum.Pt(), candidateMomentum.Eta()))
+      if(GetRandom()->Uniform() <= fPhotonSelectionFormula->Eval(candidateMomentum.Pt(), candidateMomentum.Eta()))
         {
           momentum+=candidateMomentum;   //Add photon 4-momentum to running total
 	}
@@ -34,7 +34,6 @@ public:
 private:
   
   const TObjArray *fJetInputArray,*fElectronInputArray,*fMuonInputArray,*fPhotonInputArray; //!  
-  TIterator *fItJetInputArray,*fItElectronInputArray,*fItMuonInputArray,*fItPhotonInputArray; //!
   TObjArray *fMomentumOutputArray; //!
   DelphesFormula *fJetSelectionFormula,*fElectronSelectionFormula,*fMuonSelectionFormula,*fPhotonSelectionFormula; //!
 
@@ -15,6 +15,7 @@
 #include "modules/Merger.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -58,15 +59,13 @@ void Merger::Init()
   ExRootConfParam param = GetParam("InputArray");
   Long_t i, size;
   const TObjArray *array;
-  TIterator *iterator;
 
   size = param.GetSize();
   for(i = 0; i < size; ++i)
   {
     array = ImportArray(param[i].GetString());
-    iterator = array->MakeIterator();
 
-    fInputList.push_back(iterator);
+    fInputList.push_back(array);
   }
 
   // create output arrays
@@ -82,14 +81,6 @@ void Merger::Init()
 
 void Merger::Finish()
 {
-  vector< TIterator * >::iterator itInputList;
-  TIterator *iterator;
-
-  for(itInputList = fInputList.begin(); itInputList != fInputList.end(); ++itInputList)
-  {
-    iterator = *itInputList;
-    if(iterator) delete iterator;
-  }
 }
 
 //------------------------------------------------------------------------------
@@ -99,8 +90,8 @@ void Merger::Process()
   Candidate *candidate;
   TLorentzVector momentum;
   Double_t sumPT, sumE;  
-  vector< TIterator * >::iterator itInputList;
-  TIterator *iterator;
+  vector< const TObjArray * >::iterator itInputList;
+  DelphesCandidateSpan::iterator itCandidates;
 
   DelphesFactory *factory = GetFactory();
   
@@ -111,12 +102,12 @@ void Merger::Process()
   // loop over all input arrays
   for(itInputList = fInputList.begin(); itInputList != fInputList.end(); ++itInputList)
   {
-    iterator = *itInputList;
+    DelphesCandidateSpan candidates(*itInputList);
 
     // loop over all candidates
-    iterator->Reset();
-    while((candidate = static_cast<Candidate*>(iterator->Next())))
+    for(itCandidates = candidates.begin(); itCandidates != candidates.end(); ++itCandidates)
     {
+      candidate = *itCandidates;
       const TLorentzVector &candidateMomentum = candidate->Momentum;
 
       momentum += candidateMomentum;
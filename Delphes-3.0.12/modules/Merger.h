@@ -18,7 +18,6 @@
 
 #include <vector>
 
-class TIterator;
 class TObjArray;
 class DelphesFormula;
 
@@ -35,7 +34,7 @@ public:
 
 private:
 
-  std::vector< TIterator * > fInputList; //!
+  std::vector< const TObjArray * > fInputList; //!
 
   TObjArray *fOutputArray; //!
   TObjArray *fMomentumOutputArray; //!
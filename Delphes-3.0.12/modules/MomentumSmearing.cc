@@ -14,6 +14,7 @@
 #include "modules/MomentumSmearing.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -39,7 +40,7 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 MomentumSmearing::MomentumSmearing() :
-  fFormula(0), fItInputArray(0)
+  fFormula(0)
 {
   fFormula = new DelphesFormula;
 }
@@ -62,7 +63,6 @@ void MomentumSmearing::Init()
   // import input array
 
   fInputArray = ImportArray(GetString("InputArray", "ParticlePropagator/stableParticles"));
-  fItInputArray = fInputArray->MakeIterator();
 
   // create output array
 
@@ -73,7 +73,6 @@ void MomentumSmearing::Init()
 
 void MomentumSmearing::Finish()
 {
-  if(fItInputArray) delete fItInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -83,9 +82,11 @@ void MomentumSmearing::Process()
   Candidate *candidate, *mother;
   Double_t pt, eta, phi;
 
-  fItInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItInputArray->Next())))
+  DelphesCandidateSpan inputArray(fInputArray);
+  DelphesCandidateSpan::iterator itInputArray;
+  for(itInputArray = inputArray.begin(); itInputArray != inputArray.end(); ++itInputArray)
   {
+    candidate = *itInputArray;
     const TLorentzVector &candidatePosition = candidate->Position;
     const TLorentzVector &candidateMomentum = candidate->Momentum;
     eta = candidatePosition.Eta();
@@ -93,7 +94,7 @@ void MomentumSmearing::Process()
     pt = candidateMomentum.Pt();
 
     // apply smearing formula
-    pt = gRandom->Gaus(pt, fFormula->Eval(pt, eta) * pt);
+    pt = GetRandom()->Gaus(pt, fFormula->Eval(pt, eta) * pt);
     
     if(pt <= 0.0) continue;
 
@@ -19,6 +19,7 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesParticleStore.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -42,14 +43,16 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 ParticlePropagator::ParticlePropagator() :
-  fItInputArray(0)
+  fStore(0)
 {
+  fStore = new DelphesParticleStore;
 }
 
 //------------------------------------------------------------------------------
 
 ParticlePropagator::~ParticlePropagator()
 {
+  if(fStore) delete fStore;
 }
 
 //------------------------------------------------------------------------------
@@ -74,7 +77,6 @@ void ParticlePropagator::Init()
   // import array with output from filter/classifier module
 
   fInputArray = ImportArray(GetString("InputArray", "Delphes/stableParticles"));
-  fItInputArray = fInputArray->MakeIterator();
 
   // create output arrays
 
@@ -88,7 +90,6 @@ void ParticlePropagator::Init()
 
 void ParticlePropagator::Finish()
 {
-  if(fItInputArray) delete fItInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -96,7 +97,7 @@ void ParticlePropagator::Finish()
 void ParticlePropagator::Process()
 {
   Candidate *candidate, *mother;
-  TLorentzVector candidatePosition, candidateMomentum;
+  Int_t i, n;
   Double_t px, py, pz, pt, pt2, e, q;
   Double_t x, y, z, t, r, phi;
   Double_t x_c, y_c, r_c, phi_c, phi_0;
@@ -108,15 +109,20 @@ void ParticlePropagator::Process()
 
   const Double_t c_light = 2.99792458E8;
 
-  fItInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItInputArray->Next())))
+  // candidates are only accessed when they leave the cylinder
+  fStore->Fill(fInputArray);
+
+  const Double_t *storePx = fStore->Px(), *storePy = fStore->Py(), *storePz = fStore->Pz(), *storeE = fStore->E();
+  const Double_t *storeX = fStore->X(), *storeY = fStore->Y(), *storeZ = fStore->Z(), *storeT = fStore->T();
+  const Int_t *storeCharge = fStore->Charge();
+
+  n = fStore->GetSize();
+  for(i = 0; i < n; ++i)
   {
-    candidatePosition = candidate->Position;
-    candidateMomentum = candidate->Momentum;
-    x = candidatePosition.X()*1.0E-3;
-    y = candidatePosition.Y()*1.0E-3;
-    z = candidatePosition.Z()*1.0E-3;
-    q = candidate->Charge;
+    x = storeX[i]*1.0E-3;
+    y = storeY[i]*1.0E-3;
+    z = storeZ[i]*1.0E-3;
+    q = storeCharge[i];
 
     // check that particle position is inside the cylinder
     if(TMath::Hypot(x, y) > fRadius || TMath::Abs(z) > fHalfLength)
@@ -124,12 +130,12 @@ void ParticlePropagator::Process()
       continue;
     }
 
-    px = candidateMomentum.Px();
-    py = candidateMomentum.Py();
-    pz = candidateMomentum.Pz();
-    pt = candidateMomentum.Pt();
-    pt2 = candidateMomentum.Perp2();
-    e = candidateMomentum.E();
+    px = storePx[i];
+    py = storePy[i];
+    pz = storePz[i];
+    pt2 = px*px + py*py;
+    pt = TMath::Sqrt(pt2);
+    e = storeE[i];
 
     if(pt2 < 1.0E-9)
     {
@@ -166,12 +172,11 @@ void ParticlePropagator::Process()
       y_t = y + py*t;
       z_t = z + pz*t;
 
-      mother = candidate;
-      candidate = static_cast<Candidate*>(candidate->Clone());
+      mother = fStore->GetCandidate(i);
+      candidate = static_cast<Candidate*>(mother->Clone());
 
-      candidate->Position.SetXYZT(x_t*1.0E3, y_t*1.0E3, z_t*1.0E3, candidatePosition.T() + t*e*1.0E3);
+      candidate->Position.SetXYZT(x_t*1.0E3, y_t*1.0E3, z_t*1.0E3, storeT[i] + t*e*1.0E3);
 
-      candidate->Momentum = candidateMomentum;
       candidate->AddCandidate(mother);
 
       fOutputArray->Add(candidate);
@@ -260,12 +265,11 @@ void ParticlePropagator::Process()
 
       if(r_t > 0.0)
       {
-        mother = candidate;
-        candidate = static_cast<Candidate*>(candidate->Clone());
+        mother = fStore->GetCandidate(i);
+        candidate = static_cast<Candidate*>(mother->Clone());
 
-        candidate->Position.SetXYZT(x_t*1.0E3, y_t*1.0E3, z_t*1.0E3, candidatePosition.T() + t*c_light*1.0E3);
+        candidate->Position.SetXYZT(x_t*1.0E3, y_t*1.0E3, z_t*1.0E3, storeT[i] + t*c_light*1.0E3);
 
-        candidate->Momentum = candidateMomentum;
         candidate->AddCandidate(mother);
 
         fOutputArray->Add(candidate);
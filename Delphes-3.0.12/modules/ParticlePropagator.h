@@ -19,7 +19,7 @@
 #include "classes/DelphesModule.h"
 
 class TClonesArray;
-class TIterator;
+class DelphesParticleStore;
 
 class ParticlePropagator: public DelphesModule
 {
@@ -37,7 +37,7 @@ private:
   Double_t fRadius, fRadius2, fHalfLength;
   Double_t fBz;
 
-  TIterator *fItInputArray; //!
+  DelphesParticleStore *fStore; //!
 
   const TObjArray *fInputArray; //!
 
@@ -10,8 +10,10 @@
 #include "modules/PileUpJetID.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesEtaPhiGrid.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -35,7 +37,8 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 PileUpJetID::PileUpJetID() :
-  fItJetInputArray(0),fTrackInputArray(0),fNeutralInputArray(0),fItVertexInputArray(0) 
+  fTrackInputArray(0),fNeutralInputArray(0),
+  fTrackGrid(0), fNeutralGrid(0)
 {
 
 }
@@ -59,17 +62,17 @@ void PileUpJetID::Init()
 
   // import input array(s)
 
-  fJetInputArray = ImportArray(GetString("JetInputArray", "FastJetFinder/jets"));
-  fItJetInputArray = fJetInputArray->MakeIterator();
+  // beta, beta* and shape variables are stored in the input jets
+  fJetInputArray = UpdateArray(GetString("JetInputArray", "FastJetFinder/jets"));
 
   fTrackInputArray = ImportArray(GetString("TrackInputArray", "Calorimeter/eflowTracks"));
-  fItTrackInputArray = fTrackInputArray->MakeIterator();
 
   fNeutralInputArray = ImportArray(GetString("NeutralInputArray", "Calorimeter/eflowTowers"));
-  fItNeutralInputArray = fNeutralInputArray->MakeIterator();
+
+  fTrackGrid = new DelphesEtaPhiGrid(fParameterR);
+  fNeutralGrid = new DelphesEtaPhiGrid(fParameterR);
   
   fVertexInputArray = ImportArray(GetString("VertexInputArray", "PileUpMerger/vertices"));
-  fItVertexInputArray = fVertexInputArray->MakeIterator();
   
   fZVertexResolution  = GetDouble("ZVertexResolution", 0.005)*1.0E3;
 // create output array(s)
@@ -83,10 +86,8 @@ void PileUpJetID::Init()
 void PileUpJetID::Finish()
 {
 
-  if(fItJetInputArray) delete fItJetInputArray;
-  if(fItTrackInputArray) delete fItTrackInputArray;
-  if(fItNeutralInputArray) delete fItNeutralInputArray;
-  if(fItVertexInputArray) delete fItVertexInputArray;
+  if(fTrackGrid) delete fTrackGrid;
+  if(fNeutralGrid) delete fNeutralGrid;
 
 }
 
@@ -99,12 +100,15 @@ void PileUpJetID::Process()
   Double_t zvtx=0;
 
   Candidate *trk;
+  vector< Int_t >::iterator itNeighbours;
 
  // find z position of primary vertex
    
-  fItVertexInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItVertexInputArray->Next())))
+  DelphesCandidateSpan vertexInputArray(fVertexInputArray);
+  DelphesCandidateSpan::iterator itVertexInputArray;
+  for(itVertexInputArray = vertexInputArray.begin(); itVertexInputArray != vertexInputArray.end(); ++itVertexInputArray)
   {
+    candidate = *itVertexInputArray;
     if(!candidate->IsPU)
     {
     zvtx = candidate->Position.Z();
@@ -112,12 +116,20 @@ void PileUpJetID::Process()
     }
   }
 
+  if(!fUseConstituents)
+  {
+    fTrackGrid->Fill(fTrackInputArray);
+    fNeutralGrid->Fill(fNeutralInputArray);
+  }
+
   // loop over all input candidates
-  fItJetInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItJetInputArray->Next())))
+  DelphesCandidateSpan jetInputArray(fJetInputArray);
+  DelphesCandidateSpan::iterator itJetInputArray;
+  for(itJetInputArray = jetInputArray.begin(); itJetInputArray != jetInputArray.end(); ++itJetInputArray)
   {
+    candidate = *itJetInputArray;
     momentum = candidate->Momentum;
-    area = candidate->Area;
+    area = candidate->GetJet().Area;
 
     float sumpt = 0.;
     float sumptch = 0.;
@@ -162,8 +174,9 @@ void PileUpJetID::Process()
       }
     } else {
       // Not using constituents, using dr
-      fItTrackInputArray->Reset();
-       while ((trk = static_cast<Candidate*>(fItTrackInputArray->Next()))) {
+      fTrackGrid->Find(momentum.Eta(), momentum.Phi(), fParameterR, fNeighbours);
+      for (itNeighbours = fNeighbours.begin(); itNeighbours != fNeighbours.end(); ++itNeighbours) {
+        trk = static_cast<Candidate*>(fTrackInputArray->UncheckedAt(*itNeighbours));
 	if (trk->Momentum.DeltaR(candidate->Momentum) < fParameterR) {
 	  float pt = trk->Momentum.Pt();
 	  sumpt += pt;
@@ -184,8 +197,9 @@ void PileUpJetID::Process()
 	  }
 	}
       }
-      fItNeutralInputArray->Reset();
-      while ((constituent = static_cast<Candidate*>(fItNeutralInputArray->Next()))) {
+      fNeutralGrid->Find(momentum.Eta(), momentum.Phi(), fParameterR, fNeighbours);
+      for (itNeighbours = fNeighbours.begin(); itNeighbours != fNeighbours.end(); ++itNeighbours) {
+        constituent = static_cast<Candidate*>(fNeutralInputArray->UncheckedAt(*itNeighbours));
 	if (constituent->Momentum.DeltaR(candidate->Momentum) < fParameterR) {
 	  float pt = constituent->Momentum.Pt();
 	  sumpt += pt;
@@ -203,28 +217,28 @@ void PileUpJetID::Process()
     }
           
     if (sumptch > 0.) {
-      candidate->Beta = sumptchpu/sumptch;
-      candidate->BetaStar = sumptchpv/sumptch;
+      candidate->Jet().Beta = sumptchpu/sumptch;
+      candidate->Jet().BetaStar = sumptchpv/sumptch;
     } else {
-      candidate->Beta = -999.;
-      candidate->BetaStar = -999.;
+      candidate->Jet().Beta = -999.;
+      candidate->Jet().BetaStar = -999.;
     }
     if (sumptsq > 0.) {
-      candidate->MeanSqDeltaR = sumdrsqptsq/sumptsq;
+      candidate->Jet().MeanSqDeltaR = sumdrsqptsq/sumptsq;
     } else {
-      candidate->MeanSqDeltaR = -999.;
+      candidate->Jet().MeanSqDeltaR = -999.;
     }
-    candidate->NCharged = nc;
-    candidate->NNeutrals = nn;
+    candidate->Jet().NCharged = nc;
+    candidate->Jet().NNeutrals = nn;
     if (sumpt > 0.) {
-      candidate->PTD = TMath::Sqrt(sumptsq) / sumpt;
+      candidate->Jet().PTD = TMath::Sqrt(sumptsq) / sumpt;
       for (int i = 0 ; i < 5 ; i++) {
-        candidate->FracPt[i] = pt_ann[i]/sumpt;
+        candidate->Jet().FracPt[i] = pt_ann[i]/sumpt;
       }
     } else {
-      candidate->PTD = -999.;
+      candidate->Jet().PTD = -999.;
       for (int i = 0 ; i < 5 ; i++) {
-        candidate->FracPt[i] = -999.;
+        candidate->Jet().FracPt[i] = -999.;
       }
     }
 
@@ -10,13 +10,14 @@
  *
  */
 
-
 #include "classes/DelphesModule.h"
 
 #include <deque>
+#include <vector>
 
 class TObjArray;
 class DelphesFormula;
+class DelphesEtaPhiGrid;
 
 class PileUpJetID: public DelphesModule
 {
@@ -41,19 +42,18 @@ private:
 
   Bool_t fAverageEachTower;
 
-  TIterator *fItJetInputArray; //!
-
   const TObjArray *fJetInputArray; //!
 
   const TObjArray *fTrackInputArray; // SCZ
   const TObjArray *fNeutralInputArray; 
 
-  TIterator *fItTrackInputArray; // SCZ
-  TIterator *fItNeutralInputArray; // SCZ
+  DelphesEtaPhiGrid *fTrackGrid; //!
+  DelphesEtaPhiGrid *fNeutralGrid; //!
+
+  std::vector< Int_t > fNeighbours; //!
 
   TObjArray *fOutputArray; //!
   
-  TIterator *fItVertexInputArray; //!
   const TObjArray *fVertexInputArray; //!
 
   Double_t fZVertexResolution;
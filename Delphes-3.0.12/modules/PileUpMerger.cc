@@ -14,9 +14,13 @@
 #include "modules/PileUpMerger.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesTF2.h"
 #include "classes/DelphesPileUpReader.h"
+#include "classes/DelphesPileUpPool.h"
+#include "classes/DelphesPDGTable.h"
+#include "classes/DelphesRandom.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -27,7 +31,6 @@
 #include "TFormula.h"
 #include "TRandom3.h"
 #include "TObjArray.h"
-#include "TDatabasePDG.h"
 #include "TLorentzVector.h"
 
 #include <algorithm>
@@ -40,7 +43,8 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 PileUpMerger::PileUpMerger() :
-  fFunction(0), fReader(0), fItInputArray(0)
+  fFunction(0), fReader(0), fPool(0), fHotSetSize(0), fReuseBudget(0),
+  fRefillPeriod(0), fHotRandom(0), fUsedEvents(0), fReadEvents(0), fSumUsesSquared(0.0)
 {
   fFunction = new DelphesTF2;
 }
@@ -51,6 +55,7 @@ PileUpMerger::PileUpMerger() :
 PileUpMerger::~PileUpMerger()
 {
   delete fFunction;
+  if(fHotRandom) delete fHotRandom;
 }
 
 //------------------------------------------------------------------------------
@@ -58,6 +63,7 @@ PileUpMerger::~PileUpMerger()
 void PileUpMerger::Init()
 {
   const char *fileName;
+  TString poolName;
 
   fPileUpDistribution = GetInt("PileUpDistribution", 0);
 
@@ -72,11 +78,50 @@ void PileUpMerger::Init()
   fFunction->SetRange(-fZVertexSpread, -fTVertexSpread, fZVertexSpread, fTVertexSpread);
 
   fileName = GetString("PileUpFile", "MinBias.pileup");
-  fReader = new DelphesPileUpReader(fileName);
+  poolName = GetString("PileUpPool", "");
+
+  // the events are decoded once per node and shared by all jobs
+  if(poolName.Length() > 0)
+  {
+    if(!poolName.BeginsWith("/")) poolName.Prepend("/");
+    fPool = new DelphesPileUpPool(poolName.Data(), fileName, GetInt("PileUpPoolSize", 0));
+  }
+  else
+  {
+    fReader = new DelphesPileUpReader(fileName);
+  }
+
+  // number of events kept in memory and number of times each of them
+  // is merged before it is replaced, 0 for no limit
+  fHotSetSize = GetInt("PileUpHotSetSize", 0);
+  fReuseBudget = GetInt("PileUpReuseBudget", 0);
+
+  if(fHotSetSize < 0) fHotSetSize = 0;
+
+  fHotPIDIndices.assign(fHotSetSize, vector< Short_t >());
+  fHotColumns.assign(fHotSetSize, vector< Float_t >());
+  fHotSizes.assign(fHotSetSize, -1);
+  fHotUses.assign(fHotSetSize, 0);
+  fHotGenerations.assign(fHotSetSize, -1);
+
+  // each slot is merged fReuseBudget times per period on average
+  fRefillPeriod = 0;
+  if(fReuseBudget > 0 && fMeanPileUp > 0.0)
+  {
+    fRefillPeriod = TMath::Max(1, TMath::Nint(fReuseBudget*fHotSetSize/fMeanPileUp));
+  }
+
+  if(fHotSetSize > 0 && !fHotRandom)
+  {
+    fHotRandom = new DelphesRandom(TString(GetName()) + "/HotSet");
+  }
+
+  fUsedEvents = 0;
+  fReadEvents = 0;
+  fSumUsesSquared = 0.0;
 
   // import input array
-  fInputArray = ImportArray(GetString("InputArray", "Delphes/stableParticles"));
-  fItInputArray = fInputArray->MakeIterator();
+  fInputArray = UpdateArray(GetString("InputArray", "Delphes/stableParticles"));
 
   // create output arrays
   fParticleOutputArray = ExportArray(GetString("ParticleOutputArray", "stableParticles"));
@@ -87,38 +132,140 @@ void PileUpMerger::Init()
 
 void PileUpMerger::Finish()
 {
+  Int_t slot;
+
+  if(fHotSetSize > 0 && fUsedEvents > 0)
+  {
+    for(slot = 0; slot < fHotSetSize; ++slot)
+    {
+      fSumUsesSquared += Double_t(fHotUses[slot])*fHotUses[slot];
+      fHotUses[slot] = 0;
+    }
+
+    // Kish effective sample size of the merged events
+    cout << "** " << GetName() << ": " << fUsedEvents << " pile-up events merged from ";
+    cout << fReadEvents << " events read, effective number of independent events ";
+    cout << Double_t(fUsedEvents)*fUsedEvents/fSumUsesSquared << endl;
+  }
+
   if(fReader) delete fReader;
+  if(fPool) delete fPool;
 }
 
 //------------------------------------------------------------------------------
 
-void PileUpMerger::Process()
+void PileUpMerger::ReadRandomEntry(TRandom *random, Int_t &size, const Short_t *&pidIndices, const Float_t **columns)
 {
-  TDatabasePDG *pdg = TDatabasePDG::Instance();
-  TParticlePDG *pdgParticle;
-  Int_t pid;
-  Float_t x, y, z, t;
-  Float_t px, py, pz, e;
-  Double_t dz, dphi, dt;
-  Int_t numberOfEvents, event;
+  const DelphesPDGTable *pdg = DelphesPDGTable::Instance();
+  const DelphesPDGProperties *pdgProperties;
   Long64_t allEntries, entry;
+  Int_t i, index;
+
+  allEntries = fPool ? fPool->GetEntries() : fReader->GetEntries();
+
+  do
+  {
+    entry = TMath::Nint(random->Rndm()*allEntries);
+  }
+  while(entry >= allEntries);
+
+  if(fPool)
+  {
+    fPool->ReadEntry(entry);
+
+    size = fPool->GetEntrySize();
+    pidIndices = fPool->GetPIDIndices();
+    for(i = 0; i < kPileUpColumns; ++i) columns[i] = fPool->GetColumn(i);
+  }
+  else
+  {
+    fReader->ReadEntry(entry);
+
+    // PDG codes of the file are looked up once
+    for(index = fCharges.size(); index < fReader->GetNumberOfPIDs(); ++index)
+    {
+      pdgProperties = &pdg->GetProperties(fReader->GetPIDs()[index]);
+      fCharges.push_back(pdgProperties->charge);
+      fMasses.push_back(pdgProperties->mass);
+    }
+
+    size = fReader->GetEntrySize();
+    pidIndices = fReader->GetPIDIndices();
+    for(i = 0; i < kPileUpColumns; ++i) columns[i] = fReader->GetColumn(i);
+  }
+
+  ++fReadEvents;
+}
+
+//------------------------------------------------------------------------------
+
+void PileUpMerger::LoadHotEvent(Int_t slot, Long64_t generation)
+{
+  const Float_t *columns[kPileUpColumns];
+  const Short_t *pidIndices;
+  Int_t size, i;
+
+  // the replaced event no longer contributes to the merged events
+  fSumUsesSquared += Double_t(fHotUses[slot])*fHotUses[slot];
+
+  if(generation >= 0)
+  {
+    // the same entry in every chain that loads this generation of the slot
+    if(fHotRandom->GetSeed() != fRandom->GetSeed()) fHotRandom->SetSeed(fRandom->GetSeed());
+    fHotRandom->SetEvent(generation*fHotSetSize + slot);
+    ReadRandomEntry(fHotRandom, size, pidIndices, columns);
+  }
+  else
+  {
+    ReadRandomEntry(GetRandom(), size, pidIndices, columns);
+  }
+
+  // the indices of the PDG codes stay valid, the tables only grow
+  fHotPIDIndices[slot].assign(pidIndices, pidIndices + size);
+  fHotColumns[slot].resize(kPileUpColumns*size);
+  for(i = 0; i < kPileUpColumns; ++i)
+  {
+    copy(columns[i], columns[i] + size, fHotColumns[slot].begin() + i*size);
+  }
+
+  fHotSizes[slot] = size;
+  fHotUses[slot] = 0;
+  fHotGenerations[slot] = generation;
+}
+
+//------------------------------------------------------------------------------
+
+void PileUpMerger::Process()
+{
+  const Float_t *columns[kPileUpColumns];
+  const Float_t *x, *y, *z, *t;
+  const Float_t *px, *py, *pz, *e;
+  const Short_t *pidIndices;
+  const Int_t *pids, *charges;
+  const Double_t *masses;
+  Double_t *rotated;
+  Double_t dz, dphi, dt, cosPhi, sinPhi, reflection;
+  Int_t numberOfEvents, event, size, i, index, slot, numberOfPIDs;
+  Long64_t generation;
   Candidate *candidate, *vertexcandidate;
   DelphesFactory *factory;
 
   const Double_t c_light = 2.99792458E8;
 
-  fItInputArray->Reset();
-
   // --- Deal with Primary vertex first  ------
 
-  fFunction->GetRandom2(dz, dt);
+  fFunction->GetRandom2(dz, dt, GetRandom());
 
   dt *= c_light*1.0E3; // necessary in order to make t in mm/c
   dz *= 1.0E3; // necessary in order to make z in mm
 
-  while((candidate = static_cast<Candidate*>(fItInputArray->Next())))
+  DelphesCandidateSpan inputArray(fInputArray);
+  DelphesCandidateSpan::iterator itInputArray;
+  for(itInputArray = inputArray.begin(); itInputArray != inputArray.end(); ++itInputArray)
   {
-    candidate->Position.SetXYZT(x, y, z+dz, t+dt);
+    candidate = *itInputArray;
+    const TLorentzVector &position = candidate->Position;
+    candidate->Position.SetXYZT(position.X(), position.Y(), position.Z() + dz, position.T() + dt);
     fParticleOutputArray->Add(candidate);
   }
 
@@ -133,36 +280,67 @@ void PileUpMerger::Process()
   switch(fPileUpDistribution)
   {
     case 0:
-      numberOfEvents = gRandom->Poisson(fMeanPileUp);
+      numberOfEvents = GetRandom()->Poisson(fMeanPileUp);
       break;
     case 1:
-      numberOfEvents = gRandom->Integer(2*fMeanPileUp + 1);
+      numberOfEvents = GetRandom()->Integer(2*fMeanPileUp + 1);
       break;
     default:
-      numberOfEvents = gRandom->Poisson(fMeanPileUp);
+      numberOfEvents = GetRandom()->Poisson(fMeanPileUp);
       break;
   }
 
-  allEntries = fReader->GetEntries();
-
   for(event = 0; event < numberOfEvents; ++event)
   {
-    do
+    if(fHotSetSize > 0)
+    {
+      slot = GetRandom()->Integer(fHotSetSize);
+
+      if(fRandom)
+      {
+        // with per-event random streams, the contents of the slot depend only on
+        // the event number and not on the events processed before by this chain,
+        // the refills of the slots are spread over the period
+        generation = 0;
+        if(fRefillPeriod > 0)
+        {
+          generation = (fRandom->GetEvent() + slot*fRefillPeriod/fHotSetSize)/fRefillPeriod;
+        }
+        if(fHotGenerations[slot] != generation) LoadHotEvent(slot, generation);
+      }
+      else if(fHotSizes[slot] < 0 || (fReuseBudget > 0 && fHotUses[slot] >= fReuseBudget))
+      {
+        LoadHotEvent(slot, -1);
+      }
+
+      ++fHotUses[slot];
+
+      size = fHotSizes[slot];
+      pidIndices = size > 0 ? &fHotPIDIndices[slot][0] : 0;
+      for(i = 0; i < kPileUpColumns; ++i)
+      {
+        columns[i] = size > 0 ? &fHotColumns[slot][i*size] : 0;
+      }
+    }
+    else
     {
-      entry = TMath::Nint(gRandom->Rndm()*allEntries);
+      ReadRandomEntry(GetRandom(), size, pidIndices, columns);
     }
-    while(entry >= allEntries);
 
-    fReader->ReadEntry(entry);
+    ++fUsedEvents;
 
    // --- Pile-up vertex smearing
 
-    fFunction->GetRandom2(dz, dt);
+    fFunction->GetRandom2(dz, dt, GetRandom());
 
     dt *= c_light*1.0E3; // necessary in order to make t in mm/c
     dz *= 1.0E3; // necessary in order to make z in mm
 
-    dphi = gRandom->Uniform(-TMath::Pi(), TMath::Pi());
+    dphi = GetRandom()->Uniform(-TMath::Pi(), TMath::Pi());
+
+    // reused events are also reflected in eta at random
+    reflection = 1.0;
+    if(fHotSetSize > 0 && GetRandom()->Rndm() < 0.5) reflection = -1.0;
 
     vertexcandidate = factory->NewCandidate();
     vertexcandidate->Position.SetXYZT(0.0, 0.0, dz, dt);
@@ -170,25 +348,68 @@ void PileUpMerger::Process()
 
     fVertexOutputArray->Add(vertexcandidate);
 
-    while(fReader->ReadParticle(pid, x, y, z, t, px, py, pz, e))
+    if(fPool)
+    {
+      // charges and masses are stored in the pool
+      pids = fPool->GetPIDs();
+      charges = fPool->GetCharges();
+      masses = fPool->GetMasses();
+      numberOfPIDs = fPool->GetNumberOfPIDs();
+    }
+    else
+    {
+      pids = fReader->GetPIDs();
+      charges = fCharges.empty() ? 0 : &fCharges[0];
+      masses = fMasses.empty() ? 0 : &fMasses[0];
+      numberOfPIDs = fCharges.size();
+    }
+
+    x = columns[kPileUpX];
+    y = columns[kPileUpY];
+    z = columns[kPileUpZ];
+    t = columns[kPileUpT];
+    px = columns[kPileUpPx];
+    py = columns[kPileUpPy];
+    pz = columns[kPileUpPz];
+    e = columns[kPileUpE];
+
+    // the whole event is rotated column by column
+    if(fRotated.size() < size_t(4*size)) fRotated.resize(4*size);
+    rotated = fRotated.empty() ? 0 : &fRotated[0];
+
+    cosPhi = TMath::Cos(dphi);
+    sinPhi = TMath::Sin(dphi);
+
+    for(i = 0; i < size; ++i)
+    {
+      rotated[i] = cosPhi*px[i] - sinPhi*py[i];
+      rotated[size + i] = sinPhi*px[i] + cosPhi*py[i];
+      rotated[2*size + i] = cosPhi*x[i] - sinPhi*y[i];
+      rotated[3*size + i] = sinPhi*x[i] + cosPhi*y[i];
+    }
+
+    for(i = 0; i < size; ++i)
     {
       candidate = factory->NewCandidate();
 
-      candidate->PID = pid;
+      index = pidIndices[i];
+      if(index < 0 || index >= numberOfPIDs)
+      {
+        throw runtime_error("invalid PID index in pile-up event");
+      }
+
+      candidate->PID = pids[index];
 
       candidate->Status = 1;
 
-      pdgParticle = pdg->GetParticle(pid);
-      candidate->Charge = pdgParticle ? Int_t(pdgParticle->Charge()/3.0) : -999;
-      candidate->Mass = pdgParticle ? pdgParticle->Mass() : -999.9;
+      candidate->Charge = charges[index];
+      candidate->Mass = masses[index];
 
       candidate->IsPU = 1;
 
-      candidate->Momentum.SetPxPyPzE(px, py, pz, e);
-      candidate->Momentum.RotateZ(dphi);
+      candidate->Momentum.SetPxPyPzE(rotated[i], rotated[size + i], reflection*pz[i], e[i]);
 
-      candidate->Position.SetXYZT(x, y, z+dz, t+dt);
-      candidate->Position.RotateZ(dphi);
+      candidate->Position.SetXYZT(rotated[2*size + i], rotated[3*size + i], reflection*z[i] + dz, t[i] + dt);
 
       fParticleOutputArray->Add(candidate);
     }
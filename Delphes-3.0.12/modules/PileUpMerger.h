@@ -16,9 +16,15 @@
 
 #include "classes/DelphesModule.h"
 
+#include <vector>
+
 class TObjArray;
+class TRandom;
+
 class DelphesPileUpReader;
+class DelphesPileUpPool;
 class DelphesTF2;
+class DelphesRandom;
 
 class PileUpMerger: public DelphesModule
 {
@@ -33,6 +39,9 @@ public:
 
 private:
 
+  void ReadRandomEntry(TRandom *random, Int_t &size, const Short_t *&pidIndices, const Float_t **columns);
+  void LoadHotEvent(Int_t slot, Long64_t generation);
+
   Int_t fPileUpDistribution;
   Double_t fMeanPileUp;
 
@@ -42,8 +51,35 @@ private:
   DelphesTF2 *fFunction; //!
 
   DelphesPileUpReader *fReader; //!
-
-  TIterator *fItInputArray; //!
+  DelphesPileUpPool *fPool; //!
+
+  // charges and masses of the PDG codes of the pile-up file
+  std::vector< Int_t > fCharges; //!
+  std::vector< Double_t > fMasses; //!
+
+  // rotated momenta and positions of a pile-up event
+  std::vector< Double_t > fRotated; //!
+
+  // pile-up events kept in memory and reused,
+  // columns of each slot are stored one after the other
+  Int_t fHotSetSize;
+  Int_t fReuseBudget;
+
+  std::vector< std::vector< Short_t > > fHotPIDIndices; //!
+  std::vector< std::vector< Float_t > > fHotColumns; //!
+  std::vector< Int_t > fHotSizes; //!
+  std::vector< Long64_t > fHotUses; //!
+
+  // with per-event random streams, a slot is refilled every fRefillPeriod events
+  // with an entry drawn by fHotRandom from the slot and generation numbers
+  Long64_t fRefillPeriod; //!
+  std::vector< Long64_t > fHotGenerations; //!
+  DelphesRandom *fHotRandom; //!
+
+  // number of merged and read pile-up events, sum of squared uses of the read events
+  Long64_t fUsedEvents; //!
+  Long64_t fReadEvents; //!
+  Double_t fSumUsesSquared; //!
 
   const TObjArray *fInputArray; //!
 
@@ -14,9 +14,11 @@
 #include "modules/PileUpMergerPythia8.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 #include "classes/DelphesPileUpReader.h"
+#include "classes/DelphesPDGTable.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -29,7 +31,6 @@
 #include "TFormula.h"
 #include "TRandom3.h"
 #include "TObjArray.h"
-#include "TDatabasePDG.h"
 #include "TLorentzVector.h"
 
 #include <algorithm>
@@ -42,7 +43,7 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 PileUpMergerPythia8::PileUpMergerPythia8() :
-  fPythia(0), fItInputArray(0)
+  fPythia(0)
 {
 }
 
@@ -69,7 +70,6 @@ void PileUpMergerPythia8::Init()
 
   // import input array
   fInputArray = ImportArray(GetString("InputArray", "Delphes/stableParticles"));
-  fItInputArray = fInputArray->MakeIterator();
 
   // create output arrays
   fOutputArray = ExportArray(GetString("OutputArray", "stableParticles"));
@@ -86,8 +86,8 @@ void PileUpMergerPythia8::Finish()
 
 void PileUpMergerPythia8::Process()
 {
-  TDatabasePDG *pdg = TDatabasePDG::Instance();
-  TParticlePDG *pdgParticle;
+  const DelphesPDGTable *pdg = DelphesPDGTable::Instance();
+  const DelphesPDGProperties *pdgProperties;
   Int_t pid;
   Float_t x, y, z, t;
   Float_t px, py, pz, e;
@@ -96,22 +96,24 @@ void PileUpMergerPythia8::Process()
   Candidate *candidate;
   DelphesFactory *factory;
 
-  fItInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItInputArray->Next())))
+  DelphesCandidateSpan inputArray(fInputArray);
+  DelphesCandidateSpan::iterator itInputArray;
+  for(itInputArray = inputArray.begin(); itInputArray != inputArray.end(); ++itInputArray)
   {
+    candidate = *itInputArray;
     fOutputArray->Add(candidate);
   }
 
   factory = GetFactory();
 
-  poisson = gRandom->Poisson(fMeanPileUp);
+  poisson = GetRandom()->Poisson(fMeanPileUp);
 
   for(event = 0; event < poisson; ++event)
   {
     while(!fPythia->next());
 
-    dz = gRandom->Gaus(0.0, fZVertexSpread);
-    dphi = gRandom->Uniform(-TMath::Pi(), TMath::Pi());
+    dz = GetRandom()->Gaus(0.0, fZVertexSpread);
+    dphi = GetRandom()->Uniform(-TMath::Pi(), TMath::Pi());
 
     for(i = 0; i < fPythia->event.size(); ++i)
     {
@@ -129,9 +131,9 @@ void PileUpMergerPythia8::Process()
 
       candidate->Status = 1;
 
-      pdgParticle = pdg->GetParticle(pid);
-      candidate->Charge = pdgParticle ? Int_t(pdgParticle->Charge()/3.0) : -999;
-      candidate->Mass = pdgParticle ? pdgParticle->Mass() : -999.9;
+      pdgProperties = &pdg->GetProperties(pid);
+      candidate->Charge = pdgProperties->charge;
+      candidate->Mass = pdgProperties->mass;
 
       candidate->IsPU = 1;
 
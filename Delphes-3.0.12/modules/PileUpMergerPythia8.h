@@ -42,8 +42,6 @@ private:
 
   Pythia8::Pythia *fPythia; //!
 
-  TIterator *fItInputArray; //!
-
   const TObjArray *fInputArray; //!
 
   TObjArray *fOutputArray; //!
@@ -14,6 +14,7 @@
 #include "modules/StatusPidFilter.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -38,8 +39,7 @@ using namespace std;
 
 //------------------------------------------------------------------------------
 
-StatusPidFilter::StatusPidFilter() :
-  fItInputArray(0)
+StatusPidFilter::StatusPidFilter()
 {
 }
 
@@ -59,7 +59,6 @@ void StatusPidFilter::Init()
 
   // import input array
   fInputArray = ImportArray(GetString("InputArray", "Delphes/allParticles"));
-  fItInputArray = fInputArray->MakeIterator();
 
   // create output array
 
@@ -70,7 +69,6 @@ void StatusPidFilter::Init()
 
 void StatusPidFilter::Finish()
 {
-  if(fItInputArray) delete fItInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -81,9 +79,11 @@ void StatusPidFilter::Process()
   Int_t status, pdgCode;
   Bool_t pass;
 
-  fItInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItInputArray->Next())))
+  DelphesCandidateSpan inputArray(fInputArray);
+  DelphesCandidateSpan::iterator itInputArray;
+  for(itInputArray = inputArray.begin(); itInputArray != inputArray.end(); ++itInputArray)
   {
+    candidate = *itInputArray;
     status = candidate->Status;
     pdgCode = TMath::Abs(candidate->PID);
 
@@ -18,7 +18,6 @@
 
 #include "classes/DelphesModule.h"
 
-class TIterator;
 class TObjArray;
 
 class StatusPidFilter: public DelphesModule
@@ -36,8 +35,6 @@ private:
 
   Double_t fPTMin; //!
 
-  TIterator *fItInputArray; //!
-
   const TObjArray *fInputArray; //!
 
   TObjArray *fOutputArray; //!
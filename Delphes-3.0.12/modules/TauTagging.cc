@@ -16,8 +16,10 @@
 #include "modules/TauTagging.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesEtaPhiGrid.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -94,8 +96,7 @@ Int_t TauTaggingPartonClassifier::GetCategory(TObject *object)
 //------------------------------------------------------------------------------
 
 TauTagging::TauTagging() :
-  fClassifier(0), fFilter(0),
-  fItPartonInputArray(0), fItJetInputArray(0)
+  fClassifier(0), fFilter(0), fGrid(0)
 {
 }
 
@@ -148,12 +149,12 @@ void TauTagging::Init()
   fClassifier->fEtaMax = GetDouble("TauEtaMax", 2.5);
 
   fPartonInputArray = ImportArray(GetString("PartonInputArray", "Delphes/partons"));
-  fItPartonInputArray = fPartonInputArray->MakeIterator();
 
   fFilter = new ExRootFilter(fPartonInputArray);
 
-  fJetInputArray = ImportArray(GetString("JetInputArray", "FastJetFinder/jets"));
-  fItJetInputArray = fJetInputArray->MakeIterator();
+  fGrid = new DelphesEtaPhiGrid(fDeltaR);
+
+  fJetInputArray = UpdateArray(GetString("JetInputArray", "FastJetFinder/jets"));
 }
 
 //------------------------------------------------------------------------------
@@ -164,9 +165,8 @@ void TauTagging::Finish()
   DelphesFormula *formula;
 
   if(fFilter) delete fFilter;
+  if(fGrid) delete fGrid;
   if(fClassifier) delete fClassifier;
-  if(fItJetInputArray) delete fItJetInputArray;
-  if(fItPartonInputArray) delete fItPartonInputArray;
 
   for(itEfficiencyMap = fEfficiencyMap.begin(); itEfficiencyMap != fEfficiencyMap.end(); ++itEfficiencyMap)
   {
@@ -186,6 +186,7 @@ void TauTagging::Process()
   map< Int_t, DelphesFormula * >::iterator itEfficiencyMap;
   DelphesFormula *formula;
   Int_t pdgCode, charge, i;
+  vector< Int_t >::iterator itNeighbours;
 
   // select taus
   fFilter->Reset();
@@ -195,19 +196,12 @@ void TauTagging::Process()
 
   TIter itTauArray(tauArray);
 
-  // loop over all input jets
-  fItJetInputArray->Reset();
-  while((jet = static_cast<Candidate *>(fItJetInputArray->Next())))
+  // compute visible momenta of all taus once
+  fTaus.clear();
+  fTauMomenta.clear();
+  fGrid->Clear();
+  if(fJetInputArray->GetEntriesFast() > 0)
   {
-    const TLorentzVector &jetMomentum = jet->Momentum;
-    pdgCode = 0;
-    charge = gRandom->Uniform() > 0.5 ? 1 : -1;
-    eta = jetMomentum.Eta();
-    phi = jetMomentum.Phi();
-    pt = jetMomentum.Pt();
-
-    // loop over all input taus
-    itTauArray.Reset();
     while((tau = static_cast<Candidate *>(itTauArray.Next())))
     {
       if(tau->D1 < 0) continue;
@@ -227,10 +221,34 @@ void TauTagging::Process()
         tauMomentum += daughter->Momentum;
       }
 
-      if(jetMomentum.DeltaR(tauMomentum) <= fDeltaR)
+      fTaus.push_back(tau);
+      fTauMomenta.push_back(tauMomentum);
+      fGrid->Add(tauMomentum.Eta(), tauMomentum.Phi());
+    }
+  }
+  fGrid->Build();
+
+  // loop over all input jets
+  DelphesCandidateSpan jetInputArray(fJetInputArray);
+  DelphesCandidateSpan::iterator itJetInputArray;
+  for(itJetInputArray = jetInputArray.begin(); itJetInputArray != jetInputArray.end(); ++itJetInputArray)
+  {
+    jet = *itJetInputArray;
+    const TLorentzVector &jetMomentum = jet->Momentum;
+    pdgCode = 0;
+    charge = GetRandom()->Uniform() > 0.5 ? 1 : -1;
+    eta = jetMomentum.Eta();
+    phi = jetMomentum.Phi();
+    pt = jetMomentum.Pt();
+
+    // loop over the taus close to the jet
+    fGrid->Find(eta, phi, fDeltaR, fNeighbours);
+    for(itNeighbours = fNeighbours.begin(); itNeighbours != fNeighbours.end(); ++itNeighbours)
+    {
+      if(jetMomentum.DeltaR(fTauMomenta[*itNeighbours]) <= fDeltaR)
       {
         pdgCode = 15;
-        charge = tau->Charge;
+        charge = fTaus[*itNeighbours]->Charge;
       }
     }
     // find an efficency formula
@@ -242,7 +260,7 @@ void TauTagging::Process()
     formula = itEfficiencyMap->second;
 
     // apply an efficency formula
-    jet->TauTag = gRandom->Uniform() <= formula->Eval(pt, eta);
+    jet->TauTag = GetRandom()->Uniform() <= formula->Eval(pt, eta);
     // set tau charge
     jet->Charge = charge;
   }
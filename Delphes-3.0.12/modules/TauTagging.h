@@ -17,13 +17,18 @@
 
 #include "classes/DelphesModule.h"
 
+#include "TLorentzVector.h"
+
 #include <map>
+#include <vector>
 
 class TObjArray;
 class DelphesFormula;
+class Candidate;
 
 class ExRootFilter;
 class TauTaggingPartonClassifier;
+class DelphesEtaPhiGrid;
 
 class TauTagging: public DelphesModule
 {
@@ -46,9 +51,14 @@ private:
   
   ExRootFilter *fFilter;
 
-  TIterator *fItPartonInputArray; //!
+  DelphesEtaPhiGrid *fGrid; //!
+
+  std::vector< Int_t > fNeighbours; //!
+
+  std::vector< Candidate * > fTaus; //!
+  std::vector< TLorentzVector > fTauMomenta; //!
+
   
-  TIterator *fItJetInputArray; //!
 
   const TObjArray *fParticleInputArray; //!
 
@@ -14,6 +14,7 @@
 #include "modules/TimeSmearing.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -38,8 +39,7 @@ using namespace std;
 
 //------------------------------------------------------------------------------
 
-TimeSmearing::TimeSmearing() :
-fItInputArray(0)
+TimeSmearing::TimeSmearing()
 {
 }
 
@@ -59,7 +59,6 @@ void TimeSmearing::Init()
   // import input array
 
   fInputArray = ImportArray(GetString("InputArray", "MuonMomentumSmearing/muons"));
-  fItInputArray = fInputArray->MakeIterator();
 
   // create output array
 
@@ -70,7 +69,6 @@ void TimeSmearing::Init()
 
 void TimeSmearing::Finish()
 {
-  if(fItInputArray) delete fItInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -81,14 +79,16 @@ void TimeSmearing::Process()
   Double_t t;
   const Double_t c_light = 2.99792458E8;
   
-  fItInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItInputArray->Next())))
+  DelphesCandidateSpan inputArray(fInputArray);
+  DelphesCandidateSpan::iterator itInputArray;
+  for(itInputArray = inputArray.begin(); itInputArray != inputArray.end(); ++itInputArray)
   {
+    candidate = *itInputArray;
     const TLorentzVector &candidatePosition = candidate->Position;
     t = candidatePosition.T()*1.0E-3/c_light;
     
     // apply smearing formula
-    t = gRandom->Gaus(t, fTimeResolution);
+    t = GetRandom()->Gaus(t, fTimeResolution);
    
     mother = candidate;
     candidate = static_cast<Candidate*>(candidate->Clone());
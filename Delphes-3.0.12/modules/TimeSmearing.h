@@ -13,7 +13,6 @@
 
 #include "classes/DelphesModule.h"
 
-class TIterator;
 class TObjArray;
 class DelphesFormula;
 
@@ -32,7 +31,6 @@ private:
 
   Double_t fTimeResolution;
  
-  TIterator *fItInputArray; //!
 
   const TObjArray *fInputArray; //!
   
@@ -14,6 +14,7 @@
 #include "modules/TrackPileUpSubtractor.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -55,7 +56,6 @@ void TrackPileUpSubtractor::Init()
 // import input array
 
   fVertexInputArray = ImportArray(GetString("VertexInputArray", "PileUpMerger/vertices"));
-  fItVertexInputArray = fVertexInputArray->MakeIterator();
   
   fZVertexResolution  = GetDouble("ZVertexResolution", 0.005)*1.0E3;
 
@@ -64,15 +64,13 @@ void TrackPileUpSubtractor::Init()
   ExRootConfParam param = GetParam("InputArray");
   Long_t i, size;
   const TObjArray *array;
-  TIterator *iterator;
 
   size = param.GetSize();
   for(i = 0; i < size/2; ++i)
   {
     array = ImportArray(param[i*2].GetString());
-    iterator = array->MakeIterator();
 
-    fInputMap[iterator] = ExportArray(param[i*2 + 1].GetString());
+    fInputMap.push_back(make_pair(array, ExportArray(param[i*2 + 1].GetString())));
   }
 }
 
@@ -80,17 +78,6 @@ void TrackPileUpSubtractor::Init()
 
 void TrackPileUpSubtractor::Finish()
 {
-  map< TIterator *, TObjArray * >::iterator itInputMap;
-  TIterator *iterator;
-
-  for(itInputMap = fInputMap.begin(); itInputMap != fInputMap.end(); ++itInputMap)
-  {
-    iterator = itInputMap->first;
-
-    if(iterator) delete iterator;
-  }
-
-  if(fItVertexInputArray) delete fItVertexInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -98,17 +85,19 @@ void TrackPileUpSubtractor::Finish()
 void TrackPileUpSubtractor::Process()
 {
   Candidate *candidate, *particle;
-  map< TIterator *, TObjArray * >::iterator itInputMap;
-  TIterator *iterator;
+  vector< pair< const TObjArray *, TObjArray * > >::iterator itInputMap;
+  DelphesCandidateSpan::iterator itCandidates;
   TObjArray *array;
   Double_t z, zvtx=0;
 
   
   // find z position of primary vertex
   
-  fItVertexInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItVertexInputArray->Next())))
+  DelphesCandidateSpan vertexInputArray(fVertexInputArray);
+  DelphesCandidateSpan::iterator itVertexInputArray;
+  for(itVertexInputArray = vertexInputArray.begin(); itVertexInputArray != vertexInputArray.end(); ++itVertexInputArray)
   {
+    candidate = *itVertexInputArray;
     if(!candidate->IsPU)
     {
     zvtx = candidate->Position.Z();
@@ -119,13 +108,13 @@ void TrackPileUpSubtractor::Process()
   // loop over all input arrays
   for(itInputMap = fInputMap.begin(); itInputMap != fInputMap.end(); ++itInputMap)
   {
-    iterator = itInputMap->first;
+    DelphesCandidateSpan candidates(itInputMap->first);
     array = itInputMap->second;
 
     // loop over all candidates
-    iterator->Reset();
-    while((candidate = static_cast<Candidate*>(iterator->Next())))
+    for(itCandidates = candidates.begin(); itCandidates != candidates.end(); ++itCandidates)
     {
+      candidate = *itCandidates;
       particle = static_cast<Candidate*>(candidate->GetCandidates()->At(0));
       z = particle->Position.Z();
       
@@ -15,9 +15,9 @@
 
 #include "classes/DelphesModule.h"
 
-#include <map>
+#include <vector>
+#include <utility>
 
-class TIterator;
 class TObjArray;
 
 class TrackPileUpSubtractor: public DelphesModule
@@ -35,12 +35,10 @@ private:
 
   Double_t fZVertexResolution;
 
-  std::map< TIterator *, TObjArray * > fInputMap; //!
+  std::vector< std::pair< const TObjArray *, TObjArray * > > fInputMap; //!
 
   ClassDef(TrackPileUpSubtractor, 1)
 
-  TIterator *fItVertexInputArray; //!
-
   const TObjArray *fVertexInputArray; //!
 
 };
@@ -14,6 +14,7 @@
 #include "modules/TreeWriter.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -21,6 +22,7 @@
 #include "ExRootAnalysis/ExRootFilter.h"
 #include "ExRootAnalysis/ExRootClassifier.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
+#include "ExRootAnalysis/ExRootTreeWriter.h"
 
 #include "TROOT.h"
 #include "TMath.h"
@@ -28,6 +30,7 @@
 #include "TFormula.h"
 #include "TRandom3.h"
 #include "TObjArray.h"
+#include "TObjString.h"
 #include "TDatabasePDG.h"
 #include "TLorentzVector.h"
 
@@ -40,7 +43,9 @@ using namespace std;
 
 //------------------------------------------------------------------------------
 
-TreeWriter::TreeWriter()
+TreeWriter::TreeWriter() :
+  fIndexReferences(kFALSE),
+  fParticleArray(0), fUnresolvedConstituents(0)
 {
 }
 
@@ -79,6 +84,20 @@ void TreeWriter::Init()
   TClass *branchClass;
   TObjArray *array;
   ExRootTreeBranch *branch;
+  TObjArray *referenceBranches;
+  stringstream message;
+
+  // with index references, links between objects are stored as entry numbers
+  // in the written branches instead of TRef and TRefArray
+  fIndexReferences = GetBool("IndexReferences", false);
+
+  TString particleBranchName = GetString("ParticleBranch", "");
+
+  // names of the branches that jet constituents can point to,
+  // stored in the user info of the tree for DelphesIndexReader
+  referenceBranches = new TObjArray;
+  referenceBranches->SetName("ReferenceBranches");
+  referenceBranches->SetOwner();
 
   size = param.GetSize();
   for(i = 0; i < size/3; ++i)
@@ -106,21 +125,161 @@ void TreeWriter::Init()
     branch = NewBranch(branchName, branchClass);
 
     fBranchMap.insert(make_pair(branch, make_pair(itClassMap->second, array)));
+
+    // the references of these branches are written to a separate branch,
+    // so that the classes of the default output do not change
+    if(fIndexReferences &&
+       (branchClass == Track::Class() || branchClass == Tower::Class() ||
+        branchClass == Photon::Class() || branchClass == Electron::Class() ||
+        branchClass == Muon::Class() || branchClass == Jet::Class()))
+    {
+      fIndexBranches[branch] = NewBranch(branchName + "Index", ReferenceIndices::Class());
+    }
+
+    // these branches are written in the order of the sorted input array
+    if(branchClass == Photon::Class() || branchClass == Electron::Class() ||
+       branchClass == Muon::Class() || branchClass == Jet::Class())
+    {
+      fSortedArrays.push_back(array);
+    }
+
+    // particle indices point to the named branch or to the first GenParticle branch
+    if(branchClass == GenParticle::Class() && (branchName == particleBranchName || (!fParticleArray && particleBranchName.IsNull())))
+    {
+      fParticleArray = array;
+    }
+
+    // every branch with one entry per candidate can be the target of a constituent
+    if(branchClass != MissingET::Class() && branchClass != ScalarHT::Class() && branchClass != Weight::Class())
+    {
+      fReferenceArrays.push_back(array);
+      referenceBranches->Add(new TObjString(branchName));
+    }
   }
 
+  if(fIndexReferences && fReferenceArrays.size() > 127)
+  {
+    delete referenceBranches;
+    message << "too many branches for index references: " << fReferenceArrays.size() << ", at most 127 are supported";
+    throw runtime_error(message.str());
+  }
+
+  if(fIndexReferences)
+  {
+    GetTreeWriter()->AddInfo(referenceBranches);
+  }
+  else
+  {
+    delete referenceBranches;
+  }
 }
 
 //------------------------------------------------------------------------------
 
 void TreeWriter::Finish()
 {
+  if(fUnresolvedConstituents > 0)
+  {
+    cout << "** WARNING: " << fUnresolvedConstituents << " jet constituents are not in any written branch," << endl;
+    cout << "**          their ConstituentIndices are -1, add a Branch for the arrays of the jet constituents" << endl;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void TreeWriter::FillIndexMap(TIndexMap &map, const TObjArray *array)
+{
+  Int_t i, size;
+
+  map.clear();
+  if(!array) return;
+
+  // entries are written in the order of the input array
+  size = array->GetEntriesFast();
+  for(i = 0; i < size; ++i)
+  {
+    map.push_back(make_pair(array->UncheckedAt(i), i));
+  }
+  sort(map.begin(), map.end());
+}
+
+//------------------------------------------------------------------------------
+
+void TreeWriter::FillReferenceMap()
+{
+  Int_t i, size, number;
+  const TObjArray *array;
+
+  fReferenceMap.clear();
+
+  for(number = 0; number < Int_t(fReferenceArrays.size()); ++number)
+  {
+    array = fReferenceArrays[number];
+    size = TMath::Min(array->GetEntriesFast(), 0x1000000);
+    for(i = 0; i < size; ++i)
+    {
+      fReferenceMap.push_back(make_pair(array->UncheckedAt(i), (number << 24) | i));
+    }
+  }
+
+  // a candidate written to several branches points to the first of them
+  sort(fReferenceMap.begin(), fReferenceMap.end());
+}
+
+//------------------------------------------------------------------------------
+
+Int_t TreeWriter::FindIndex(const TIndexMap &map, const TObject *object) const
+{
+  TIndexMap::const_iterator itMap;
+
+  itMap = lower_bound(map.begin(), map.end(), make_pair(object, Int_t(-1)));
+  if(itMap == map.end() || itMap->first != object) return -1;
+
+  return itMap->second;
+}
+
+//------------------------------------------------------------------------------
+
+Int_t TreeWriter::FindConstituentIndex(const TObject *object, ExRootTreeBranch *branch)
+{
+  Int_t reference = FindIndex(fReferenceMap, object);
+
+  if(reference < 0)
+  {
+    if(fUnresolvedConstituents == 0)
+    {
+      cout << "** WARNING: constituent of a jet in branch '" << branch->GetName() << "' is not in any written branch" << endl;
+    }
+    ++fUnresolvedConstituents;
+  }
+
+  return reference;
+}
+
+//------------------------------------------------------------------------------
+
+ReferenceIndices *TreeWriter::NewIndices(ExRootTreeBranch *branch)
+{
+  map< ExRootTreeBranch *, ExRootTreeBranch * >::iterator itIndexBranches;
+  ReferenceIndices *indices;
+
+  itIndexBranches = fIndexBranches.find(branch);
+  if(itIndexBranches == fIndexBranches.end()) return 0;
+
+  indices = static_cast<ReferenceIndices*>(itIndexBranches->second->NewEntry());
+  indices->ParticleIndices.clear();
+  indices->ConstituentIndices.clear();
+
+  return indices;
 }
 
 //------------------------------------------------------------------------------
 
-void TreeWriter::FillParticles(Candidate *candidate, TRefArray *array)
+void TreeWriter::FillParticles(Candidate *candidate, TRefArray *array, ReferenceIndices *indices)
 {
   TIter it1(candidate->GetCandidates());
+  TObject *particle;
+
   it1.Reset();
   array->Clear();
   while((candidate = static_cast<Candidate*>(it1.Next())))
@@ -130,7 +289,8 @@ void TreeWriter::FillParticles(Candidate *candidate, TRefArray *array)
     // particle
     if(candidate->GetCandidates()->GetEntriesFast() == 0)
     {
-      array->Add(candidate);
+      if(indices) indices->ParticleIndices.push_back(FindIndex(fParticleIndexMap, candidate));
+      else array->Add(candidate);
       continue;
     }
 
@@ -138,7 +298,8 @@ void TreeWriter::FillParticles(Candidate *candidate, TRefArray *array)
     candidate = static_cast<Candidate*>(candidate->GetCandidates()->At(0));
     if(candidate->GetCandidates()->GetEntriesFast() == 0)
     {
-      array->Add(candidate);
+      if(indices) indices->ParticleIndices.push_back(FindIndex(fParticleIndexMap, candidate));
+      else array->Add(candidate);
       continue;
     }
 
@@ -146,7 +307,9 @@ void TreeWriter::FillParticles(Candidate *candidate, TRefArray *array)
     it2.Reset();
     while((candidate = static_cast<Candidate*>(it2.Next())))
     {
-      array->Add(candidate->GetCandidates()->At(0));
+      particle = candidate->GetCandidates()->At(0);
+      if(indices) indices->ParticleIndices.push_back(FindIndex(fParticleIndexMap, particle));
+      else array->Add(particle);
     }
   }
 }
@@ -155,7 +318,6 @@ void TreeWriter::FillParticles(Candidate *candidate, TRefArray *array)
 
 void TreeWriter::ProcessParticles(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
   Candidate *candidate = 0;
   GenParticle *entry = 0;
   Double_t pt, signPz, cosTheta, eta, rapidity;
@@ -163,16 +325,21 @@ void TreeWriter::ProcessParticles(ExRootTreeBranch *branch, TObjArray *array)
   const Double_t c_light = 2.99792458E8;
   
   // loop over all particles
-  iterator.Reset();
-  while((candidate = static_cast<Candidate*>(iterator.Next())))
+  DelphesCandidateSpan candidates(array);
+  DelphesCandidateSpan::iterator itCandidates;
+  for(itCandidates = candidates.begin(); itCandidates != candidates.end(); ++itCandidates)
   {
+    candidate = *itCandidates;
     const TLorentzVector &momentum = candidate->Momentum;
     const TLorentzVector &position = candidate->Position;
 
     entry = static_cast<GenParticle*>(branch->NewEntry());
 
-    entry->SetBit(kIsReferenced);
-    entry->SetUniqueID(candidate->GetUniqueID());
+    if(!fIndexReferences)
+    {
+      entry->SetBit(kIsReferenced);
+      entry->SetUniqueID(candidate->GetUniqueID());
+    }
 
     pt = momentum.Pt();
     cosTheta = TMath::Abs(momentum.CosTheta());
@@ -216,16 +383,17 @@ void TreeWriter::ProcessParticles(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessVertices(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
   Candidate *candidate = 0;
   Vertex *entry = 0;
   
   const Double_t c_light = 2.99792458E8;
 
   // loop over all vertices
-  iterator.Reset();
-  while((candidate = static_cast<Candidate*>(iterator.Next())))
+  DelphesCandidateSpan candidates(array);
+  DelphesCandidateSpan::iterator itCandidates;
+  for(itCandidates = candidates.begin(); itCandidates != candidates.end(); ++itCandidates)
   {
+    candidate = *itCandidates;
     const TLorentzVector &position = candidate->Position;
 
     entry = static_cast<Vertex*>(branch->NewEntry());
@@ -241,17 +409,19 @@ void TreeWriter::ProcessVertices(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessTracks(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
   Candidate *candidate = 0;
   Candidate *particle = 0;
   Track *entry = 0;
+  ReferenceIndices *indices = 0;
   Double_t pt, signz, cosTheta, eta, rapidity;
   const Double_t c_light = 2.99792458E8;
   
   // loop over all tracks
-  iterator.Reset();
-  while((candidate = static_cast<Candidate*>(iterator.Next())))
+  DelphesCandidateSpan candidates(array);
+  DelphesCandidateSpan::iterator itCandidates;
+  for(itCandidates = candidates.begin(); itCandidates != candidates.end(); ++itCandidates)
   {
+    candidate = *itCandidates;
     const TLorentzVector &position = candidate->Position;
 
     cosTheta = TMath::Abs(position.CosTheta());
@@ -260,9 +430,13 @@ void TreeWriter::ProcessTracks(ExRootTreeBranch *branch, TObjArray *array)
     rapidity = (cosTheta == 1.0 ? signz*999.9 : position.Rapidity());
 
     entry = static_cast<Track*>(branch->NewEntry());
+    indices = NewIndices(branch);
 
-    entry->SetBit(kIsReferenced);
-    entry->SetUniqueID(candidate->GetUniqueID());
+    if(!fIndexReferences)
+    {
+      entry->SetBit(kIsReferenced);
+      entry->SetUniqueID(candidate->GetUniqueID());
+    }
 
     entry->PID = candidate->PID;
 
@@ -296,7 +470,15 @@ void TreeWriter::ProcessTracks(ExRootTreeBranch *branch, TObjArray *array)
     entry->Z = initialPosition.Z();
     entry->T = initialPosition.T()*1.0E-3/c_light;
 
-    entry->Particle = particle;
+    if(indices)
+    {
+      entry->Particle = 0;
+      indices->ParticleIndices.push_back(FindIndex(fParticleIndexMap, particle));
+    }
+    else
+    {
+      entry->Particle = particle;
+    }
   }
 }
 
@@ -304,16 +486,18 @@ void TreeWriter::ProcessTracks(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessTowers(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
   Candidate *candidate = 0;
   Tower *entry = 0;
+  ReferenceIndices *indices = 0;
   Double_t pt, signPz, cosTheta, eta, rapidity;
   const Double_t c_light = 2.99792458E8;
   
   // loop over all towers
-  iterator.Reset();
-  while((candidate = static_cast<Candidate*>(iterator.Next())))
+  DelphesCandidateSpan candidates(array);
+  DelphesCandidateSpan::iterator itCandidates;
+  for(itCandidates = candidates.begin(); itCandidates != candidates.end(); ++itCandidates)
   {
+    candidate = *itCandidates;
     const TLorentzVector &momentum = candidate->Momentum;
     const TLorentzVector &position = candidate->Position;
     
@@ -324,24 +508,28 @@ void TreeWriter::ProcessTowers(ExRootTreeBranch *branch, TObjArray *array)
     rapidity = (cosTheta == 1.0 ? signPz*999.9 : momentum.Rapidity());
 
     entry = static_cast<Tower*>(branch->NewEntry());
+    indices = NewIndices(branch);
 
-    entry->SetBit(kIsReferenced);
-    entry->SetUniqueID(candidate->GetUniqueID());
+    if(!fIndexReferences)
+    {
+      entry->SetBit(kIsReferenced);
+      entry->SetUniqueID(candidate->GetUniqueID());
+    }
 
     entry->Eta = eta;
     entry->Phi = momentum.Phi();
     entry->ET = pt;
     entry->E = momentum.E();
-    entry->Eem = candidate->Eem;
-    entry->Ehad = candidate->Ehad;
-    entry->Edges[0] = candidate->Edges[0];
-    entry->Edges[1] = candidate->Edges[1];
-    entry->Edges[2] = candidate->Edges[2];
-    entry->Edges[3] = candidate->Edges[3];
+    entry->Eem = candidate->GetTower().Eem;
+    entry->Ehad = candidate->GetTower().Ehad;
+    entry->Edges[0] = candidate->GetTower().Edges[0];
+    entry->Edges[1] = candidate->GetTower().Edges[1];
+    entry->Edges[2] = candidate->GetTower().Edges[2];
+    entry->Edges[3] = candidate->GetTower().Edges[3];
     
     entry->T = position.T()*1.0E-3/c_light;
     
-    FillParticles(candidate, &entry->Particles);
+    FillParticles(candidate, &entry->Particles, indices);
   }
 }
 
@@ -349,18 +537,18 @@ void TreeWriter::ProcessTowers(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessPhotons(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
   Candidate *candidate = 0;
   Photon *entry = 0;
+  ReferenceIndices *indices = 0;
   Double_t pt, signPz, cosTheta, eta, rapidity;
   const Double_t c_light = 2.99792458E8;
-  
-  array->Sort();
 
   // loop over all photons
-  iterator.Reset();
-  while((candidate = static_cast<Candidate*>(iterator.Next())))
+  DelphesCandidateSpan candidates(array);
+  DelphesCandidateSpan::iterator itCandidates;
+  for(itCandidates = candidates.begin(); itCandidates != candidates.end(); ++itCandidates)
   {
+    candidate = *itCandidates;
     TIter it1(candidate->GetCandidates());
     const TLorentzVector &momentum = candidate->Momentum;
     const TLorentzVector &position = candidate->Position;
@@ -373,6 +561,7 @@ void TreeWriter::ProcessPhotons(ExRootTreeBranch *branch, TObjArray *array)
     rapidity = (cosTheta == 1.0 ? signPz*999.9 : momentum.Rapidity());
 
     entry = static_cast<Photon*>(branch->NewEntry());
+    indices = NewIndices(branch);
 
     entry->Eta = eta;
     entry->Phi = momentum.Phi();
@@ -381,9 +570,9 @@ void TreeWriter::ProcessPhotons(ExRootTreeBranch *branch, TObjArray *array)
     
     entry->T = position.T()*1.0E-3/c_light;
    
-    entry->EhadOverEem = candidate->Eem > 0.0 ? candidate->Ehad/candidate->Eem : 999.9;
+    entry->EhadOverEem = candidate->GetTower().Eem > 0.0 ? candidate->GetTower().Ehad/candidate->GetTower().Eem : 999.9;
 
-    FillParticles(candidate, &entry->Particles);
+    FillParticles(candidate, &entry->Particles, indices);
   }
 }
 
@@ -391,18 +580,18 @@ void TreeWriter::ProcessPhotons(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessElectrons(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
   Candidate *candidate = 0;
   Electron *entry = 0;
+  ReferenceIndices *indices = 0;
   Double_t pt, signPz, cosTheta, eta, rapidity;
   const Double_t c_light = 2.99792458E8;
-  
-  array->Sort();
 
   // loop over all electrons
-  iterator.Reset();
-  while((candidate = static_cast<Candidate*>(iterator.Next())))
+  DelphesCandidateSpan candidates(array);
+  DelphesCandidateSpan::iterator itCandidates;
+  for(itCandidates = candidates.begin(); itCandidates != candidates.end(); ++itCandidates)
   {
+    candidate = *itCandidates;
     const TLorentzVector &momentum = candidate->Momentum;
     const TLorentzVector &position = candidate->Position;
     
@@ -413,6 +602,7 @@ void TreeWriter::ProcessElectrons(ExRootTreeBranch *branch, TObjArray *array)
     rapidity = (cosTheta == 1.0 ? signPz*999.9 : momentum.Rapidity());
 
     entry = static_cast<Electron*>(branch->NewEntry());
+    indices = NewIndices(branch);
 
     entry->Eta = eta;
     entry->Phi = momentum.Phi();
@@ -424,7 +614,15 @@ void TreeWriter::ProcessElectrons(ExRootTreeBranch *branch, TObjArray *array)
 
     entry->EhadOverEem = 0.0;
 
-    entry->Particle = candidate->GetCandidates()->At(0);
+    if(indices)
+    {
+      entry->Particle = 0;
+      indices->ParticleIndices.push_back(FindIndex(fParticleIndexMap, candidate->GetCandidates()->At(0)));
+    }
+    else
+    {
+      entry->Particle = candidate->GetCandidates()->At(0);
+    }
   }
 }
 
@@ -432,19 +630,19 @@ void TreeWriter::ProcessElectrons(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessMuons(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
   Candidate *candidate = 0;
   Muon *entry = 0;
+  ReferenceIndices *indices = 0;
   Double_t pt, signPz, cosTheta, eta, rapidity;
   
   const Double_t c_light = 2.99792458E8;
-  
-  array->Sort();
 
   // loop over all muons
-  iterator.Reset();
-  while((candidate = static_cast<Candidate*>(iterator.Next())))
+  DelphesCandidateSpan candidates(array);
+  DelphesCandidateSpan::iterator itCandidates;
+  for(itCandidates = candidates.begin(); itCandidates != candidates.end(); ++itCandidates)
   {
+    candidate = *itCandidates;
     const TLorentzVector &momentum = candidate->Momentum;
     const TLorentzVector &position = candidate->Position;
     
@@ -456,9 +654,13 @@ void TreeWriter::ProcessMuons(ExRootTreeBranch *branch, TObjArray *array)
     rapidity = (cosTheta == 1.0 ? signPz*999.9 : momentum.Rapidity());
 
     entry = static_cast<Muon*>(branch->NewEntry());
+    indices = NewIndices(branch);
 
-    entry->SetBit(kIsReferenced);
-    entry->SetUniqueID(candidate->GetUniqueID());
+    if(!fIndexReferences)
+    {
+      entry->SetBit(kIsReferenced);
+      entry->SetUniqueID(candidate->GetUniqueID());
+    }
 
     entry->Eta = eta;
     entry->Phi = momentum.Phi();
@@ -470,7 +672,15 @@ void TreeWriter::ProcessMuons(ExRootTreeBranch *branch, TObjArray *array)
 
     entry->Charge = candidate->Charge;
 
-    entry->Particle = candidate->GetCandidates()->At(0);
+    if(indices)
+    {
+      entry->Particle = 0;
+      indices->ParticleIndices.push_back(FindIndex(fParticleIndexMap, candidate->GetCandidates()->At(0)));
+    }
+    else
+    {
+      entry->Particle = candidate->GetCandidates()->At(0);
+    }
   }
 }
 
@@ -478,19 +688,19 @@ void TreeWriter::ProcessMuons(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessJets(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
   Candidate *candidate = 0, *constituent = 0;
   Jet *entry = 0;
+  ReferenceIndices *indices = 0;
   Double_t pt, signPz, cosTheta, eta, rapidity;
   Double_t ecalEnergy, hcalEnergy;
   const Double_t c_light = 2.99792458E8;
-  
-  array->Sort();
 
   // loop over all jets
-  iterator.Reset();
-  while((candidate = static_cast<Candidate*>(iterator.Next())))
+  DelphesCandidateSpan candidates(array);
+  DelphesCandidateSpan::iterator itCandidates;
+  for(itCandidates = candidates.begin(); itCandidates != candidates.end(); ++itCandidates)
   {
+    candidate = *itCandidates;
     TIter itConstituents(candidate->GetCandidates());
     
     const TLorentzVector &momentum = candidate->Momentum;
@@ -503,6 +713,7 @@ void TreeWriter::ProcessJets(ExRootTreeBranch *branch, TObjArray *array)
     rapidity = (cosTheta == 1.0 ? signPz*999.9 : momentum.Rapidity());
 
     entry = static_cast<Jet*>(branch->NewEntry());
+    indices = NewIndices(branch);
 
     entry->Eta = eta;
     entry->Phi = momentum.Phi();
@@ -512,8 +723,8 @@ void TreeWriter::ProcessJets(ExRootTreeBranch *branch, TObjArray *array)
     
     entry->Mass = momentum.M();
 
-    entry->DeltaEta = candidate->DeltaEta;
-    entry->DeltaPhi = candidate->DeltaPhi;
+    entry->DeltaEta = candidate->GetJet().DeltaEta;
+    entry->DeltaPhi = candidate->GetJet().DeltaPhi;
 
     entry->BTag = candidate->BTag;
     entry->TauTag = candidate->TauTag;
@@ -526,28 +737,29 @@ void TreeWriter::ProcessJets(ExRootTreeBranch *branch, TObjArray *array)
     hcalEnergy = 0.0;
     while((constituent = static_cast<Candidate*>(itConstituents.Next())))
     {
-      entry->Constituents.Add(constituent);
-      ecalEnergy += constituent->Eem;
-      hcalEnergy += constituent->Ehad;
+      if(indices) indices->ConstituentIndices.push_back(FindConstituentIndex(constituent, branch));
+      else entry->Constituents.Add(constituent);
+      ecalEnergy += constituent->GetTower().Eem;
+      hcalEnergy += constituent->GetTower().Ehad;
     }
 
     entry->EhadOverEem = ecalEnergy > 0.0 ? hcalEnergy/ecalEnergy : 999.9;
   
     //---   Pile-Up Jet ID variables ----
 
-    entry->NCharged = candidate->NCharged;
-    entry->NNeutrals = candidate->NNeutrals;
-    entry->Beta = candidate->Beta;
-    entry->BetaStar = candidate->BetaStar;
-    entry->MeanSqDeltaR = candidate->MeanSqDeltaR;
-    entry->PTD = candidate->PTD;
-    entry->FracPt[0] = candidate->FracPt[0];
-    entry->FracPt[1] = candidate->FracPt[1];
-    entry->FracPt[2] = candidate->FracPt[2];
-    entry->FracPt[3] = candidate->FracPt[3];
-    entry->FracPt[4] = candidate->FracPt[4];
-
-    FillParticles(candidate, &entry->Particles);
+    entry->NCharged = candidate->GetJet().NCharged;
+    entry->NNeutrals = candidate->GetJet().NNeutrals;
+    entry->Beta = candidate->GetJet().Beta;
+    entry->BetaStar = candidate->GetJet().BetaStar;
+    entry->MeanSqDeltaR = candidate->GetJet().MeanSqDeltaR;
+    entry->PTD = candidate->GetJet().PTD;
+    entry->FracPt[0] = candidate->GetJet().FracPt[0];
+    entry->FracPt[1] = candidate->GetJet().FracPt[1];
+    entry->FracPt[2] = candidate->GetJet().FracPt[2];
+    entry->FracPt[3] = candidate->GetJet().FracPt[3];
+    entry->FracPt[4] = candidate->GetJet().FracPt[4];
+
+    FillParticles(candidate, &entry->Particles, indices);
   }
 }
 
@@ -593,21 +805,22 @@ void TreeWriter::ProcessScalarHT(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessRho(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
   Candidate *candidate = 0;
   Rho *entry = 0;
 
   // loop over all rho
-  iterator.Reset();
-  while((candidate = static_cast<Candidate*>(iterator.Next())))
+  DelphesCandidateSpan candidates(array);
+  DelphesCandidateSpan::iterator itCandidates;
+  for(itCandidates = candidates.begin(); itCandidates != candidates.end(); ++itCandidates)
   {
+    candidate = *itCandidates;
     const TLorentzVector &momentum = candidate->Momentum;
 
     entry = static_cast<Rho*>(branch->NewEntry());
 
     entry->Rho = momentum.E();
-    entry->Edges[0] = candidate->Edges[0];
-    entry->Edges[1] = candidate->Edges[1];
+    entry->Edges[0] = candidate->GetTower().Edges[0];
+    entry->Edges[1] = candidate->GetTower().Edges[1];
   }
 }
 
@@ -637,6 +850,19 @@ void TreeWriter::Process()
   ExRootTreeBranch *branch;
   TProcessMethod method;
   TObjArray *array;
+  vector< TObjArray * >::iterator itSortedArrays;
+
+  // sort before the entry numbers of the references are taken
+  for(itSortedArrays = fSortedArrays.begin(); itSortedArrays != fSortedArrays.end(); ++itSortedArrays)
+  {
+    (*itSortedArrays)->Sort();
+  }
+
+  if(fIndexReferences)
+  {
+    FillIndexMap(fParticleIndexMap, fParticleArray);
+    FillReferenceMap();
+  }
 
   for(itBranchMap = fBranchMap.begin(); itBranchMap != fBranchMap.end(); ++itBranchMap)
   {
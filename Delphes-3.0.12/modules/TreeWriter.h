@@ -16,12 +16,14 @@
 #include "classes/DelphesModule.h"
 
 #include <map>
+#include <vector>
 
 class TClass;
 class TObjArray;
 class TRefArray;
 
 class Candidate;
+class ReferenceIndices;
 class ExRootTreeBranch;
 
 class TreeWriter: public DelphesModule
@@ -37,7 +39,7 @@ public:
 
 private:
 
-  void FillParticles(Candidate *candidate, TRefArray *array);
+  void FillParticles(Candidate *candidate, TRefArray *array, ReferenceIndices *indices);
 
   void ProcessParticles(ExRootTreeBranch *branch, TObjArray *array);
   void ProcessVertices(ExRootTreeBranch *branch, TObjArray *array);
@@ -61,8 +63,38 @@ private:
   TBranchMap fBranchMap; //!
 
   std::map< TClass *, TProcessMethod > fClassMap; //!
+
+  // candidates sorted by address, with their entry numbers or references
+  typedef std::vector< std::pair< const TObject *, Int_t > > TIndexMap; //!
+
+  void FillIndexMap(TIndexMap &map, const TObjArray *array);
+  void FillReferenceMap();
+  Int_t FindIndex(const TIndexMap &map, const TObject *object) const;
+  Int_t FindConstituentIndex(const TObject *object, ExRootTreeBranch *branch);
+
+  // entry of the index branch written along the given branch, 0 without index references
+  ReferenceIndices *NewIndices(ExRootTreeBranch *branch);
+
+  TIndexMap fParticleIndexMap; //!
+  TIndexMap fReferenceMap; //!
+
+  // input arrays of the branches that references can point to,
+  // the position in this vector is the branch number of the reference
+  std::vector< TObjArray * > fReferenceArrays; //!
+
+  // input arrays that are written in sorted order
+  std::vector< TObjArray * > fSortedArrays; //!
+
+  // index branches, one entry per entry of the branch they are written along
+  std::map< ExRootTreeBranch *, ExRootTreeBranch * > fIndexBranches; //!
 #endif
 
+  Bool_t fIndexReferences;
+
+  TObjArray *fParticleArray; //!
+
+  Long64_t fUnresolvedConstituents;
+
   ClassDef(TreeWriter, 1)
 };
 
@@ -14,6 +14,7 @@
 #include "modules/UniqueObjectFinder.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -57,15 +58,14 @@ void UniqueObjectFinder::Init()
   ExRootConfParam param = GetParam("InputArray");
   Long_t i, size;
   const TObjArray *array;
-  TIterator *iterator;
 
+  // arrays are processed in the order they are listed
   size = param.GetSize();
   for(i = 0; i < size/2; ++i)
   {
     array = ImportArray(param[i*2].GetString());
-    iterator = array->MakeIterator();
 
-    fInputMap[iterator] = ExportArray(param[i*2 + 1].GetString());
+    fInputMap.push_back(make_pair(array, ExportArray(param[i*2 + 1].GetString())));
   }
 }
 
@@ -73,15 +73,6 @@ void UniqueObjectFinder::Init()
 
 void UniqueObjectFinder::Finish()
 {
-  map< TIterator *, TObjArray * >::iterator itInputMap;
-  TIterator *iterator;
-
-  for(itInputMap = fInputMap.begin(); itInputMap != fInputMap.end(); ++itInputMap)
-  {
-    iterator = itInputMap->first;
-
-    if(iterator) delete iterator;
-  }
 }
 
 //------------------------------------------------------------------------------
@@ -89,50 +80,52 @@ void UniqueObjectFinder::Finish()
 void UniqueObjectFinder::Process()
 {
   Candidate *candidate;
-  map< TIterator *, TObjArray * >::iterator itInputMap;
-  TIterator *iterator;
+  vector< pair< const TObjArray *, TObjArray * > >::iterator itInputMap;
+  DelphesCandidateSpan::iterator itCandidates;
   TObjArray *array;
 
+  fLeaves.clear();
+
   // loop over all input arrays
   for(itInputMap = fInputMap.begin(); itInputMap != fInputMap.end(); ++itInputMap)
   {
-    iterator = itInputMap->first;
+    DelphesCandidateSpan candidates(itInputMap->first);
     array = itInputMap->second;
 
     // loop over all candidates
-    iterator->Reset();
-    while((candidate = static_cast<Candidate*>(iterator->Next())))
+    fNewLeaves.clear();
+    for(itCandidates = candidates.begin(); itCandidates != candidates.end(); ++itCandidates)
     {
-      if(Unique(candidate, itInputMap))
+      candidate = *itCandidates;
+      if(Unique(candidate))
       {
         array->Add(candidate);
+        const vector< UInt_t > &leaves = candidate->GetLeaves();
+        fNewLeaves.insert(fNewLeaves.end(), leaves.begin(), leaves.end());
       }
     }
+
+    // candidates of the same array do not exclude each other
+    fLeaves.insert(fLeaves.end(), fNewLeaves.begin(), fNewLeaves.end());
+    sort(fLeaves.begin(), fLeaves.end());
+    fLeaves.erase(unique(fLeaves.begin(), fLeaves.end()), fLeaves.end());
   }
 }
 
 //------------------------------------------------------------------------------
 
-Bool_t UniqueObjectFinder::Unique(Candidate *candidate, map< TIterator *, TObjArray * >::iterator itInputMap)
+Bool_t UniqueObjectFinder::Unique(Candidate *candidate)
 {
-  Candidate *previousCandidate;
-  map< TIterator *, TObjArray * >::iterator previousItInputMap;
-  TObjArray *array;
+  vector< UInt_t >::const_iterator itLeaves;
 
-  // loop over previous arrays
-  for(previousItInputMap = fInputMap.begin(); previousItInputMap != itInputMap; ++previousItInputMap)
+  // the candidate overlaps with a candidate selected from the previous arrays
+  // if and only if they are built from a common leaf candidate
+  const vector< UInt_t > &leaves = candidate->GetLeaves();
+  for(itLeaves = leaves.begin(); itLeaves != leaves.end(); ++itLeaves)
   {
-    array = previousItInputMap->second;
-    TIter iterator(array);
-
-    // loop over all candidates
-    iterator.Reset();
-    while((previousCandidate = static_cast<Candidate*>(iterator.Next())))
+    if(binary_search(fLeaves.begin(), fLeaves.end(), *itLeaves))
     {
-      if(candidate->Overlaps(previousCandidate))
-      {
-        return kFALSE;
-      }
+      return kFALSE;
     }
   }
 
@@ -15,9 +15,9 @@
 
 #include "classes/DelphesModule.h"
 
-#include <map>
+#include <vector>
+#include <utility>
 
-class TIterator;
 class TObjArray;
 class Candidate;
 
@@ -34,9 +34,13 @@ public:
 
 private:
 
-  Bool_t Unique(Candidate *candidate, std::map< TIterator *, TObjArray * >::iterator itInputMap);
+  Bool_t Unique(Candidate *candidate);
 
-  std::map< TIterator *, TObjArray * > fInputMap; //!
+  std::vector< std::pair< const TObjArray *, TObjArray * > > fInputMap; //!
+
+  // sorted leaf IDs of the candidates selected from the previous arrays
+  std::vector< UInt_t > fLeaves; //!
+  std::vector< UInt_t > fNewLeaves; //!
 
   ClassDef(UniqueObjectFinder, 1)
 };
@@ -14,6 +14,7 @@
 #include "modules/Weighter.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesCandidateSpan.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -52,8 +53,7 @@ bool Weighter::TIndexStruct::operator< (const Weighter::TIndexStruct &value) con
 
 //------------------------------------------------------------------------------
 
-Weighter::Weighter() :
-  fItInputArray(0)
+Weighter::Weighter()
 {
 }
 
@@ -112,7 +112,6 @@ void Weighter::Init()
   // import input array(s)
 
   fInputArray = ImportArray(GetString("InputArray", "Delphes/allParticles"));
-  fItInputArray = fInputArray->MakeIterator();
 
   // create output array(s)
 
@@ -123,7 +122,6 @@ void Weighter::Init()
 
 void Weighter::Finish()
 {
-  if(fItInputArray) delete fItInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -141,9 +139,11 @@ void Weighter::Process()
 
   // loop over all particles
   fCodeSet.clear();
-  fItInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItInputArray->Next())))
+  DelphesCandidateSpan inputArray(fInputArray);
+  DelphesCandidateSpan::iterator itInputArray;
+  for(itInputArray = inputArray.begin(); itInputArray != inputArray.end(); ++itInputArray)
   {
+    candidate = *itInputArray;
     if(candidate->Status != 3) continue;
 
     if(fWeightSet.find(candidate->PID) == fWeightSet.end()) continue;
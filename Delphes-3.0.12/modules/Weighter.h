@@ -41,8 +41,6 @@ private:
   std::set<Int_t> fWeightSet, fCodeSet;
   std::map<TIndexStruct, Double_t> fWeightMap;
 
-  TIterator *fItInputArray; //!
-
   const TObjArray *fInputArray; //!
 
   TObjArray *fOutputArray; //!
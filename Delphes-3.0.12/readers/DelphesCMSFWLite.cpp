@@ -17,14 +17,13 @@
 #include "TFile.h"
 #include "TObjArray.h"
 #include "TStopwatch.h"
-#include "TDatabasePDG.h"
-#include "TParticlePDG.h"
 #include "TLorentzVector.h"
 
 #include "modules/Delphes.h"
 #include "classes/DelphesStream.h"
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
+#include "classes/DelphesPDGTable.h"
 
 #include "ExRootAnalysis/ExRootTreeWriter.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
@@ -51,15 +50,16 @@ void ConvertInput(fwlite::Event &event, DelphesFactory *factory, TObjArray *allP
   handleParticle.getByLabel(event, "genParticles");
 
   Candidate *candidate;
-  TDatabasePDG *pdg;
-  TParticlePDG *pdgParticle;
+  const DelphesPDGTable *pdg;
+  const DelphesPDGProperties *pdgProperties;
   Int_t pdgCode;
+  Bool_t stable, parton;
 
   Int_t pid, status;
   Double_t px, py, pz, e, mass;
   Double_t x, y, z;
 
-  pdg = TDatabasePDG::Instance();
+  pdg = DelphesPDGTable::Instance();
 
   for(itParticle = handleParticle->begin(); itParticle != handleParticle->end(); ++itParticle)
   {
@@ -75,36 +75,45 @@ void ConvertInput(fwlite::Event &event, DelphesFactory *factory, TObjArray *allP
     px = particle.px(); py = particle.py(); pz = particle.pz(); e = particle.energy(); mass = particle.mass();
     x = particle.vx(); y = particle.vy(); z = particle.vz();
 
+    pdgProperties = &pdg->GetProperties(pid);
+    pdgCode = TMath::Abs(pid);
+
+    stable = pdgProperties->known && status == 1;
+    parton = pdgProperties->known && !stable && (pdgCode <= 5 || pdgCode == 21 || pdgCode == 15);
+
+    // arrays that no module imports are not filled
+    if(!allParticleOutputArray && !(stable && stableParticleOutputArray) && !(parton && partonOutputArray)) continue;
+
     candidate = factory->NewCandidate();
 
     candidate->PID = pid;
-    pdgCode = TMath::Abs(candidate->PID);
 
     candidate->Status = status;
 
-    itCandidate = find(vectorCandidate.begin(), vectorCandidate.end(), particle.daughter(0));
-    if(itCandidate != vectorCandidate.end()) candidate->D1 = distance(vectorCandidate.begin(), itCandidate);
+    // daughters are indices in the array of all particles
+    if(allParticleOutputArray)
+    {
+      itCandidate = find(vectorCandidate.begin(), vectorCandidate.end(), particle.daughter(0));
+      if(itCandidate != vectorCandidate.end()) candidate->D1 = distance(vectorCandidate.begin(), itCandidate);
 
-    itCandidate = find(vectorCandidate.begin(), vectorCandidate.end(), particle.daughter(particle.numberOfDaughters() - 1));
-    if(itCandidate != vectorCandidate.end()) candidate->D2 = distance(vectorCandidate.begin(), itCandidate);
+      itCandidate = find(vectorCandidate.begin(), vectorCandidate.end(), particle.daughter(particle.numberOfDaughters() - 1));
+      if(itCandidate != vectorCandidate.end()) candidate->D2 = distance(vectorCandidate.begin(), itCandidate);
+    }
 
-    pdgParticle = pdg->GetParticle(pid);
-    candidate->Charge = pdgParticle ? Int_t(pdgParticle->Charge()/3.0) : -999;
+    candidate->Charge = pdgProperties->charge;
     candidate->Mass = mass;
 
     candidate->Momentum.SetPxPyPzE(px, py, pz, e);
 
     candidate->Position.SetXYZT(x, y, z, 0.0);
 
-    allParticleOutputArray->Add(candidate);
-
-    if(!pdgParticle) continue;
+    if(allParticleOutputArray) allParticleOutputArray->Add(candidate);
 
-    if(status == 1)
+    if(stable && stableParticleOutputArray)
     {
       stableParticleOutputArray->Add(candidate);
     }
-    else if(pdgCode <= 5 || pdgCode == 21 || pdgCode == 15)
+    else if(parton && partonOutputArray)
     {
       partonOutputArray->Add(candidate);
     }
@@ -182,6 +191,11 @@ int main(int argc, char *argv[])
 
     modularDelphes->InitTask();
 
+    // arrays that no module imports are not filled
+    if(!modularDelphes->IsArrayImported(allParticleOutputArray)) allParticleOutputArray = 0;
+    if(!modularDelphes->IsArrayImported(stableParticleOutputArray)) stableParticleOutputArray = 0;
+    if(!modularDelphes->IsArrayImported(partonOutputArray)) partonOutputArray = 0;
+
     for(i = 3; i < argc && !interrupted; ++i)
     {
       cout << "** Reading " << argv[i] << endl;
@@ -1,6 +1,7 @@
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include <signal.h>
 
@@ -15,8 +16,12 @@
 #include "TLorentzVector.h"
 
 #include "modules/Delphes.h"
+#include "modules/DelphesWorkerPool.h"
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
+#include "classes/DelphesInputFile.h"
+#include "classes/DelphesInputManager.h"
+#include "classes/DelphesEventIndex.h"
 #include "classes/DelphesHepMCReader.h"
 
 #include "ExRootAnalysis/ExRootTreeWriter.h"
@@ -41,17 +46,24 @@ int main(int argc, char *argv[])
   char appName[] = "DelphesHepMC";
   stringstream message;
   FILE *inputFile = 0;
+  DelphesInputFile *input = 0;
+  DelphesInputManager *inputManager = 0;
   TFile *outputFile = 0;
   TStopwatch readStopWatch, procStopWatch;
   ExRootTreeWriter *treeWriter = 0;
   ExRootTreeBranch *branchEvent = 0;
   ExRootConfReader *confReader = 0;
-  Delphes *modularDelphes = 0;
+  Delphes *modularDelphes = 0, *chain = 0;
+  DelphesWorkerPool *pool = 0;
   DelphesFactory *factory = 0;
   TObjArray *stableParticleOutputArray = 0, *allParticleOutputArray = 0, *partonOutputArray = 0;
   DelphesHepMCReader *reader = 0;
-  Int_t i, maxEvents, skipEvents;
-  Long64_t length, eventCounter;
+  vector< DelphesHepMCReader * > readers;
+  vector< Long64_t > eventCounters;
+  Int_t i, maxEvents, skipEvents, numThreads, readAhead, numStreams, stream;
+  Int_t allParticleIndex = -1, stableParticleIndex = -1, partonIndex = -1;
+  Long64_t eventCounter, totalCounter, firstEvent, lastEvent, readLength;
+  Bool_t useIndex, eventReady;
 
   if(argc < 3)
   {
@@ -90,6 +102,10 @@ int main(int argc, char *argv[])
 
     maxEvents = confReader->GetInt("::MaxEvents", 0);
     skipEvents = confReader->GetInt("::SkipEvents", 0);
+    numThreads = confReader->GetInt("::NumThreads", 1);
+    readAhead = confReader->GetInt("::ReadAhead", 0);
+    useIndex = confReader->GetBool("::EventIndex", true);
+    numStreams = confReader->GetInt("::InputStreams", 1);
 
     if(maxEvents < 0)
     {
@@ -101,6 +117,11 @@ int main(int argc, char *argv[])
       throw runtime_error("SkipEvents must be zero or positive");
     }
 
+    if(numStreams < 1)
+    {
+      throw runtime_error("InputStreams must be positive");
+    }
+
     modularDelphes = new Delphes("Delphes");
     modularDelphes->SetConfReader(confReader);
     modularDelphes->SetTreeWriter(treeWriter);
@@ -110,101 +131,168 @@ int main(int argc, char *argv[])
     stableParticleOutputArray = modularDelphes->ExportArray("stableParticles");
     partonOutputArray = modularDelphes->ExportArray("partons");
 
-    reader = new DelphesHepMCReader;
-
     modularDelphes->InitTask();
 
-    i = 3;
-    do
+    // arrays that no module imports are not filled
+    if(!modularDelphes->IsArrayImported(allParticleOutputArray)) allParticleOutputArray = 0;
+    if(!modularDelphes->IsArrayImported(stableParticleOutputArray)) stableParticleOutputArray = 0;
+    if(!modularDelphes->IsArrayImported(partonOutputArray)) partonOutputArray = 0;
+
+    if(readAhead < 0)
+    {
+      throw runtime_error("ReadAhead must be zero or positive");
+    }
+
+    // with read-ahead, reading, processing and writing overlap even with one thread
+    if(numThreads > 1 || readAhead > 0)
     {
-      if(interrupted) break;
+      pool = new DelphesWorkerPool(modularDelphes, treeWriter, numThreads, readAhead);
 
-      if(i == argc || strncmp(argv[i], "-", 2) == 0)
-      {
-        cout << "** Reading standard input" << endl;
-        inputFile = stdin;
-        length = -1;
-      }
-      else
+      // the input arrays of all chains are resolved once
+      allParticleIndex = allParticleOutputArray ? pool->ImportArray("Delphes/allParticles") : -1;
+      stableParticleIndex = stableParticleOutputArray ? pool->ImportArray("Delphes/stableParticles") : -1;
+      partonIndex = partonOutputArray ? pool->ImportArray("Delphes/partons") : -1;
+    }
+
+    chain = modularDelphes;
+
+    inputManager = new DelphesInputManager(numStreams);
+
+    if(argc == 3) inputManager->AddFile("-");
+    for(i = 3; i < argc; ++i)
+    {
+      inputManager->AddFile(argv[i]);
+    }
+
+    // one reader per stream, events are read from numStreams files at a time
+    readers.resize(numStreams);
+    eventCounters.resize(numStreams);
+    for(i = 0; i < numStreams; ++i)
+    {
+      readers[i] = new DelphesHepMCReader;
+    }
+
+    ExRootProgressBar progressBar(inputManager->GetTotalSize());
+
+    // Loop over all objects
+    totalCounter = 0;
+    treeWriter->Clear();
+    chain->Clear();
+    while(!interrupted && inputManager->NextStream())
+    {
+      stream = inputManager->GetStream();
+      reader = readers[stream];
+      input = inputManager->GetFile();
+      inputFile = input->GetStream();
+
+      if(inputManager->IsNewFile())
       {
-        cout << "** Reading " << argv[i] << endl;
-        inputFile = fopen(argv[i], "r");
+        firstEvent = 0;
+        readLength = -1;
 
-        if(inputFile == NULL)
+        DelphesEventIndex eventIndex(DelphesEventIndex::kHepMC);
+
+        // seek directly to the first event instead of parsing the skipped ones
+        if(useIndex && skipEvents > 0 && inputFile != stdin && !input->IsCompressed() &&
+          eventIndex.Load(inputManager->GetFileName()))
         {
-          message << "can't open " << argv[i];
-          throw runtime_error(message.str());
-        }
+          lastEvent = eventIndex.GetNumberOfEvents();
+          firstEvent = (skipEvents < lastEvent) ? skipEvents : lastEvent;
+          if(maxEvents > 0 && firstEvent + maxEvents < lastEvent) lastEvent = firstEvent + maxEvents;
 
-        fseek(inputFile, 0L, SEEK_END);
-        length = ftello(inputFile);
-        fseek(inputFile, 0L, SEEK_SET);
+          cout << "** Skipping " << firstEvent << " events using ";
+          cout << DelphesEventIndex::GetIndexName(inputManager->GetFileName()) << endl;
 
-        if(length <= 0)
-        {
-          fclose(inputFile);
-          ++i;
-          continue;
+          fseeko(inputFile, eventIndex.GetOffset(firstEvent), SEEK_SET);
+          readLength = eventIndex.GetOffset(lastEvent) - eventIndex.GetOffset(firstEvent);
         }
-      }
 
-      reader->SetInputFile(inputFile);
+        reader->SetInputFile(inputFile, readLength);
+        reader->Clear();
 
-      ExRootProgressBar progressBar(length);
+        eventCounters[stream] = firstEvent;
+      }
 
-      // Loop over all objects
-      eventCounter = 0;
-      treeWriter->Clear();
-      modularDelphes->Clear();
-      reader->Clear();
+      // read the next event of the current stream
+      eventReady = kFALSE;
       readStopWatch.Start();
-      while((maxEvents <= 0 || eventCounter - skipEvents < maxEvents) &&
+      while(!eventReady && (maxEvents <= 0 || eventCounters[stream] - skipEvents < maxEvents) &&
         reader->ReadBlock(factory, allParticleOutputArray,
-        stableParticleOutputArray, partonOutputArray) && !interrupted)
+        stableParticleOutputArray, partonOutputArray))
       {
-        if(reader->EventReady())
-        {
-          ++eventCounter;
-
-          readStopWatch.Stop();
+        eventReady = reader->EventReady();
+      }
+      readStopWatch.Stop();
 
-          if(eventCounter > skipEvents)
-          {
-            procStopWatch.Start();
-            modularDelphes->ProcessTask();
-            procStopWatch.Stop();
+      if(!eventReady)
+      {
+        // the stream continues with the next file
+        chain->Clear();
+        reader->Clear();
+        inputManager->CloseFile();
+        continue;
+      }
 
-            reader->AnalyzeEvent(branchEvent, eventCounter, &readStopWatch, &procStopWatch);
+      eventCounter = ++eventCounters[stream];
 
-            treeWriter->Fill();
+      if(eventCounter > skipEvents)
+      {
+        if(pool)
+        {
+          reader->AnalyzeEvent(pool->GetBranch(branchEvent), eventCounter, &readStopWatch, &procStopWatch);
+          pool->Submit();
+
+          // the next event is read into the next module chain
+          chain = pool->GetDelphes();
+          factory = chain->GetFactory();
+          allParticleOutputArray = allParticleOutputArray ? pool->GetArray(allParticleIndex) : 0;
+          stableParticleOutputArray = stableParticleOutputArray ? pool->GetArray(stableParticleIndex) : 0;
+          partonOutputArray = partonOutputArray ? pool->GetArray(partonIndex) : 0;
+        }
+        else
+        {
+          procStopWatch.Start();
+          modularDelphes->ProcessTask();
+          procStopWatch.Stop();
 
-            treeWriter->Clear();
-          }
+          reader->AnalyzeEvent(branchEvent, eventCounter, &readStopWatch, &procStopWatch);
 
-          modularDelphes->Clear();
-          reader->Clear();
+          treeWriter->Fill();
 
-          readStopWatch.Start();
+          treeWriter->Clear();
         }
-        progressBar.Update(ftello(inputFile), eventCounter);
-      }
 
-      fseek(inputFile, 0L, SEEK_END);
-      progressBar.Update(ftello(inputFile), eventCounter, kTRUE);
-      progressBar.Finish();
+        inputManager->CountEvent();
+        ++totalCounter;
+      }
 
-      if(inputFile != stdin) fclose(inputFile);
+      chain->Clear();
+      reader->Clear();
 
-      ++i;
+      // memory-mapped files are not read through the stream
+      if(!input->IsCompressed()) inputManager->SetPosition(reader->GetPosition());
+      progressBar.Update(inputManager->GetTotalPosition(), totalCounter);
     }
-    while(i < argc);
+
+    if(pool) pool->Finish();
+
+    progressBar.Update(inputManager->GetTotalSize(), totalCounter, kTRUE);
+    progressBar.Finish();
+
+    inputManager->WriteStatistics(outputFile);
 
     modularDelphes->FinishTask();
+    if(pool) pool->FinishTask();
     treeWriter->Write();
 
     cout << "** Exiting..." << endl;
 
-    delete reader;
+    for(i = 0; i < numStreams; ++i)
+    {
+      delete readers[i];
+    }
+    delete inputManager;
+    if(pool) delete pool;
     delete modularDelphes;
     delete confReader;
     delete treeWriter;
@@ -1,13 +1,8 @@
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
-#include <memory>
 
-#include <map>
-
-#include <stdlib.h>
 #include <signal.h>
-#include <stdio.h>
 
 #include "TROOT.h"
 #include "TApplication.h"
@@ -20,115 +15,21 @@
 #include "TLorentzVector.h"
 
 #include "modules/Delphes.h"
-#include "classes/DelphesStream.h"
+#include "modules/DelphesWorkerPool.h"
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
+#include "classes/DelphesProMCReader.h"
 
 #include "ExRootAnalysis/ExRootTreeWriter.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
 #include "ExRootAnalysis/ExRootProgressBar.h"
 
-#include "ProMC/ProMC.pb.h"
 #include "ProMC/ProMCBook.h"
-#include "ProMC/ProMCHeader.pb.h"
 
 using namespace std;
 
 //---------------------------------------------------------------------------
 
-void ConvertInput(ProMCEvent &event, ExRootTreeBranch *branch, DelphesFactory *factory,
-  TObjArray *allParticleOutputArray, TObjArray *stableParticleOutputArray, TObjArray *partonOutputArray,
-  TStopwatch *readStopWatch, TStopwatch *procStopWatch)
-{
-  Int_t i;
-
-  ProMCEvent_Event *mutableEvent;
-  ProMCEvent_Particles *mutableParticles;
-
-  HepMCEvent *element;
-  Candidate *candidate;
-  TDatabasePDG *pdg;
-  TParticlePDG *pdgParticle;
-  Int_t pdgCode;
-
-  Int_t pid, status;
-  Double_t px, py, pz, mass;
-  Double_t x, y, z, t;
-
-  pdg = TDatabasePDG::Instance();
-
-  // event information
-  mutableEvent = event.mutable_event();
-
-  element = static_cast<HepMCEvent *>(branch->NewEntry());
-
-  element->Number = mutableEvent->number();
-
-  element->ProcessID = mutableEvent->process_id();
-  element->MPI = mutableEvent->mpi();
-  element->Weight = mutableEvent->weight();
-  element->Scale = mutableEvent->scale();
-  element->AlphaQED = mutableEvent->alpha_qed();
-  element->AlphaQCD = mutableEvent->alpha_qcd();
-
-  element->ID1 = mutableEvent->id1();
-  element->ID2 = mutableEvent->id2();
-  element->X1 = mutableEvent->x1();
-  element->X2 = mutableEvent->x2();
-  element->ScalePDF = mutableEvent->scale_pdf();
-  element->PDF1 = mutableEvent->pdf1();
-  element->PDF2 = mutableEvent->pdf2();
-
-  element->ReadTime = readStopWatch->RealTime();
-  element->ProcTime = procStopWatch->RealTime();
-
-  mutableParticles = event.mutable_particles();
-
-  for(i = 0; i < mutableParticles->pdg_id_size(); ++i)
-  {
-    pid = mutableParticles->pdg_id(i);
-    status = mutableParticles->status(i);
-    px = mutableParticles->px(i); py = mutableParticles->py(i); pz = mutableParticles->pz(i); mass = mutableParticles->mass(i);
-    x = mutableParticles->x(i); y = mutableParticles->y(i); z = mutableParticles->z(i); t = mutableParticles->t(i);
-
-    candidate = factory->NewCandidate();
-
-    candidate->PID = pid;
-    pdgCode = TMath::Abs(candidate->PID);
-
-    candidate->Status = status;
-
-    candidate->M1 = mutableParticles->mother1(i);
-    candidate->M2 = mutableParticles->mother2(i);
-
-    candidate->D1 = mutableParticles->daughter1(i);
-    candidate->D2 = mutableParticles->daughter2(i);
-
-    pdgParticle = pdg->GetParticle(pid);
-    candidate->Charge = pdgParticle ? Int_t(pdgParticle->Charge()/3.0) : -999;
-    candidate->Mass = mass;
-
-    candidate->Momentum.SetXYZM(px, py, pz, mass);
-
-    candidate->Position.SetXYZT(x, y, z, t);
-
-    allParticleOutputArray->Add(candidate);
-
-    if(!pdgParticle) continue;
-
-    if(status == 1)
-    {
-      stableParticleOutputArray->Add(candidate);
-    }
-    else if(pdgCode <= 5 || pdgCode == 21 || pdgCode == 15)
-    {
-      partonOutputArray->Add(candidate);
-    }
-  }
-}
-
-//---------------------------------------------------------------------------
-
 static bool interrupted = false;
 
 void SignalHandler(int sig)
@@ -148,10 +49,13 @@ int main(int argc, char *argv[])
   ExRootTreeWriter *treeWriter = 0;
   ExRootTreeBranch *branchEvent = 0;
   ExRootConfReader *confReader = 0;
-  Delphes *modularDelphes = 0;
+  Delphes *modularDelphes = 0, *chain = 0;
+  DelphesWorkerPool *pool = 0;
   DelphesFactory *factory = 0;
   TObjArray *allParticleOutputArray = 0, *stableParticleOutputArray = 0, *partonOutputArray = 0;
-  Int_t i;
+  DelphesProMCReader *reader = 0;
+  Int_t i, numThreads, readAhead, batchSize;
+  Int_t allParticleIndex = -1, stableParticleIndex = -1, partonIndex = -1;
   Long64_t eventCounter, numberOfEvents;
 
   if(argc < 4)
@@ -188,6 +92,10 @@ int main(int argc, char *argv[])
     confReader = new ExRootConfReader;
     confReader->ReadFile(argv[1]);
 
+    numThreads = confReader->GetInt("::NumThreads", 1);
+    readAhead = confReader->GetInt("::ReadAhead", 0);
+    batchSize = confReader->GetInt("::BatchSize", 64);
+
     modularDelphes = new Delphes("Delphes");
     modularDelphes->SetConfReader(confReader);
     modularDelphes->SetTreeWriter(treeWriter);
@@ -197,8 +105,33 @@ int main(int argc, char *argv[])
     stableParticleOutputArray = modularDelphes->ExportArray("stableParticles");
     partonOutputArray = modularDelphes->ExportArray("partons");
 
+    reader = new DelphesProMCReader(batchSize);
+
     modularDelphes->InitTask();
 
+    // arrays that no module imports are not filled
+    if(!modularDelphes->IsArrayImported(allParticleOutputArray)) allParticleOutputArray = 0;
+    if(!modularDelphes->IsArrayImported(stableParticleOutputArray)) stableParticleOutputArray = 0;
+    if(!modularDelphes->IsArrayImported(partonOutputArray)) partonOutputArray = 0;
+
+    if(readAhead < 0)
+    {
+      throw runtime_error("ReadAhead must be zero or positive");
+    }
+
+    // with read-ahead, reading, processing and writing overlap even with one thread
+    if(numThreads > 1 || readAhead > 0)
+    {
+      pool = new DelphesWorkerPool(modularDelphes, treeWriter, numThreads, readAhead);
+
+      // the input arrays of all chains are resolved once
+      allParticleIndex = allParticleOutputArray ? pool->ImportArray("Delphes/allParticles") : -1;
+      stableParticleIndex = stableParticleOutputArray ? pool->ImportArray("Delphes/stableParticles") : -1;
+      partonIndex = partonOutputArray ? pool->ImportArray("Delphes/partons") : -1;
+    }
+
+    chain = modularDelphes;
+
     for(i = 3; i < argc && !interrupted; ++i)
     {
       cout << "** Reading " << argv[i] << endl;
@@ -213,49 +146,80 @@ int main(int argc, char *argv[])
 
       numberOfEvents = inputFile->getEvents();
 
-      if(numberOfEvents <= 0) continue;
+      if(numberOfEvents <= 0)
+      {
+        inputFile->close();
+        delete inputFile;
+        continue;
+      }
+
+      // events are decoded in a separate thread from here on
+      reader->SetInputFile(inputFile);
 
       ExRootProgressBar progressBar(numberOfEvents - 1);
 
       // Loop over all objects
-      modularDelphes->Clear();
+      eventCounter = 0;
+      chain->Clear();
       treeWriter->Clear();
       readStopWatch.Start();
-      for(eventCounter = 0; eventCounter < numberOfEvents && !interrupted; ++eventCounter)
+      while(!interrupted && reader->ReadEvent())
       {
-        if(inputFile->next() != 0) continue;
-        ProMCEvent event = inputFile->get();
+        reader->AnalyzeParticles(factory, allParticleOutputArray,
+          stableParticleOutputArray, partonOutputArray);
 
         readStopWatch.Stop();
 
-        procStopWatch.Start();
-        ConvertInput(event, branchEvent, factory,
-          allParticleOutputArray, stableParticleOutputArray, partonOutputArray,
-          &readStopWatch, &procStopWatch);
-        modularDelphes->ProcessTask();
-        procStopWatch.Stop();
+        if(pool)
+        {
+          reader->AnalyzeEvent(pool->GetBranch(branchEvent), eventCounter, &readStopWatch, &procStopWatch);
+          pool->Submit();
+
+          // the next event is read into the next module chain
+          chain = pool->GetDelphes();
+          factory = chain->GetFactory();
+          allParticleOutputArray = allParticleOutputArray ? pool->GetArray(allParticleIndex) : 0;
+          stableParticleOutputArray = stableParticleOutputArray ? pool->GetArray(stableParticleIndex) : 0;
+          partonOutputArray = partonOutputArray ? pool->GetArray(partonIndex) : 0;
+        }
+        else
+        {
+          procStopWatch.Start();
+          modularDelphes->ProcessTask();
+          procStopWatch.Stop();
 
-        treeWriter->Fill();
+          reader->AnalyzeEvent(branchEvent, eventCounter, &readStopWatch, &procStopWatch);
 
-        modularDelphes->Clear();
-        treeWriter->Clear();
+          treeWriter->Fill();
+
+          modularDelphes->Clear();
+          treeWriter->Clear();
+        }
 
         readStopWatch.Start();
         progressBar.Update(eventCounter);
+        ++eventCounter;
       }
 
+      if(pool) pool->Finish();
+
       progressBar.Update(eventCounter, eventCounter, kTRUE);
       progressBar.Finish();
 
+      reader->Close();
+
       inputFile->close();
       delete inputFile;
     }
 
     modularDelphes->FinishTask();
+    if(pool) pool->FinishTask();
     treeWriter->Write();
 
     cout << "** Exiting..." << endl;
 
+    delete reader;
+    if(pool) delete pool;
     delete modularDelphes;
     delete confReader;
     delete treeWriter;
@@ -4,8 +4,6 @@
 
 #include <signal.h>
 
-#include "Pythia.h"
-
 #include "TROOT.h"
 #include "TApplication.h"
 
@@ -17,8 +15,10 @@
 #include "TLorentzVector.h"
 
 #include "modules/Delphes.h"
+#include "modules/DelphesWorkerPool.h"
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
+#include "classes/DelphesPythia8Driver.h"
 
 #include "ExRootAnalysis/ExRootTreeWriter.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
@@ -28,95 +28,6 @@ using namespace std;
 
 //---------------------------------------------------------------------------
 
-void ConvertInput(Long64_t eventCounter, Pythia8::Pythia *pythia,
-  ExRootTreeBranch *branch, DelphesFactory *factory,
-  TObjArray *allParticleOutputArray, TObjArray *stableParticleOutputArray, TObjArray *partonOutputArray,
-  TStopwatch *readStopWatch, TStopwatch *procStopWatch)
-{
-  int i;
-
-  HepMCEvent *element;
-  Candidate *candidate;
-  TDatabasePDG *pdg;
-  TParticlePDG *pdgParticle;
-  Int_t pdgCode;
-
-  Int_t pid, status;
-  Double_t px, py, pz, e, mass;
-  Double_t x, y, z, t;
-
-  // event information
-  element = static_cast<HepMCEvent *>(branch->NewEntry());
-
-  element->Number = eventCounter;
-
-  element->ProcessID = pythia->info.code();
-  element->MPI = 1;
-  element->Weight = pythia->info.weight();
-  element->Scale = pythia->info.QRen();
-  element->AlphaQED = pythia->info.alphaEM();
-  element->AlphaQCD = pythia->info.alphaS();
-
-  element->ID1 = pythia->info.id1();
-  element->ID2 = pythia->info.id2();
-  element->X1 = pythia->info.x1();
-  element->X2 = pythia->info.x2();
-  element->ScalePDF = pythia->info.QFac();
-  element->PDF1 = pythia->info.pdf1();
-  element->PDF2 = pythia->info.pdf2();
-
-  element->ReadTime = readStopWatch->RealTime();
-  element->ProcTime = procStopWatch->RealTime();
-
-  pdg = TDatabasePDG::Instance();
-
-  for(i = 0; i < pythia->event.size(); ++i)
-  {
-    Pythia8::Particle &particle = pythia->event[i];
-
-    pid = particle.id();
-    status = pythia->event.statusHepMC(i);
-    px = particle.px(); py = particle.py(); pz = particle.pz(); e = particle.e(); mass = particle.m();
-    x = particle.xProd(); y = particle.yProd(); z = particle.zProd(); t = particle.tProd();
-
-    candidate = factory->NewCandidate();
-
-    candidate->PID = pid;
-    pdgCode = TMath::Abs(candidate->PID);
-
-    candidate->Status = status;
-
-    candidate->M1 = particle.mother1() - 1;
-    candidate->M2 = particle.mother2() - 1;
-
-    candidate->D1 = particle.daughter1() - 1;
-    candidate->D2 = particle.daughter2() - 1;
-
-    pdgParticle = pdg->GetParticle(pid);
-    candidate->Charge = pdgParticle ? Int_t(pdgParticle->Charge()/3.0) : -999;
-    candidate->Mass = mass;
-
-    candidate->Momentum.SetPxPyPzE(px, py, pz, e);
-
-    candidate->Position.SetXYZT(x, y, z, t);
-
-    allParticleOutputArray->Add(candidate);
-
-    if(!pdgParticle) continue;
-
-    if(status == 1)
-    {
-      stableParticleOutputArray->Add(candidate);
-    }
-    else if(pdgCode <= 5 || pdgCode == 21 || pdgCode == 15)
-    {
-      partonOutputArray->Add(candidate);
-    }
-  }
-}
-
-//---------------------------------------------------------------------------
-
 static bool interrupted = false;
 
 void SignalHandler(int sig)
@@ -135,13 +46,14 @@ int main(int argc, char *argv[])
   ExRootTreeWriter *treeWriter = 0;
   ExRootTreeBranch *branchEvent = 0;
   ExRootConfReader *confReader = 0;
-  Delphes *modularDelphes = 0;
+  Delphes *modularDelphes = 0, *chain = 0;
+  DelphesWorkerPool *pool = 0;
   DelphesFactory *factory = 0;
   TObjArray *stableParticleOutputArray = 0, *allParticleOutputArray = 0, *partonOutputArray = 0;
-  Long64_t eventCounter, errorCounter;
-  Long64_t numberOfEvents, timesAllowErrors;
-
-  Pythia8::Pythia *pythia = 0;
+  DelphesPythia8Driver *driver = 0;
+  Int_t numThreads, readAhead, numGenerators, batchSize;
+  Int_t allParticleIndex = -1, stableParticleIndex = -1, partonIndex = -1;
+  Long64_t eventCounter;
 
   if(argc != 4)
   {
@@ -177,6 +89,16 @@ int main(int argc, char *argv[])
     confReader = new ExRootConfReader;
     confReader->ReadFile(argv[1]);
 
+    numThreads = confReader->GetInt("::NumThreads", 1);
+    readAhead = confReader->GetInt("::ReadAhead", 0);
+    numGenerators = confReader->GetInt("::NumGenerators", 1);
+    batchSize = confReader->GetInt("::BatchSize", 16);
+
+    if(numGenerators < 1)
+    {
+      throw runtime_error("NumGenerators must be positive");
+    }
+
     modularDelphes = new Delphes("Delphes");
     modularDelphes->SetConfReader(confReader);
     modularDelphes->SetTreeWriter(treeWriter);
@@ -188,77 +110,97 @@ int main(int argc, char *argv[])
 
     modularDelphes->InitTask();
 
-    // Initialize pythia
-    pythia = new Pythia8::Pythia;
+    // arrays that no module imports are not filled
+    if(!modularDelphes->IsArrayImported(allParticleOutputArray)) allParticleOutputArray = 0;
+    if(!modularDelphes->IsArrayImported(stableParticleOutputArray)) stableParticleOutputArray = 0;
+    if(!modularDelphes->IsArrayImported(partonOutputArray)) partonOutputArray = 0;
 
-    if(pythia == NULL)
+    if(readAhead < 0)
     {
-      throw runtime_error("can't create Pythia instance");
+      throw runtime_error("ReadAhead must be zero or positive");
     }
 
-    // Read in commands from configuration file
-    pythia->readFile(argv[2]);
+    // with read-ahead, reading, processing and writing overlap even with one thread
+    if(numThreads > 1 || readAhead > 0)
+    {
+      pool = new DelphesWorkerPool(modularDelphes, treeWriter, numThreads, readAhead);
 
-    // Extract settings to be used in the main program
-    numberOfEvents = pythia->mode("Main:numberOfEvents");
-    timesAllowErrors = pythia->mode("Main:timesAllowErrors");
+      // the input arrays of all chains are resolved once
+      allParticleIndex = allParticleOutputArray ? pool->ImportArray("Delphes/allParticles") : -1;
+      stableParticleIndex = stableParticleOutputArray ? pool->ImportArray("Delphes/stableParticles") : -1;
+      partonIndex = partonOutputArray ? pool->ImportArray("Delphes/partons") : -1;
+    }
+
+    chain = modularDelphes;
 
-    pythia->init();
+    // Initialize pythia, events are generated in numGenerators threads
+    driver = new DelphesPythia8Driver(argv[2], numGenerators, batchSize);
 
-    // ExRootProgressBar progressBar(numberOfEvents - 1);
+    // ExRootProgressBar progressBar(driver->GetNumberOfEvents() - 1);
     ExRootProgressBar progressBar(-1);
 
+    driver->Start();
+
     // Loop over all events
-    errorCounter = 0;
+    eventCounter = 0;
     treeWriter->Clear();
-    modularDelphes->Clear();
+    chain->Clear();
     readStopWatch.Start();
-    for(eventCounter = 0; eventCounter < numberOfEvents && !interrupted; ++eventCounter)
+    while(!interrupted && driver->ReadEvent())
     {
-      if(!pythia->next())
-      {
-        // If failure because reached end of file then exit event loop
-        if (pythia->info.atEndOfFile())
-        {
-          cerr << "Aborted since reached end of Les Houches Event File" << endl;
-          break;
-        }
-
-        // First few failures write off as "acceptable" errors, then quit
-        if (++errorCounter < timesAllowErrors) continue;
-        cerr << "Event generation aborted prematurely, owing to error!" << endl;
-        break;
-      }
+      driver->AnalyzeParticles(factory, allParticleOutputArray,
+        stableParticleOutputArray, partonOutputArray);
 
       readStopWatch.Stop();
 
-      procStopWatch.Start();
-      ConvertInput(eventCounter, pythia, branchEvent, factory,
-        allParticleOutputArray, stableParticleOutputArray, partonOutputArray,
-        &readStopWatch, &procStopWatch);
-      modularDelphes->ProcessTask();
-      procStopWatch.Stop();
+      if(pool)
+      {
+        driver->AnalyzeEvent(pool->GetBranch(branchEvent), eventCounter, &readStopWatch, &procStopWatch);
+        pool->Submit();
+
+        // the next event is read into the next module chain
+        chain = pool->GetDelphes();
+        factory = chain->GetFactory();
+        allParticleOutputArray = allParticleOutputArray ? pool->GetArray(allParticleIndex) : 0;
+        stableParticleOutputArray = stableParticleOutputArray ? pool->GetArray(stableParticleIndex) : 0;
+        partonOutputArray = partonOutputArray ? pool->GetArray(partonIndex) : 0;
+      }
+      else
+      {
+        procStopWatch.Start();
+        modularDelphes->ProcessTask();
+        procStopWatch.Stop();
+
+        driver->AnalyzeEvent(branchEvent, eventCounter, &readStopWatch, &procStopWatch);
 
-      treeWriter->Fill();
+        treeWriter->Fill();
 
-      treeWriter->Clear();
-      modularDelphes->Clear();
+        treeWriter->Clear();
+        modularDelphes->Clear();
+      }
 
       readStopWatch.Start();
       progressBar.Update(eventCounter, eventCounter);
+      ++eventCounter;
     }
 
+    if(pool) pool->Finish();
+
+    driver->Stop();
+
     progressBar.Update(eventCounter, eventCounter, kTRUE);
     progressBar.Finish();
 
-    pythia->statistics();
+    driver->PrintStatistics();
 
     modularDelphes->FinishTask();
+    if(pool) pool->FinishTask();
     treeWriter->Write();
 
     cout << "** Exiting..." << endl;
 
-    delete pythia;
+    delete driver;
+    if(pool) delete pool;
     delete modularDelphes;
     delete confReader;
     delete treeWriter;
@@ -268,6 +210,7 @@ int main(int argc, char *argv[])
   }
   catch(runtime_error &e)
   {
+    if(driver) delete driver;
     if(treeWriter) delete treeWriter;
     if(outputFile) delete outputFile;
     cerr << "** ERROR: " << e.what() << endl;